@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+import NEHTTP
+import NIOCore
+import NIOEmbedded
+
+private let destinationAddress = NWEndpoint.hostPort(host: "swift.org", port: 443)
+
+private let connectionEstablished = ByteBuffer(string: "HTTP/1.1 200 OK\r\n\r\n")
+
+private func runHandshake(
+  authenticationRequired: Bool,
+  serverAddress: SocketAddress
+) throws {
+  let channel = EmbeddedChannel()
+  try channel.pipeline.syncOperations.addHTTPProxyClientHandlers(
+    passwordReference: "passwordReference",
+    authenticationRequired: authenticationRequired,
+    destinationAddress: destinationAddress
+  )
+  try channel.connect(to: serverAddress).wait()
+  while let buffer = try channel.readOutbound(as: ByteBuffer.self) {
+    blackHole(buffer)
+  }
+  try channel.writeInbound(connectionEstablished)
+  // Let the client remove its HTTP codec.
+  channel.embeddedEventLoop.run()
+  blackHole(try channel.finish())
+}
+
+let benchmarks = {
+  Benchmark.defaultConfiguration = .init(
+    metrics: [.wallClock, .throughput, .mallocCountTotal],
+    scalingFactor: .kilo
+  )
+
+  Benchmark("HTTP CONNECT client handshake") { benchmark in
+    let serverAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 8080)
+
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      try runHandshake(authenticationRequired: false, serverAddress: serverAddress)
+    }
+  }
+
+  Benchmark("HTTP CONNECT client handshake with proxy authorization") { benchmark in
+    let serverAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 8080)
+
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      try runHandshake(authenticationRequired: true, serverAddress: serverAddress)
+    }
+  }
+}
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+import NESHAKE128
+import PayloadMetrics
+
+// Every VMESS chunk consumes two masks: one for the frame length and one for the padding.
+
+private let nonce: [UInt8] = Array(0..<16)
+
+let benchmarks = {
+  Benchmark.defaultConfiguration = .init(
+    metrics: [.wallClock, .throughput, .mallocCountTotal],
+    scalingFactor: .kilo
+  )
+
+  Benchmark(
+    "SHAKE128 read(digestSize: 2) masks per chunk",
+    configuration: .payload(size: 4)
+  ) { benchmark in
+    var hasher = SHAKE128()
+    hasher.update(data: nonce)
+
+    benchmark.measurePayload(bytesPerIteration: 4, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        let lengthMask = hasher.read(digestSize: 2).withUnsafeBytes {
+          $0.load(as: UInt16.self).bigEndian
+        }
+        let paddingMask = hasher.read(digestSize: 2).withUnsafeBytes {
+          $0.load(as: UInt16.self).bigEndian
+        }
+        blackHole(lengthMask ^ paddingMask)
+      }
+    }
+  }
+
+  Benchmark(
+    "SHAKE128.Reader readUInt16() masks per chunk",
+    configuration: .payload(size: 4)
+  ) { benchmark in
+    var hasher = SHAKE128()
+    hasher.update(data: nonce)
+    var reader = SHAKE128.Reader(hasher)
+
+    benchmark.measurePayload(bytesPerIteration: 4, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        blackHole(reader.readUInt16() ^ reader.readUInt16())
+      }
+    }
+  }
+
+  for (size, name) in [(64, "64 B"), (1_024, "1 KiB"), (16_384, "16 KiB"), (1_048_576, "1 MiB")] {
+    Benchmark("SHAKE128 read(into:) \(name)", configuration: .payload(size: size)) { benchmark in
+      var hasher = SHAKE128()
+      hasher.update(data: nonce)
+      let buffer = UnsafeMutableRawBufferPointer.allocate(byteCount: size, alignment: 1)
+      defer { buffer.deallocate() }
+
+      benchmark.measurePayload(bytesPerIteration: size) {
+        for _ in benchmark.scaledIterations {
+          hasher.read(into: buffer)
+          blackHole(buffer[0])
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+import NESOCKS
+import NIOCore
+import NIOEmbedded
+
+private let destinationAddress = NWEndpoint.hostPort(host: "192.168.1.1", port: 80)
+
+private let methodSelectionNoAuthentication = ByteBuffer(bytes: [0x05, 0x00])
+
+private let methodSelectionUsernamePassword = ByteBuffer(bytes: [0x05, 0x02])
+
+private let authenticationSucceeded = ByteBuffer(bytes: [0x01, 0x00])
+
+private let connectSucceeded = ByteBuffer(
+  bytes: [0x05, 0x00, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50]
+)
+
+private func drainOutbound(_ channel: EmbeddedChannel) throws {
+  while let buffer = try channel.readOutbound(as: ByteBuffer.self) {
+    blackHole(buffer)
+  }
+}
+
+let benchmarks = {
+  Benchmark.defaultConfiguration = .init(
+    metrics: [.wallClock, .throughput, .mallocCountTotal],
+    scalingFactor: .kilo
+  )
+
+  Benchmark("SOCKS5 client handshake") { benchmark in
+    let serverAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 1080)
+
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      let channel = EmbeddedChannel()
+      try channel.pipeline.syncOperations.addSOCKSClientHandlers(
+        username: "",
+        passwordReference: "",
+        authenticationRequired: false,
+        destinationAddress: destinationAddress
+      )
+      try channel.connect(to: serverAddress).wait()
+      try drainOutbound(channel)
+      try channel.writeInbound(methodSelectionNoAuthentication)
+      try drainOutbound(channel)
+      try channel.writeInbound(connectSucceeded)
+      blackHole(try channel.finish())
+    }
+  }
+
+  Benchmark("SOCKS5 client handshake with username/password authentication") { benchmark in
+    let serverAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 1080)
+
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      let channel = EmbeddedChannel()
+      try channel.pipeline.syncOperations.addSOCKSClientHandlers(
+        username: "username",
+        passwordReference: "passwordReference",
+        authenticationRequired: true,
+        destinationAddress: destinationAddress
+      )
+      try channel.connect(to: serverAddress).wait()
+      try drainOutbound(channel)
+      try channel.writeInbound(methodSelectionUsernamePassword)
+      try drainOutbound(channel)
+      try channel.writeInbound(authenticationSucceeded)
+      try drainOutbound(channel)
+      try channel.writeInbound(connectSucceeded)
+      blackHole(try channel.finish())
+    }
+  }
+}
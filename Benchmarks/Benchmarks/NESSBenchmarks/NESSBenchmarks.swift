@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+import NESS
+import NIOCore
+import NIOEmbedded
+import PayloadMetrics
+
+private let payloadSizes = [64, 1_024, 16_384, 1_048_576]
+
+private let passwordReference = "passwordReference"
+
+private let destinationAddress = NWEndpoint.hostPort(host: "swift.org", port: 443)
+
+private func sizeDescription(_ size: Int) -> String {
+  switch size {
+  case 1_048_576...:
+    return "\(size / 1_048_576) MiB"
+  case 1_024...:
+    return "\(size / 1_024) KiB"
+  default:
+    return "\(size) B"
+  }
+}
+
+/// Returns the number of chunks a payload of `payloadSize` bytes is sealed into.
+private func chunkCount(payloadSize: Int) -> Int {
+  let maximumPayloadSize = 0x3FFF
+  return (payloadSize + maximumPayloadSize - 1) / maximumPayloadSize
+}
+
+private func makeEncoderChannel(algorithm: Algorithm) throws -> EmbeddedChannel {
+  let channel = EmbeddedChannel()
+  try channel.pipeline.syncOperations.addHandler(
+    RequestEncoder(
+      algorithm: algorithm,
+      passwordReference: passwordReference,
+      destinationAddress: destinationAddress
+    )
+  )
+  return channel
+}
+
+let benchmarks = {
+  Benchmark.defaultConfiguration = .init(
+    metrics: [.wallClock, .throughput, .mallocCountTotal],
+    scalingFactor: .kilo
+  )
+
+  for algorithm in Algorithm.allCases {
+    for payloadSize in payloadSizes {
+      let payload = ByteBuffer(repeating: 0x5a, count: payloadSize)
+
+      Benchmark(
+        "RequestEncoder \(algorithm.rawValue) \(sizeDescription(payloadSize))",
+        configuration: .payload(size: payloadSize)
+      ) { benchmark in
+        let channel = try makeEncoderChannel(algorithm: algorithm)
+        // Leave the salt and the address chunk out of the measurement.
+        try channel.writeOutbound(payload)
+        while try channel.readOutbound(as: ByteBuffer.self) != nil {}
+
+        try benchmark.measurePayload(
+          bytesPerIteration: payloadSize,
+          chunksPerIteration: chunkCount(payloadSize: payloadSize)
+        ) {
+          for _ in benchmark.scaledIterations {
+            try channel.writeOutbound(payload)
+            while let chunks = try channel.readOutbound(as: ByteBuffer.self) {
+              blackHole(chunks)
+            }
+          }
+        }
+      }
+
+      Benchmark(
+        "ResponseDecoder \(algorithm.rawValue) \(sizeDescription(payloadSize))",
+        configuration: .payload(size: payloadSize)
+      ) { benchmark in
+        // A response stream is a request stream without the address chunk, which the decoder
+        // reads as one more payload, so encode it ahead with a request encoder.
+        let encoder = try makeEncoderChannel(algorithm: algorithm)
+        try encoder.writeOutbound(payload)
+        var head = encoder.allocator.buffer(capacity: 0)
+        while var buffer = try encoder.readOutbound(as: ByteBuffer.self) {
+          head.writeBuffer(&buffer)
+        }
+        var streams: [ByteBuffer] = []
+        for _ in benchmark.scaledIterations {
+          try encoder.writeOutbound(payload)
+          while let buffer = try encoder.readOutbound(as: ByteBuffer.self) {
+            streams.append(buffer)
+          }
+        }
+
+        let channel = EmbeddedChannel()
+        try channel.pipeline.syncOperations.addHandler(
+          ByteToMessageHandler(
+            ResponseDecoder(algorithm: algorithm, passwordReference: passwordReference)
+          )
+        )
+        try channel.writeInbound(head)
+        while try channel.readInbound(as: ByteBuffer.self) != nil {}
+
+        try benchmark.measurePayload(
+          bytesPerIteration: payloadSize,
+          chunksPerIteration: chunkCount(payloadSize: payloadSize)
+        ) {
+          for stream in streams {
+            try channel.writeInbound(stream)
+            while let plaintext = try channel.readInbound(as: ByteBuffer.self) {
+              blackHole(plaintext)
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,313 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+import Crypto
+import Foundation
+import NIOCore
+import NIOEmbedded
+import PayloadMetrics
+
+@_spi(Benchmarks) import NEVMESS
+
+// One full legacy AES-128-CFB chunk payload, the largest input FNV-1a sees.
+
+private let chunk: [UInt8] = (0..<1978).map { UInt8(truncatingIfNeeded: $0 &* 31) }
+
+// The `reduce` based implementations the kernels replaced, kept as the baseline.
+
+private let crc32Table: [UInt32] = (0...255).map { i -> UInt32 in
+  (0..<8).reduce(UInt32(i)) { c, _ in
+    (c % 2 == 0) ? (c >> 1) : (0xEDB8_8320 ^ (c >> 1))
+  }
+}
+
+private func bytewiseCRC32<Bytes: Sequence>(_ data: Bytes) -> UInt32 where Bytes.Element == UInt8 {
+  ~(data.reduce(~UInt32(0)) { crc, byte in
+    (crc >> 8) ^ crc32Table[(Int(crc) ^ Int(byte)) & 0xFF]
+  })
+}
+
+private func bytewiseFNV1a32<D: DataProtocol>(_ data: D) -> UInt32 {
+  data.reduce(UInt32(2_166_136_261)) { partialResult, byte in
+    (partialResult ^ UInt32(byte)) &* 16_777_619
+  }
+}
+
+private let payloadSizes = [64, 1_024, 16_384, 1_048_576]
+
+private func sizeDescription(_ size: Int) -> String {
+  switch size {
+  case 1_048_576...:
+    return "\(size / 1_048_576) MiB"
+  case 1_024...:
+    return "\(size / 1_024) KiB"
+  default:
+    return "\(size) B"
+  }
+}
+
+/// An instrumentation that counts the chunks an encoder seals.
+private final class ChunkCounter: ProxyInstrumentation, @unchecked Sendable {
+
+  private(set) var chunkCount = 0
+
+  func chunksProcessed(
+    _ chunkCount: Int,
+    byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent,
+    duration: TimeAmount
+  ) {
+    self.chunkCount += chunkCount
+  }
+}
+
+// `.auto` is resolved to one of these before any byte is encoded.
+private let contentSecurities: [(ContentSecurity, String)] = [
+  (.aes128Cfb, "aes-128-cfb"),
+  (.aes128Gcm, "aes-128-gcm"),
+  (.chaCha20Poly1305, "chacha20-poly1305"),
+  (.none, "none"),
+  (.zero, "zero"),
+]
+
+private let symmetricKey: [UInt8] = [
+  0x45, 0xd4, 0xc4, 0x2b, 0xbe, 0xfa, 0xb0, 0x9d, 0xe3, 0x5e, 0x49, 0x8f, 0xca, 0x4f, 0xf9, 0x20,
+]
+
+private let nonce: [UInt8] = [
+  0x9e, 0xbd, 0xbd, 0xe7, 0x06, 0xba, 0x8d, 0x3e, 0x6e, 0x96, 0x24, 0x1d, 0xc6, 0x34, 0x4a, 0xfa,
+]
+
+/// An AEAD response head sealed for `symmetricKey` and `nonce`, it does not depend on the content
+/// security of the body.
+private let responseHead: [UInt8] = [
+  0xf9, 0xb5, 0x3a, 0xf2, 0xa0, 0xb7, 0xd8, 0x7c, 0xa9, 0x7f, 0xb9, 0xf0, 0x89, 0xba, 0x97, 0xed,
+  0x11, 0x48, 0x15, 0xab, 0x94, 0x35, 0x57, 0xc4, 0x41, 0xcf, 0xc8, 0x67, 0x00, 0xc4, 0xdd, 0xd2,
+  0x1d, 0xb3, 0xc6, 0xc4, 0x9e, 0x7d,
+]
+
+private func makeEncoderChannel(
+  contentSecurity: ContentSecurity,
+  symmetricKey: SymmetricKey,
+  nonce: [UInt8],
+  instrumentation: (any ProxyInstrumentation)? = nil
+) throws -> EmbeddedChannel {
+  let channel = EmbeddedChannel()
+  try channel.pipeline.syncOperations.addHandler(
+    VMESSEncoder<VMESSPart<VMESSRequestHead, ByteBuffer>>(
+      authenticationCode: 0x3d,
+      contentSecurity: contentSecurity,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .chunkStream,
+      commandCode: .tcp,
+      instrumentation: instrumentation
+    )
+  )
+  return channel
+}
+
+/// Returns the number of chunks `part` is sealed into, with an encoder of its own so the
+/// instrumentation stays out of the measured ones.
+private func chunkCount(
+  of part: VMESSPart<VMESSRequestHead, ByteBuffer>,
+  contentSecurity: ContentSecurity
+) throws -> Int {
+  let counter = ChunkCounter()
+  let channel = try makeEncoderChannel(
+    contentSecurity: contentSecurity,
+    symmetricKey: SymmetricKey(data: symmetricKey),
+    nonce: nonce,
+    instrumentation: counter
+  )
+  try channel.writeOutbound(part)
+  while try channel.readOutbound(as: ByteBuffer.self) != nil {}
+  return counter.chunkCount
+}
+
+private func codecBenchmarks(contentSecurity: ContentSecurity, name: String, payloadSize: Int) {
+  let part = VMESSPart<VMESSRequestHead, ByteBuffer>.body(
+    ByteBuffer(repeating: 0x5a, count: payloadSize)
+  )
+
+  Benchmark(
+    "VMESSEncoder \(name) \(sizeDescription(payloadSize))",
+    configuration: .payload(size: payloadSize)
+  ) { benchmark in
+    let chunksPerIteration = try chunkCount(of: part, contentSecurity: contentSecurity)
+    let channel = try makeEncoderChannel(
+      contentSecurity: contentSecurity,
+      symmetricKey: SymmetricKey(data: symmetricKey),
+      nonce: nonce
+    )
+
+    try benchmark.measurePayload(
+      bytesPerIteration: payloadSize,
+      chunksPerIteration: chunksPerIteration
+    ) {
+      for _ in benchmark.scaledIterations {
+        try channel.writeOutbound(part)
+        while let frames = try channel.readOutbound(as: ByteBuffer.self) {
+          blackHole(frames)
+        }
+      }
+    }
+  }
+
+  Benchmark(
+    "VMESSDecoder \(name) \(sizeDescription(payloadSize))",
+    configuration: .payload(size: payloadSize)
+  ) { benchmark in
+    let chunksPerIteration = try chunkCount(of: part, contentSecurity: contentSecurity)
+    // The response body is sealed with the keys the decoder derives from the request ones, so
+    // encode it ahead with a request encoder.
+    let encoder = try makeEncoderChannel(
+      contentSecurity: contentSecurity,
+      symmetricKey: SymmetricKey(data: Array(SHA256.hash(data: symmetricKey).prefix(16))),
+      nonce: Array(SHA256.hash(data: nonce).prefix(16))
+    )
+    var frames: [ByteBuffer] = []
+    for _ in benchmark.scaledIterations {
+      try encoder.writeOutbound(part)
+      while let buffer = try encoder.readOutbound(as: ByteBuffer.self) {
+        frames.append(buffer)
+      }
+    }
+
+    let channel = EmbeddedChannel()
+    try channel.pipeline.syncOperations.addHandler(
+      ByteToMessageHandler(
+        VMESSDecoder<VMESSPart<VMESSResponseHead, ByteBuffer>>(
+          contentSecurity: contentSecurity,
+          symmetricKey: SymmetricKey(data: symmetricKey),
+          nonce: nonce,
+          options: .chunkStream,
+          commandCode: .tcp
+        )
+      )
+    )
+    try channel.writeInbound(ByteBuffer(bytes: responseHead))
+    _ = try channel.readInbound(as: VMESSPart<VMESSResponseHead, ByteBuffer>.self)
+
+    try benchmark.measurePayload(
+      bytesPerIteration: payloadSize,
+      chunksPerIteration: chunksPerIteration
+    ) {
+      for frame in frames {
+        try channel.writeInbound(frame)
+        while let decoded = try channel.readInbound(
+          as: VMESSPart<VMESSResponseHead, ByteBuffer>.self
+        ) {
+          blackHole(decoded)
+        }
+      }
+    }
+  }
+}
+
+let benchmarks = {
+  Benchmark.defaultConfiguration = .init(
+    metrics: [.wallClock, .throughput, .mallocCountTotal],
+    scalingFactor: .kilo
+  )
+
+  Benchmark("CRC32 reduce per chunk", configuration: .payload(size: chunk.count)) { benchmark in
+    benchmark.measurePayload(bytesPerIteration: chunk.count, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        blackHole(bytewiseCRC32(chunk))
+      }
+    }
+  }
+
+  Benchmark("CRC32 slice-by-8 per chunk", configuration: .payload(size: chunk.count)) { benchmark in
+    benchmark.measurePayload(bytesPerIteration: chunk.count, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        blackHole(chunk.withUnsafeBytes { CRC32.checksum(bufferPointer: $0) })
+      }
+    }
+  }
+
+  Benchmark("FNV1a32 reduce per chunk", configuration: .payload(size: chunk.count)) { benchmark in
+    benchmark.measurePayload(bytesPerIteration: chunk.count, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        blackHole(bytewiseFNV1a32(chunk))
+      }
+    }
+  }
+
+  Benchmark("FNV1a32 unrolled per chunk", configuration: .payload(size: chunk.count)) { benchmark in
+    benchmark.measurePayload(bytesPerIteration: chunk.count, chunksPerIteration: 1) {
+      for _ in benchmark.scaledIterations {
+        blackHole(chunk.withUnsafeBytes { FNV1a32.hash(bufferPointer: $0) })
+      }
+    }
+  }
+
+  for payloadSize in payloadSizes {
+    let payload = [UInt8](repeating: 0x5a, count: payloadSize)
+
+    Benchmark(
+      "CRC32 slice-by-8 \(sizeDescription(payloadSize))",
+      configuration: .payload(size: payloadSize)
+    ) { benchmark in
+      benchmark.measurePayload(bytesPerIteration: payloadSize) {
+        for _ in benchmark.scaledIterations {
+          blackHole(payload.withUnsafeBytes { CRC32.checksum(bufferPointer: $0) })
+        }
+      }
+    }
+
+    Benchmark(
+      "FNV1a32 unrolled \(sizeDescription(payloadSize))",
+      configuration: .payload(size: payloadSize)
+    ) { benchmark in
+      benchmark.measurePayload(bytesPerIteration: payloadSize) {
+        for _ in benchmark.scaledIterations {
+          blackHole(payload.withUnsafeBytes { FNV1a32.hash(bufferPointer: $0) })
+        }
+      }
+    }
+  }
+
+  // Every connection derives its header keys from cached paths, and its length key from a
+  // request specific one.
+  Benchmark("KDF.deriveKey cached path") { benchmark in
+    let inputKeyMaterial = SymmetricKey(data: symmetricKey)
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      blackHole(
+        KDF.deriveKey(
+          inputKeyMaterial: inputKeyMaterial,
+          info: [Array("VMess Header AEAD Key".utf8), Array(nonce.prefix(8))]
+        )
+      )
+    }
+  }
+
+  Benchmark("KDF.deriveKey uncached path") { benchmark in
+    let inputKeyMaterial = SymmetricKey(data: symmetricKey)
+    benchmark.startMeasurement()
+    for _ in benchmark.scaledIterations {
+      blackHole(KDF.deriveKey(inputKeyMaterial: inputKeyMaterial, info: nonce))
+    }
+  }
+
+  for (contentSecurity, name) in contentSecurities {
+    for payloadSize in payloadSizes {
+      codecBenchmarks(contentSecurity: contentSecurity, name: name, payloadSize: payloadSize)
+    }
+  }
+}
@@ -0,0 +1,99 @@
+// swift-tools-version:5.9
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import PackageDescription
+
+let benchmark: Target.Dependency = .product(name: "Benchmark", package: "package-benchmark")
+let benchmarkPlugin: Target.PluginUsage = .plugin(name: "BenchmarkPlugin", package: "package-benchmark")
+let swiftCrypto: Target.Dependency = .product(name: "Crypto", package: "swift-crypto")
+let swiftNIOCore: Target.Dependency = .product(name: "NIOCore", package: "swift-nio")
+let swiftNIOEmbedded: Target.Dependency = .product(name: "NIOEmbedded", package: "swift-nio")
+
+let package = Package(
+  name: "benchmarks",
+  platforms: [
+    .macOS(.v13)
+  ],
+  dependencies: [
+    .package(path: "../"),
+    .package(url: "https://github.com/ordo-one/package-benchmark.git", from: "1.22.0"),
+    .package(url: "https://github.com/apple/swift-crypto.git", from: "3.0.0"),
+    .package(url: "https://github.com/apple/swift-nio.git", from: "2.32.1"),
+  ],
+  targets: [
+    .target(
+      name: "PayloadMetrics",
+      dependencies: [benchmark],
+      path: "Sources/PayloadMetrics"
+    ),
+    .executableTarget(
+      name: "NEHTTPBenchmarks",
+      dependencies: [
+        benchmark,
+        swiftNIOCore,
+        swiftNIOEmbedded,
+        .product(name: "NEHTTP", package: "swift-nio-proxies"),
+      ],
+      path: "Benchmarks/NEHTTPBenchmarks",
+      plugins: [benchmarkPlugin]
+    ),
+    .executableTarget(
+      name: "NESHAKE128Benchmarks",
+      dependencies: [
+        benchmark,
+        "PayloadMetrics",
+        .product(name: "NESHAKE128", package: "swift-nio-proxies"),
+      ],
+      path: "Benchmarks/NESHAKE128Benchmarks",
+      plugins: [benchmarkPlugin]
+    ),
+    .executableTarget(
+      name: "NESOCKSBenchmarks",
+      dependencies: [
+        benchmark,
+        swiftNIOCore,
+        swiftNIOEmbedded,
+        .product(name: "NESOCKS", package: "swift-nio-proxies"),
+      ],
+      path: "Benchmarks/NESOCKSBenchmarks",
+      plugins: [benchmarkPlugin]
+    ),
+    .executableTarget(
+      name: "NESSBenchmarks",
+      dependencies: [
+        benchmark,
+        swiftNIOCore,
+        swiftNIOEmbedded,
+        "PayloadMetrics",
+        .product(name: "NESS", package: "swift-nio-proxies"),
+      ],
+      path: "Benchmarks/NESSBenchmarks",
+      plugins: [benchmarkPlugin]
+    ),
+    .executableTarget(
+      name: "NEVMESSBenchmarks",
+      dependencies: [
+        benchmark,
+        swiftCrypto,
+        swiftNIOCore,
+        swiftNIOEmbedded,
+        "PayloadMetrics",
+        .product(name: "NEVMESS", package: "swift-nio-proxies"),
+      ],
+      path: "Benchmarks/NEVMESSBenchmarks",
+      plugins: [benchmarkPlugin]
+    ),
+  ]
+)
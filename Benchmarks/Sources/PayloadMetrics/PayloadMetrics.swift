@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Benchmark
+
+extension BenchmarkMetric {
+
+  /// The payload bytes processed per iteration.
+  public static let payloadBytes = BenchmarkMetric.custom(
+    "Payload bytes",
+    polarity: .prefersLarger,
+    useScalingFactor: true
+  )
+
+  /// The chunks sealed, opened or hashed per iteration.
+  public static let chunks = BenchmarkMetric.custom(
+    "Chunks",
+    polarity: .prefersLarger,
+    useScalingFactor: true
+  )
+
+  /// The payload bytes processed per second, in MB.
+  public static let payloadThroughput = BenchmarkMetric.custom(
+    "Payload throughput (MB/s)",
+    polarity: .prefersLarger,
+    useScalingFactor: false
+  )
+
+  /// The time per chunk, in nanoseconds.
+  public static let timePerChunk = BenchmarkMetric.custom(
+    "Time per chunk (ns)",
+    polarity: .prefersSmaller,
+    useScalingFactor: false
+  )
+
+  /// The metrics recorded by `Benchmark.measurePayload(bytesPerIteration:chunksPerIteration:_:)`.
+  public static let payload: [BenchmarkMetric] = [
+    .payloadBytes, .chunks, .payloadThroughput, .timePerChunk,
+  ]
+}
+
+extension Benchmark.Configuration {
+
+  /// The configuration of a benchmark that processes `size` payload bytes per iteration, which
+  /// records the payload metrics on top of the default ones. Payloads of 1 MiB and more run
+  /// unscaled to keep samples short.
+  public static func payload(size: Int) -> Benchmark.Configuration {
+    .init(
+      metrics: Benchmark.defaultConfiguration.metrics + BenchmarkMetric.payload,
+      scalingFactor: size >= 1_048_576 ? .one : .kilo
+    )
+  }
+}
+
+extension Benchmark {
+
+  /// Measure `body`, which runs all scaled iterations of this benchmark, and record the payload
+  /// metrics of the run.
+  ///
+  /// - Parameters:
+  ///   - bytesPerIteration: The payload bytes one iteration processes.
+  ///   - chunksPerIteration: The chunks one iteration processes, the chunk metrics are left out
+  ///     if `nil`.
+  ///   - body: The measured work.
+  public func measurePayload(
+    bytesPerIteration: Int,
+    chunksPerIteration: Int? = nil,
+    _ body: () throws -> Void
+  ) rethrows {
+    let clock = ContinuousClock()
+    startMeasurement()
+    let duration = try clock.measure(body)
+    stopMeasurement()
+
+    let iterationCount = scaledIterations.count
+    let (seconds, attoseconds) = duration.components
+    let nanoseconds = Double(seconds) * 1e9 + Double(attoseconds) / 1e9
+    guard nanoseconds > 0 else {
+      return
+    }
+
+    let byteCount = bytesPerIteration * iterationCount
+    measurement(.payloadBytes, byteCount)
+    // One byte per nanosecond is 1000 MB/s.
+    measurement(.payloadThroughput, Int(Double(byteCount) * 1e3 / nanoseconds))
+
+    if let chunksPerIteration, chunksPerIteration > 0 {
+      let chunkCount = chunksPerIteration * iterationCount
+      measurement(.chunks, chunkCount)
+      measurement(.timePerChunk, Int(nanoseconds / Double(chunkCount)))
+    }
+  }
+}
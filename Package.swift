@@ -15,6 +15,10 @@
 
 import PackageDescription
 
+let swiftNIOConcurrencyHelpers: Target.Dependency = .product(
+  name: "NIOConcurrencyHelpers",
+  package: "swift-nio"
+)
 let swiftNIOCore: Target.Dependency = .product(name: "NIOCore", package: "swift-nio")
 let swiftNIOEmbedded: Target.Dependency = .product(name: "NIOEmbedded", package: "swift-nio")
 let swiftNIOHTTP1: Target.Dependency = .product(name: "NIOHTTP1", package: "swift-nio")
@@ -33,6 +37,7 @@ let package = Package(
   products: [
     .library(name: "_NELinux", targets: ["_NELinux"]),
     .library(name: "NEHTTP", targets: ["NEHTTP"]),
+    .library(name: "NESHAKE128", targets: ["NESHAKE128"]),
     .library(name: "NESOCKS", targets: ["NESOCKS"]),
     .library(name: "NESS", targets: ["NESS"]),
     .library(name: "NEVMESS", targets: ["NEVMESS"]),
@@ -45,8 +50,9 @@ let package = Package(
     .package(url: "https://github.com/apple/swift-http-types.git", from: "1.0.3"),
   ],
   targets: [
-    .target(name: "_NELinux", dependencies: [swiftNIOCore]),
+    .target(name: "_NELinux", dependencies: [swiftNIOConcurrencyHelpers, swiftNIOCore]),
     .target(name: "CNESHAKE128"),
+    .target(name: "NEAEAD", dependencies: [swiftCrypto]),
     .target(
       name: "NEHTTP",
       dependencies: [
@@ -57,14 +63,22 @@ let package = Package(
     .target(name: "NEPrettyBytes"),
     .target(name: "NESHAKE128", dependencies: ["CNESHAKE128", "NEPrettyBytes", swiftCrypto]),
     .target(name: "NESOCKS", dependencies: ["_NELinux", swiftNIOCore]),
-    .target(name: "NESS", dependencies: ["_NELinux", "NEPrettyBytes", swiftCrypto, swiftNIOCore]),
+    .target(
+      name: "NESS",
+      dependencies: [
+        "_NELinux", "NEAEAD", "NEPrettyBytes", swiftCrypto, swiftNIOConcurrencyHelpers,
+        swiftNIOCore,
+      ]
+    ),
     .target(
       name: "NEVMESS",
       dependencies: [
         "_NELinux",
+        "NEAEAD",
         "NEPrettyBytes",
         "NESHAKE128",
         swiftCrypto,
+        swiftNIOConcurrencyHelpers,
         swiftNIOCore,
         swiftNIOSSL,
       ]
@@ -76,8 +90,9 @@ let package = Package(
         .product(name: "NIOHTTPTypes", package: "swift-nio-extras"),
       ]
     ),
-    .testTarget(name: "NELinuxTests", dependencies: ["_NELinux"]),
-    .testTarget(name: "NESHAKE128Tests", dependencies: ["NESHAKE128"]),
+    .testTarget(name: "NEAEADTests", dependencies: ["NEAEAD", swiftCrypto]),
+    .testTarget(name: "NELinuxTests", dependencies: ["_NELinux", swiftNIOCore]),
+    .testTarget(name: "NESHAKE128Tests", dependencies: ["CNESHAKE128", "NESHAKE128"]),
     .testTarget(name: "NESOCKSTests", dependencies: ["NESOCKS", swiftNIOCore, swiftNIOEmbedded]),
     .testTarget(
       name: "NESSTests",
@@ -90,7 +105,8 @@ let package = Package(
     .testTarget(
       name: "NEVMESSTests",
       dependencies: [
-        "NEPrettyBytes", "NEVMESS", "_NELinux", swiftCrypto, swiftNIOCore, swiftNIOEmbedded,
+        "NEPrettyBytes", "NESHAKE128", "NEVMESS", "_NELinux", swiftCrypto, swiftNIOCore,
+        swiftNIOEmbedded,
       ]
     ),
   ],
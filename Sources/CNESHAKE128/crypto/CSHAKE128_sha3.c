@@ -36,62 +36,48 @@
 
 // THIS FILE IS MOSTLY COPIED FROM [swift-nio-extras](https://github.com/apple/swift-nio-extras)
 
-#include "CSHAKE128_sha3.h"
+#include "CSHAKE128_sha3_internal.h"
 
-// update the state with given number of rounds
+// the reference tiny_sha3 permutation, kept to cross-check the unrolled one
 
-void CSHAKE128_sha3_keccakf(uint64_t st[25])
+static const uint64_t keccakf_rndc[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
+    0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+    0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
+    0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+    0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
+    0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+static const int keccakf_rotc[24] = {
+    1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
+    27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44
+};
+static const int keccakf_piln[24] = {
+    10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+    15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1
+};
+
+void CSHAKE128_sha3_keccakf_reference(uint64_t st[25])
 {
-    // constants
-    const uint64_t keccakf_rndc[24] = {
-        0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
-        0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
-        0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
-        0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
-        0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
-        0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
-        0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
-        0x8000000000008080, 0x0000000080000001, 0x8000000080008008
-    };
-    const int keccakf_rotc[24] = {
-        1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
-        27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44
-    };
-    const int keccakf_piln[24] = {
-        10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
-        15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1
-    };
-    
     // variables
     int i, j, r;
     uint64_t t, bc[5];
-    
-#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
-    uint8_t *v;
-    
-    // endianess conversion. this is redundant on little-endian targets
-    for (i = 0; i < 25; i++) {
-        v = (uint8_t *) &st[i];
-        st[i] = ((uint64_t) v[0])     | (((uint64_t) v[1]) << 8) |
-        (((uint64_t) v[2]) << 16) | (((uint64_t) v[3]) << 24) |
-        (((uint64_t) v[4]) << 32) | (((uint64_t) v[5]) << 40) |
-        (((uint64_t) v[6]) << 48) | (((uint64_t) v[7]) << 56);
-    }
-#endif
-    
+
     // actual iteration
     for (r = 0; r < KECCAKF_ROUNDS; r++) {
-        
+
         // Theta
         for (i = 0; i < 5; i++)
             bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
-        
+
         for (i = 0; i < 5; i++) {
             t = bc[(i + 4) % 5] ^ ROTL64(bc[(i + 1) % 5], 1);
             for (j = 0; j < 25; j += 5)
                 st[j + i] ^= t;
         }
-        
+
         // Rho Pi
         t = st[1];
         for (i = 0; i < 24; i++) {
@@ -100,7 +86,7 @@ void CSHAKE128_sha3_keccakf(uint64_t st[25])
             st[j] = ROTL64(t, keccakf_rotc[i]);
             t = bc[0];
         }
-        
+
         //  Chi
         for (j = 0; j < 25; j += 5) {
             for (i = 0; i < 5; i++)
@@ -108,25 +94,26 @@ void CSHAKE128_sha3_keccakf(uint64_t st[25])
             for (i = 0; i < 5; i++)
                 st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
         }
-        
+
         //  Iota
         st[0] ^= keccakf_rndc[r];
     }
-    
-#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
-    // endianess conversion. this is redundant on little-endian targets
-    for (i = 0; i < 25; i++) {
-        v = (uint8_t *) &st[i];
-        t = st[i];
-        v[0] = t & 0xFF;
-        v[1] = (t >> 8) & 0xFF;
-        v[2] = (t >> 16) & 0xFF;
-        v[3] = (t >> 24) & 0xFF;
-        v[4] = (t >> 32) & 0xFF;
-        v[5] = (t >> 40) & 0xFF;
-        v[6] = (t >> 48) & 0xFF;
-        v[7] = (t >> 56) & 0xFF;
-    }
+}
+
+#if !defined(CSHAKE128_KECCAKF_USE_REFERENCE) && KECCAKF_ROUNDS == 24
+#define KECCAK_RC_SCALAR(rc) (rc)
+
+KECCAK_DEFINE_PERMUTATION(, sha3_keccakf_unrolled, uint64_t, KECCAK_RC_SCALAR)
+#endif
+
+// update the state with given number of rounds
+
+void CSHAKE128_sha3_keccakf(uint64_t st[25])
+{
+#if defined(CSHAKE128_KECCAKF_USE_REFERENCE) || KECCAKF_ROUNDS != 24
+    CSHAKE128_sha3_keccakf_reference(st);
+#else
+    sha3_keccakf_unrolled(st);
 #endif
 }
 
@@ -145,23 +132,66 @@ int CSHAKE128_sha3_init(sha3_ctx_t *c, int mdlen)
     return 1;
 }
 
+// absorb whole 64-bit lanes starting at lane `k`
+
+static inline void sha3_absorb_lanes(uint64_t *q, int k, const uint8_t *in, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        q[k + i] ^= sha3_load64_le(in + 8 * i);
+}
+
 // update state with more data
 
 int CSHAKE128_sha3_update(sha3_ctx_t *c, const void *data, size_t len)
 {
-    size_t i;
-    int j;
-    
+    const uint8_t *in = (const uint8_t *) data;
+    int j, n;
+
     j = c->pt;
-    for (i = 0; i < len; i++) {
-        c->st.b[j++] ^= ((const uint8_t *) data)[i];
-        if (j >= c->rsiz) {
+
+    // head: bytes up to the next lane boundary
+    for (; len > 0 && (j & 7) != 0; len--) {
+        SHA3_XOR_BYTE(c, j, *in++);
+        if (++j >= c->rsiz) {
             CSHAKE128_sha3_keccakf(c->st.q);
             j = 0;
         }
     }
+
+    // complete the current block lane by lane
+    if (j > 0 && len >= (size_t) (c->rsiz - j)) {
+        n = (c->rsiz - j) >> 3;
+        sha3_absorb_lanes(c->st.q, j >> 3, in, n);
+        in += 8 * n;
+        len -= 8 * n;
+        CSHAKE128_sha3_keccakf(c->st.q);
+        j = 0;
+    }
+
+    // bulk: whole rate blocks, 21 lanes for SHAKE128
+    if (j == 0) {
+        n = c->rsiz >> 3;
+        for (; len >= (size_t) c->rsiz; len -= c->rsiz, in += c->rsiz) {
+            sha3_absorb_lanes(c->st.q, 0, in, n);
+            CSHAKE128_sha3_keccakf(c->st.q);
+        }
+    }
+
+    // remaining whole lanes, they never fill the block
+    n = (int) (len >> 3);
+    sha3_absorb_lanes(c->st.q, j >> 3, in, n);
+    in += 8 * n;
+    len -= 8 * n;
+    j += 8 * n;
+
+    // tail
+    for (; len > 0; len--, j++)
+        SHA3_XOR_BYTE(c, j, *in++);
+
     c->pt = j;
-    
+
     return 1;
 }
 
@@ -170,15 +200,15 @@ int CSHAKE128_sha3_update(sha3_ctx_t *c, const void *data, size_t len)
 int CSHAKE128_sha3_final(void *md, sha3_ctx_t *c)
 {
     int i;
-    
-    c->st.b[c->pt] ^= 0x06;
-    c->st.b[c->rsiz - 1] ^= 0x80;
+
+    SHA3_XOR_BYTE(c, c->pt, 0x06);
+    SHA3_XOR_BYTE(c, c->rsiz - 1, 0x80);
     CSHAKE128_sha3_keccakf(c->st.q);
-    
+
     for (i = 0; i < c->mdlen; i++) {
-        ((uint8_t *) md)[i] = c->st.b[i];
+        ((uint8_t *) md)[i] = SHA3_GET_BYTE(c, i);
     }
-    
+
     return 1;
 }
 
@@ -210,24 +240,53 @@ int CSHAKE128_shake_update(sha3_ctx_t *ctx, const void *data, size_t len) {
 // SHAKE128 and SHAKE256 extensible-output functionality
 void CSHAKE128_shake_xof(sha3_ctx_t *c)
 {
-    c->st.b[c->pt] ^= 0x1F;
-    c->st.b[c->rsiz - 1] ^= 0x80;
+    SHA3_XOR_BYTE(c, c->pt, 0x1F);
+    SHA3_XOR_BYTE(c, c->rsiz - 1, 0x80);
     CSHAKE128_sha3_keccakf(c->st.q);
     c->pt = 0;
 }
 
 void CSHAKE128_shake_read(sha3_ctx_t *c, void *out, size_t len)
 {
-    size_t i;
-    int j;
-    
+    uint8_t *o = (uint8_t *) out;
+    int j, n, i;
+
     j = c->pt;
-    for (i = 0; i < len; i++) {
+
+    // head: bytes up to the next lane boundary
+    for (; len > 0 && (j & 7) != 0; len--) {
+        if (j >= c->rsiz) {
+            CSHAKE128_sha3_keccakf(c->st.q);
+            j = 0;
+        }
+        *o++ = SHA3_GET_BYTE(c, j);
+        j++;
+    }
+
+    // whole lanes, a full block at a time once the position is block aligned
+    while (len >= 8) {
+        if (j >= c->rsiz) {
+            CSHAKE128_sha3_keccakf(c->st.q);
+            j = 0;
+        }
+        n = (c->rsiz - j) >> 3;
+        if ((size_t) n > (len >> 3))
+            n = (int) (len >> 3);
+        for (i = 0; i < n; i++)
+            sha3_store64_le(o + 8 * i, c->st.q[(j >> 3) + i]);
+        o += 8 * n;
+        len -= 8 * n;
+        j += 8 * n;
+    }
+
+    // tail
+    for (; len > 0; len--) {
         if (j >= c->rsiz) {
             CSHAKE128_sha3_keccakf(c->st.q);
             j = 0;
         }
-        ((uint8_t *) out)[i] = c->st.b[j++];
+        *o++ = SHA3_GET_BYTE(c, j);
+        j++;
     }
     c->pt = j;
 }
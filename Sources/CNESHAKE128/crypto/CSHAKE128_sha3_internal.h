@@ -0,0 +1,312 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2022 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+// The MIT License (MIT)
+//
+// Copyright (c) 2015 Markku-Juhani O. Saarinen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CSHAKE128_SHA3_INTERNAL_H
+#define CSHAKE128_SHA3_INTERNAL_H
+
+#include <string.h>
+
+#include "CSHAKE128_sha3.h"
+
+// the state keeps every lane in native byte order, so the permutation never
+// has to convert it. bytes are mapped onto lanes little-endian, as required by
+// FIPS 202: on little-endian targets that is just the `st.b` view, big-endian
+// targets go through the lane shifts and the swapped loads below.
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SHA3_XOR_BYTE(c, j, v) ((c)->st.b[(j)] ^= (v))
+#define SHA3_GET_BYTE(c, j) ((c)->st.b[(j)])
+#else
+#define SHA3_XOR_BYTE(c, j, v) ((c)->st.q[(j) >> 3] ^= ((uint64_t) (v)) << (8 * ((j) & 7)))
+#define SHA3_GET_BYTE(c, j) ((uint8_t) ((c)->st.q[(j) >> 3] >> (8 * ((j) & 7))))
+#endif
+
+static inline uint64_t sha3_load64_le(const uint8_t *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void sha3_store64_le(uint8_t *p, uint64_t v)
+{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, sizeof(v));
+}
+
+// the unrolled permutation, in the style of the XKCP "opt64" implementation.
+//
+// all 25 lanes live in locals and the two round halves ping-pong between the
+// `A` and `E` lane sets, so there is no `% 5` indexing and no table lookups:
+// the rotation offsets and the round constants are immediates. the lanes
+// 1, 2, 8, 12, 17 and 20 are kept complemented while the rounds run, which
+// lets Chi be computed with one NOT per row instead of one per lane. the
+// complement is applied on entry and removed on exit, so the state layout
+// seen by absorb/squeeze is unchanged.
+
+#define KECCAK_ROUND(A, E, rc) \
+    Da = Cu ^ ROTL64(Ce, 1); \
+    De = Ca ^ ROTL64(Ci, 1); \
+    Di = Ce ^ ROTL64(Co, 1); \
+    Do = Ci ^ ROTL64(Cu, 1); \
+    Du = Co ^ ROTL64(Ca, 1); \
+    A##ba ^= Da; \
+    Ba = A##ba; \
+    A##ge ^= De; \
+    Be = ROTL64(A##ge, 44); \
+    A##ki ^= Di; \
+    Bi = ROTL64(A##ki, 43); \
+    A##mo ^= Do; \
+    Bo = ROTL64(A##mo, 21); \
+    A##su ^= Du; \
+    Bu = ROTL64(A##su, 14); \
+    E##ba = Ba ^ (Be | Bi); \
+    E##ba ^= rc; \
+    Ca = E##ba; \
+    E##be = Be ^ ((~Bi) | Bo); \
+    Ce = E##be; \
+    E##bi = Bi ^ (Bo & Bu); \
+    Ci = E##bi; \
+    E##bo = Bo ^ (Bu | Ba); \
+    Co = E##bo; \
+    E##bu = Bu ^ (Ba & Be); \
+    Cu = E##bu; \
+    A##bo ^= Do; \
+    Ba = ROTL64(A##bo, 28); \
+    A##gu ^= Du; \
+    Be = ROTL64(A##gu, 20); \
+    A##ka ^= Da; \
+    Bi = ROTL64(A##ka, 3); \
+    A##me ^= De; \
+    Bo = ROTL64(A##me, 45); \
+    A##si ^= Di; \
+    Bu = ROTL64(A##si, 61); \
+    E##ga = Ba ^ (Be | Bi); \
+    Ca ^= E##ga; \
+    E##ge = Be ^ (Bi & Bo); \
+    Ce ^= E##ge; \
+    E##gi = Bi ^ (Bo | (~Bu)); \
+    Ci ^= E##gi; \
+    E##go = Bo ^ (Bu | Ba); \
+    Co ^= E##go; \
+    E##gu = Bu ^ (Ba & Be); \
+    Cu ^= E##gu; \
+    A##be ^= De; \
+    Ba = ROTL64(A##be, 1); \
+    A##gi ^= Di; \
+    Be = ROTL64(A##gi, 6); \
+    A##ko ^= Do; \
+    Bi = ROTL64(A##ko, 25); \
+    A##mu ^= Du; \
+    Bo = ROTL64(A##mu, 8); \
+    A##sa ^= Da; \
+    Bu = ROTL64(A##sa, 18); \
+    E##ka = Ba ^ (Be | Bi); \
+    Ca ^= E##ka; \
+    E##ke = Be ^ (Bi & Bo); \
+    Ce ^= E##ke; \
+    E##ki = Bi ^ ((~Bo) & Bu); \
+    Ci ^= E##ki; \
+    E##ko = (~Bo) ^ (Bu | Ba); \
+    Co ^= E##ko; \
+    E##ku = Bu ^ (Ba & Be); \
+    Cu ^= E##ku; \
+    A##bu ^= Du; \
+    Ba = ROTL64(A##bu, 27); \
+    A##ga ^= Da; \
+    Be = ROTL64(A##ga, 36); \
+    A##ke ^= De; \
+    Bi = ROTL64(A##ke, 10); \
+    A##mi ^= Di; \
+    Bo = ROTL64(A##mi, 15); \
+    A##so ^= Do; \
+    Bu = ROTL64(A##so, 56); \
+    E##ma = Ba ^ (Be & Bi); \
+    Ca ^= E##ma; \
+    E##me = Be ^ (Bi | Bo); \
+    Ce ^= E##me; \
+    E##mi = Bi ^ ((~Bo) | Bu); \
+    Ci ^= E##mi; \
+    E##mo = (~Bo) ^ (Bu & Ba); \
+    Co ^= E##mo; \
+    E##mu = Bu ^ (Ba | Be); \
+    Cu ^= E##mu; \
+    A##bi ^= Di; \
+    Ba = ROTL64(A##bi, 62); \
+    A##go ^= Do; \
+    Be = ROTL64(A##go, 55); \
+    A##ku ^= Du; \
+    Bi = ROTL64(A##ku, 39); \
+    A##ma ^= Da; \
+    Bo = ROTL64(A##ma, 41); \
+    A##se ^= De; \
+    Bu = ROTL64(A##se, 2); \
+    E##sa = Ba ^ ((~Be) & Bi); \
+    Ca ^= E##sa; \
+    E##se = (~Be) ^ (Bi | Bo); \
+    Ce ^= E##se; \
+    E##si = Bi ^ (Bo & Bu); \
+    Ci ^= E##si; \
+    E##so = Bo ^ (Bu | Ba); \
+    Co ^= E##so; \
+    E##su = Bu ^ (Ba & Be); \
+    Cu ^= E##su; \
+
+#define KECCAK_COMPLEMENT_LANES(A) \
+    A##be = ~A##be; \
+    A##bi = ~A##bi; \
+    A##go = ~A##go; \
+    A##ki = ~A##ki; \
+    A##mi = ~A##mi; \
+    A##sa = ~A##sa;
+
+// defines `static void name(T st[25])` running the unrolled permutation over
+// lanes of type `T`, `RC` converts a round constant into a `T`. the lane
+// operators and ROTL64 work unchanged on GCC/Clang vector types, which is how
+// the multi-buffer permutations share this code.
+
+#define KECCAK_DEFINE_PERMUTATION(ATTR, name, T, RC) \
+ATTR static void name(T st[25]) \
+{ \
+    T Aba, Abe, Abi, Abo, Abu; \
+    T Aga, Age, Agi, Ago, Agu; \
+    T Aka, Ake, Aki, Ako, Aku; \
+    T Ama, Ame, Ami, Amo, Amu; \
+    T Asa, Ase, Asi, Aso, Asu; \
+    T Eba, Ebe, Ebi, Ebo, Ebu; \
+    T Ega, Ege, Egi, Ego, Egu; \
+    T Eka, Eke, Eki, Eko, Eku; \
+    T Ema, Eme, Emi, Emo, Emu; \
+    T Esa, Ese, Esi, Eso, Esu; \
+    T Ba, Be, Bi, Bo, Bu; \
+    T Ca, Ce, Ci, Co, Cu; \
+    T Da, De, Di, Do, Du; \
+\
+    Aba = st[0]; \
+    Abe = st[1]; \
+    Abi = st[2]; \
+    Abo = st[3]; \
+    Abu = st[4]; \
+    Aga = st[5]; \
+    Age = st[6]; \
+    Agi = st[7]; \
+    Ago = st[8]; \
+    Agu = st[9]; \
+    Aka = st[10]; \
+    Ake = st[11]; \
+    Aki = st[12]; \
+    Ako = st[13]; \
+    Aku = st[14]; \
+    Ama = st[15]; \
+    Ame = st[16]; \
+    Ami = st[17]; \
+    Amo = st[18]; \
+    Amu = st[19]; \
+    Asa = st[20]; \
+    Ase = st[21]; \
+    Asi = st[22]; \
+    Aso = st[23]; \
+    Asu = st[24]; \
+\
+    KECCAK_COMPLEMENT_LANES(A) \
+\
+    Ca = Aba ^ Aga ^ Aka ^ Ama ^ Asa; \
+    Ce = Abe ^ Age ^ Ake ^ Ame ^ Ase; \
+    Ci = Abi ^ Agi ^ Aki ^ Ami ^ Asi; \
+    Co = Abo ^ Ago ^ Ako ^ Amo ^ Aso; \
+    Cu = Abu ^ Agu ^ Aku ^ Amu ^ Asu; \
+\
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x0000000000000001))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x0000000000008082))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x800000000000808a))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000080008000))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x000000000000808b))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x0000000080000001))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x8000000080008081))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000000008009))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x000000000000008a))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x0000000000000088))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x0000000080008009))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x000000008000000a))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x000000008000808b))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x800000000000008b))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x8000000000008089))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000000008003))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x8000000000008002))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000000000080))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x000000000000800a))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x800000008000000a))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x8000000080008081))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000000008080))); \
+    KECCAK_ROUND(A, E, RC(UINT64_C(0x0000000080000001))); \
+    KECCAK_ROUND(E, A, RC(UINT64_C(0x8000000080008008))); \
+\
+    KECCAK_COMPLEMENT_LANES(A) \
+\
+    st[0] = Aba; \
+    st[1] = Abe; \
+    st[2] = Abi; \
+    st[3] = Abo; \
+    st[4] = Abu; \
+    st[5] = Aga; \
+    st[6] = Age; \
+    st[7] = Agi; \
+    st[8] = Ago; \
+    st[9] = Agu; \
+    st[10] = Aka; \
+    st[11] = Ake; \
+    st[12] = Aki; \
+    st[13] = Ako; \
+    st[14] = Aku; \
+    st[15] = Ama; \
+    st[16] = Ame; \
+    st[17] = Ami; \
+    st[18] = Amo; \
+    st[19] = Amu; \
+    st[20] = Asa; \
+    st[21] = Ase; \
+    st[22] = Asi; \
+    st[23] = Aso; \
+    st[24] = Asu; \
+}
+
+#endif
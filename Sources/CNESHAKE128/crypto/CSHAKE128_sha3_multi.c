@@ -0,0 +1,233 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+// multi-buffer permutations and batch squeezing.
+//
+// the unrolled permutation is instantiated over GCC/Clang vector types, with
+// one lane of each vector per state: 4 states in AVX2 registers, 8 states in
+// AVX-512 registers and 2 states in NEON registers. the x86 paths are picked
+// at run time, everything else falls back to one scalar permutation per state.
+
+#include "CSHAKE128_sha3_internal.h"
+
+#if KECCAKF_ROUNDS == 24 && !defined(CSHAKE128_KECCAKF_USE_REFERENCE)
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA3_HAVE_X86_VECTORS 1
+#elif defined(__aarch64__)
+#define SHA3_HAVE_NEON_VECTORS 1
+#endif
+#endif
+
+#if defined(SHA3_HAVE_X86_VECTORS)
+
+typedef uint64_t sha3_v4_t __attribute__((vector_size(32)));
+typedef uint64_t sha3_v8_t __attribute__((vector_size(64)));
+
+#define KECCAK_RC_V4(rc) ((sha3_v4_t) { (rc), (rc), (rc), (rc) })
+#define KECCAK_RC_V8(rc) ((sha3_v8_t) { (rc), (rc), (rc), (rc), (rc), (rc), (rc), (rc) })
+
+KECCAK_DEFINE_PERMUTATION(__attribute__((target("avx2"))), sha3_keccakf_v4, sha3_v4_t, KECCAK_RC_V4)
+KECCAK_DEFINE_PERMUTATION(__attribute__((target("avx512f"))), sha3_keccakf_v8, sha3_v8_t, KECCAK_RC_V8)
+
+__attribute__((target("avx2")))
+static void sha3_keccakf_x4_avx2(uint64_t *st[4])
+{
+    sha3_v4_t v[25];
+    int i;
+
+    for (i = 0; i < 25; i++)
+        v[i] = (sha3_v4_t) { st[0][i], st[1][i], st[2][i], st[3][i] };
+    sha3_keccakf_v4(v);
+    for (i = 0; i < 25; i++) {
+        st[0][i] = v[i][0];
+        st[1][i] = v[i][1];
+        st[2][i] = v[i][2];
+        st[3][i] = v[i][3];
+    }
+}
+
+__attribute__((target("avx512f")))
+static void sha3_keccakf_x8_avx512(uint64_t *st[8])
+{
+    sha3_v8_t v[25];
+    int i, k;
+
+    for (i = 0; i < 25; i++)
+        v[i] = (sha3_v8_t) {
+            st[0][i], st[1][i], st[2][i], st[3][i],
+            st[4][i], st[5][i], st[6][i], st[7][i]
+        };
+    sha3_keccakf_v8(v);
+    for (i = 0; i < 25; i++)
+        for (k = 0; k < 8; k++)
+            st[k][i] = v[i][k];
+}
+
+#elif defined(SHA3_HAVE_NEON_VECTORS)
+
+typedef uint64_t sha3_v2_t __attribute__((vector_size(16)));
+
+#define KECCAK_RC_V2(rc) ((sha3_v2_t) { (rc), (rc) })
+
+KECCAK_DEFINE_PERMUTATION(, sha3_keccakf_v2, sha3_v2_t, KECCAK_RC_V2)
+
+static void sha3_keccakf_x2_neon(uint64_t *st0, uint64_t *st1)
+{
+    sha3_v2_t v[25];
+    int i;
+
+    for (i = 0; i < 25; i++)
+        v[i] = (sha3_v2_t) { st0[i], st1[i] };
+    sha3_keccakf_v2(v);
+    for (i = 0; i < 25; i++) {
+        st0[i] = v[i][0];
+        st1[i] = v[i][1];
+    }
+}
+
+#endif
+
+void CSHAKE128_sha3_keccakf_x4(uint64_t *st[4])
+{
+#if defined(SHA3_HAVE_X86_VECTORS)
+    if (__builtin_cpu_supports("avx2")) {
+        sha3_keccakf_x4_avx2(st);
+        return;
+    }
+#elif defined(SHA3_HAVE_NEON_VECTORS)
+    sha3_keccakf_x2_neon(st[0], st[1]);
+    sha3_keccakf_x2_neon(st[2], st[3]);
+    return;
+#endif
+    CSHAKE128_sha3_keccakf(st[0]);
+    CSHAKE128_sha3_keccakf(st[1]);
+    CSHAKE128_sha3_keccakf(st[2]);
+    CSHAKE128_sha3_keccakf(st[3]);
+}
+
+void CSHAKE128_sha3_keccakf_x8(uint64_t *st[8])
+{
+#if defined(SHA3_HAVE_X86_VECTORS)
+    if (__builtin_cpu_supports("avx512f")) {
+        sha3_keccakf_x8_avx512(st);
+        return;
+    }
+#endif
+    CSHAKE128_sha3_keccakf_x4(st);
+    CSHAKE128_sha3_keccakf_x4(st + 4);
+}
+
+// permute `n` states, as many at a time as the target allows
+
+static void sha3_keccakf_many(uint64_t **st, size_t n)
+{
+    for (; n >= 8; n -= 8, st += 8)
+        CSHAKE128_sha3_keccakf_x8(st);
+    for (; n >= 4; n -= 4, st += 4)
+        CSHAKE128_sha3_keccakf_x4(st);
+#if defined(SHA3_HAVE_NEON_VECTORS)
+    for (; n >= 2; n -= 2, st += 2)
+        sha3_keccakf_x2_neon(st[0], st[1]);
+#endif
+    for (; n > 0; n--, st++)
+        CSHAKE128_sha3_keccakf(*st);
+}
+
+// copy `len` output bytes starting at byte `j` of the state
+
+static void sha3_extract(const sha3_ctx_t *c, int j, uint8_t *out, size_t len)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(out, c->st.b + j, len);
+#else
+    size_t i;
+
+    for (i = 0; i < len; i++, j++)
+        out[i] = SHA3_GET_BYTE(c, j);
+#endif
+}
+
+static int sha3_same_position(sha3_ctx_t **c, int n)
+{
+    int i;
+
+    for (i = 1; i < n; i++)
+        if (c[i]->pt != c[0]->pt || c[i]->rsiz != c[0]->rsiz)
+            return 0;
+    return 1;
+}
+
+static void sha3_shake_read_n(sha3_ctx_t **c, uint8_t **out, int n, size_t len)
+{
+    uint64_t *st[8];
+    size_t m, offset;
+    int i, j;
+
+    if (!sha3_same_position(c, n)) {
+        for (i = 0; i < n; i++)
+            CSHAKE128_shake_read(c[i], out[i], len);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+        st[i] = c[i]->st.q;
+
+    j = c[0]->pt;
+    for (offset = 0; offset < len; offset += m) {
+        if (j >= c[0]->rsiz) {
+            sha3_keccakf_many(st, n);
+            j = 0;
+        }
+        m = (size_t) (c[0]->rsiz - j);
+        if (m > len - offset)
+            m = len - offset;
+        for (i = 0; i < n; i++)
+            sha3_extract(c[i], j, out[i] + offset, m);
+        j += (int) m;
+    }
+
+    for (i = 0; i < n; i++)
+        c[i]->pt = j;
+}
+
+void CSHAKE128_shake_read_x4(sha3_ctx_t *c[4], uint8_t *out[4], size_t len)
+{
+    sha3_shake_read_n(c, out, 4, len);
+}
+
+void CSHAKE128_shake_read_x8(sha3_ctx_t *c[8], uint8_t *out[8], size_t len)
+{
+    sha3_shake_read_n(c, out, 8, len);
+}
+
+void CSHAKE128_shake_squeeze_blocks(sha3_ctx_t **c, uint8_t **out, size_t count)
+{
+    uint64_t *st[8];
+    size_t i, k, base, n;
+
+    for (base = 0; base < count; base += n) {
+        n = count - base < 8 ? count - base : 8;
+
+        // states that were squeezed to the end of their block need a permutation first
+        for (i = 0, k = 0; i < n; i++)
+            if (c[base + i]->pt >= c[base + i]->rsiz)
+                st[k++] = c[base + i]->st.q;
+        sha3_keccakf_many(st, k);
+
+        for (i = 0; i < n; i++) {
+            sha3_extract(c[base + i], 0, out[base + i], (size_t) c[base + i]->rsiz);
+            c[base + i]->pt = c[base + i]->rsiz;
+        }
+    }
+}
@@ -51,6 +51,9 @@
 #endif
 
 // state context
+//
+// Lanes are kept in native byte order, `st.b` only matches the FIPS 202 byte
+// layout on little-endian targets.
 typedef struct {
     union {                                 // state:
         uint8_t b[200];                     // 8-bit bytes
@@ -60,8 +63,14 @@ typedef struct {
 } sha3_ctx_t;
 
 // Compression function.
+//
+// Defaults to the unrolled, lane-complementing permutation. Define
+// CSHAKE128_KECCAKF_USE_REFERENCE to route it through the reference loop.
 void CSHAKE128_sha3_keccakf(uint64_t st[25]);
 
+// Reference tiny_sha3 compression function, used to cross-check the default one.
+void CSHAKE128_sha3_keccakf_reference(uint64_t st[25]);
+
 // OpenSSL - like interfece
 int CSHAKE128_sha3_init(sha3_ctx_t *c, int mdlen);    // mdlen = hash output in bytes
 int CSHAKE128_sha3_update(sha3_ctx_t *c, const void *data, size_t len);
@@ -81,4 +90,20 @@ int CSHAKE128_shake_update(sha3_ctx_t *ctx, const void *data, size_t len);
 void CSHAKE128_shake_xof(sha3_ctx_t *c);
 void CSHAKE128_shake_read(sha3_ctx_t *c, void *out, size_t len);
 
+// Multi-buffer compression functions, permuting 4 or 8 independent states at
+// once with AVX2, AVX-512 or NEON where available.
+void CSHAKE128_sha3_keccakf_x4(uint64_t *st[4]);
+void CSHAKE128_sha3_keccakf_x8(uint64_t *st[8]);
+
+// Squeeze `len` bytes from each of 4 or 8 contexts. The multi-buffer path is
+// used when all contexts share the same position, otherwise they are read one
+// by one.
+void CSHAKE128_shake_read_x4(sha3_ctx_t *c[4], uint8_t *out[4], size_t len);
+void CSHAKE128_shake_read_x8(sha3_ctx_t *c[8], uint8_t *out[8], size_t len);
+
+// Squeeze one whole rate block from each of `count` contexts. Every context
+// must sit on a block boundary: right after CSHAKE128_shake_xof or after a
+// previous block squeeze.
+void CSHAKE128_shake_squeeze_blocks(sha3_ctx_t **c, uint8_t **out, size_t count);
+
 #endif
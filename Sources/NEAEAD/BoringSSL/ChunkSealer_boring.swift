@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+#if !canImport(CommonCrypto)
+@_implementationOnly import CCryptoBoringSSL
+import Crypto
+
+final class OpenSSLChunkSealerImpl {
+
+  private let context: UnsafeMutablePointer<EVP_AEAD_CTX>
+
+  init(algorithm: ChunkSealer.Algorithm, key: SymmetricKey) throws {
+    let aead: OpaquePointer
+    switch algorithm {
+    case .aes128Gcm:
+      guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
+        throw CryptoKitError.incorrectKeySize
+      }
+      aead = CCryptoBoringSSL_EVP_aead_aes_128_gcm()
+    case .aes256Gcm:
+      guard key.bitCount == SymmetricKeySize.bits256.bitCount else {
+        throw CryptoKitError.incorrectKeySize
+      }
+      aead = CCryptoBoringSSL_EVP_aead_aes_256_gcm()
+    case .chaCha20Poly1305:
+      guard key.bitCount == SymmetricKeySize.bits256.bitCount else {
+        throw CryptoKitError.incorrectKeySize
+      }
+      aead = CCryptoBoringSSL_EVP_aead_chacha20_poly1305()
+    }
+
+    let context = UnsafeMutablePointer<EVP_AEAD_CTX>.allocate(capacity: 1)
+    context.initialize(to: .init())
+
+    let retval = key.withUnsafeBytes {
+      CCryptoBoringSSL_EVP_AEAD_CTX_init(
+        context,
+        aead,
+        $0.bindMemory(to: UInt8.self).baseAddress,
+        $0.count,
+        ChunkSealer.tagByteCount,
+        nil
+      )
+    }
+    guard retval == 1 else {
+      context.deinitialize(count: 1)
+      context.deallocate()
+      throw CryptoKitError.underlyingCoreCryptoError(
+        error: Int32(CCryptoBoringSSL_ERR_get_error())
+      )
+    }
+    self.context = context
+  }
+
+  deinit {
+    CCryptoBoringSSL_EVP_AEAD_CTX_cleanup(context)
+    context.deinitialize(count: 1)
+    context.deallocate()
+  }
+
+  func seal(
+    _ message: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    var outputLength = 0
+    let retval = CCryptoBoringSSL_EVP_AEAD_CTX_seal(
+      context,
+      output.bindMemory(to: UInt8.self).baseAddress,
+      &outputLength,
+      output.count,
+      nonce.bindMemory(to: UInt8.self).baseAddress,
+      nonce.count,
+      message.bindMemory(to: UInt8.self).baseAddress,
+      message.count,
+      nil,
+      0
+    )
+    guard retval == 1, outputLength == message.count + ChunkSealer.tagByteCount else {
+      throw CryptoKitError.underlyingCoreCryptoError(
+        error: Int32(CCryptoBoringSSL_ERR_get_error())
+      )
+    }
+  }
+
+  func open(
+    _ sealed: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    var outputLength = 0
+    let retval = CCryptoBoringSSL_EVP_AEAD_CTX_open(
+      context,
+      output.bindMemory(to: UInt8.self).baseAddress,
+      &outputLength,
+      output.count,
+      nonce.bindMemory(to: UInt8.self).baseAddress,
+      nonce.count,
+      sealed.bindMemory(to: UInt8.self).baseAddress,
+      sealed.count,
+      nil,
+      0
+    )
+    guard retval == 1, outputLength == sealed.count - ChunkSealer.tagByteCount else {
+      CCryptoBoringSSL_ERR_clear_error()
+      throw CryptoKitError.authenticationFailure
+    }
+  }
+}
+#endif
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+
+#if canImport(CommonCrypto)
+private typealias ChunkSealerImpl = CryptoKitChunkSealerImpl
+#else
+private typealias ChunkSealerImpl = OpenSSLChunkSealerImpl
+#endif
+
+/// An AEAD sealer that encrypts and decrypts VMESS and Shadowsocks chunks straight into
+/// caller-provided memory.
+///
+/// Unlike `AES.GCM.seal` and `ChaChaPoly.seal`, which return a freshly allocated sealed box, the
+/// sealer writes `ciphertext || tag` into the output buffer, so a frame can be assembled in its
+/// final `ByteBuffer` without intermediate copies. Opening works the same way in reverse. The key
+/// is set up once per sealer.
+package struct ChunkSealer {
+
+  package enum Algorithm: Sendable {
+    case aes128Gcm
+    case aes256Gcm
+    case chaCha20Poly1305
+  }
+
+  /// The size of the authentication tag appended to every sealed chunk.
+  package static let tagByteCount = 16
+
+  private let impl: ChunkSealerImpl
+
+  /// Creates a sealer for `algorithm` using `key`.
+  /// - Parameters:
+  ///   - algorithm: The AEAD algorithm.
+  ///   - key: A 128-bit key for AES-128-GCM, or a 256-bit key for AES-256-GCM and
+  ///     ChaCha20-Poly1305.
+  package init(algorithm: Algorithm, key: SymmetricKey) throws {
+    self.impl = try ChunkSealerImpl(algorithm: algorithm, key: key)
+  }
+
+  /// Seals `message` into the first `message.count + tagByteCount` bytes of `output`.
+  ///
+  /// - Parameters:
+  ///   - message: The plaintext to seal, it must either not overlap with `output` or start at
+  ///     the same address, which seals it in place.
+  ///   - output: The memory to write `ciphertext || tag` to.
+  ///   - nonce: The 12-byte nonce.
+  package func seal(
+    _ message: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    precondition(output.count >= message.count + Self.tagByteCount)
+    try impl.seal(message, into: output, nonce: nonce)
+  }
+}
+
+extension ChunkSealer {
+
+  /// Opens `sealed`, a `ciphertext || tag` chunk, into the first `sealed.count - tagByteCount`
+  /// bytes of `output`.
+  ///
+  /// Nothing should be read from `output` if this throws.
+  /// - Parameters:
+  ///   - sealed: The sealed chunk, it must not overlap with `output`.
+  ///   - output: The memory to write the plaintext to.
+  ///   - nonce: The 12-byte nonce.
+  package func open(
+    _ sealed: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    guard sealed.count >= Self.tagByteCount else {
+      throw CryptoKitError.incorrectParameterSize
+    }
+    precondition(output.count >= sealed.count - Self.tagByteCount)
+    try impl.open(sealed, into: output, nonce: nonce)
+  }
+}
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+#if canImport(CommonCrypto)
+import Crypto
+import Foundation
+
+// CryptoKit has no API to seal or open into caller-provided memory, so the results are copied out.
+struct CryptoKitChunkSealerImpl {
+
+  private let algorithm: ChunkSealer.Algorithm
+
+  private let key: SymmetricKey
+
+  init(algorithm: ChunkSealer.Algorithm, key: SymmetricKey) throws {
+    switch algorithm {
+    case .aes128Gcm:
+      guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
+        throw CryptoKitError.incorrectKeySize
+      }
+    case .aes256Gcm, .chaCha20Poly1305:
+      guard key.bitCount == SymmetricKeySize.bits256.bitCount else {
+        throw CryptoKitError.incorrectKeySize
+      }
+    }
+    self.algorithm = algorithm
+    self.key = key
+  }
+
+  func seal(
+    _ message: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    let ciphertext: Data
+    let tag: Data
+    switch algorithm {
+    case .aes128Gcm, .aes256Gcm:
+      let sealedBox = try AES.GCM.seal(message, using: key, nonce: .init(data: nonce))
+      ciphertext = sealedBox.ciphertext
+      tag = sealedBox.tag
+    case .chaCha20Poly1305:
+      let sealedBox = try ChaChaPoly.seal(message, using: key, nonce: .init(data: nonce))
+      ciphertext = sealedBox.ciphertext
+      tag = sealedBox.tag
+    }
+    output.copyBytes(from: ciphertext)
+    UnsafeMutableRawBufferPointer(rebasing: output[ciphertext.count...]).copyBytes(from: tag)
+  }
+
+  func open(
+    _ sealed: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    nonce: UnsafeRawBufferPointer
+  ) throws {
+    let ciphertext = UnsafeRawBufferPointer(rebasing: sealed.dropLast(ChunkSealer.tagByteCount))
+    let tag = UnsafeRawBufferPointer(rebasing: sealed.suffix(ChunkSealer.tagByteCount))
+    let plaintext: Data
+    switch algorithm {
+    case .aes128Gcm, .aes256Gcm:
+      let sealedBox = try AES.GCM.SealedBox(
+        nonce: .init(data: nonce),
+        ciphertext: ciphertext,
+        tag: tag
+      )
+      plaintext = try AES.GCM.open(sealedBox, using: key)
+    case .chaCha20Poly1305:
+      let sealedBox = try ChaChaPoly.SealedBox(
+        nonce: .init(data: nonce),
+        ciphertext: ciphertext,
+        tag: tag
+      )
+      plaintext = try ChaChaPoly.open(sealedBox, using: key)
+    }
+    output.copyBytes(from: plaintext)
+  }
+}
+#endif
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import HTTPTypes
+import NIOCore
+import NIOHTTP1
+
+extension ByteBuffer {
+
+  /// Read a HTTP CONNECT request head without a HTTP codec.
+  ///
+  /// Only the request line and header fields are parsed, a CONNECT request has no body. The
+  /// authority defaults to port 443 when the request target has none, like `HTTPRequest(_:)`.
+  ///
+  /// - Parameter maximumLength: The maximum byte count of the request head.
+  /// - Throws: `HTTPProxyError.unacceptableStatusCode(_:)` with `.methodNotAllowed` for other
+  ///     methods, `.requestHeaderFieldsTooLarge` if the head is longer than `maximumLength` and
+  ///     `.badRequest` if the head is malformed.
+  /// - Returns: The version and request, or nil if the head is incomplete.
+  mutating func readCONNECTRequestHead(maximumLength: Int) throws -> (HTTPVersion, HTTPRequest)? {
+    guard let headLength = headLengthOfReadableBytes() else {
+      guard readableBytes <= maximumLength else {
+        throw HTTPProxyError.unacceptableStatusCode(.requestHeaderFieldsTooLarge)
+      }
+      return nil
+    }
+    guard headLength <= maximumLength else {
+      throw HTTPProxyError.unacceptableStatusCode(.requestHeaderFieldsTooLarge)
+    }
+
+    // swift-format-ignore: NeverForceUnwrap
+    var head = readSlice(length: headLength)!
+
+    guard let requestLine = head.readHTTPLine() else {
+      throw HTTPProxyError.unacceptableStatusCode(.badRequest)
+    }
+    let components = requestLine.readableBytesView.split(
+      separator: UInt8(ascii: " "),
+      maxSplits: 2,
+      omittingEmptySubsequences: false
+    )
+    guard components.count == 3, !components[1].isEmpty else {
+      throw HTTPProxyError.unacceptableStatusCode(.badRequest)
+    }
+    guard components[0].elementsEqual("CONNECT".utf8) else {
+      throw HTTPProxyError.unacceptableStatusCode(.methodNotAllowed)
+    }
+
+    let version: HTTPVersion
+    if components[2].elementsEqual("HTTP/1.1".utf8) {
+      version = .http1_1
+    } else if components[2].elementsEqual("HTTP/1.0".utf8) {
+      version = .http1_0
+    } else {
+      throw HTTPProxyError.unacceptableStatusCode(.badRequest)
+    }
+
+    let target = String(decoding: components[1], as: UTF8.self)
+    let hasPort = target.hasPrefix("[") ? target.contains("]:") : target.contains(":")
+
+    var headerFields = HTTPFields()
+    var firstHost = true
+    while let line = head.readHTTPLine(), line.readableBytes > 0 {
+      let bytes = line.readableBytesView
+      guard let colon = bytes.firstIndex(of: UInt8(ascii: ":")) else {
+        throw HTTPProxyError.unacceptableStatusCode(.badRequest)
+      }
+      let name = String(decoding: bytes[..<colon], as: UTF8.self)
+      let value = bytes[bytes.index(after: colon)...].trimmingHTTPWhitespaces()
+      // `Host` duplicates the authority, drop it like `HTTPFields(_:splitCookie:)` does.
+      if firstHost && name.lowercased() == "host" {
+        firstHost = false
+        continue
+      }
+      if let name = HTTPField.Name(name) {
+        headerFields.append(HTTPField(name: name, value: String(decoding: value, as: UTF8.self)))
+      }
+    }
+
+    let request = HTTPRequest(
+      method: .connect,
+      scheme: "https",
+      authority: hasPort ? target : "\(target):443",
+      path: "",
+      headerFields: headerFields
+    )
+    return (version, request)
+  }
+
+  /// Returns the byte count of the readable bytes up to and including the first empty line, or
+  /// nil if there is no empty line yet.
+  private func headLengthOfReadableBytes() -> Int? {
+    withUnsafeReadableBytes { bytes in
+      guard bytes.count >= 4 else {
+        return nil
+      }
+      var index = 3
+      while index < bytes.count {
+        switch bytes[index] {
+        case UInt8(ascii: "\n"):
+          if bytes[index - 1] == UInt8(ascii: "\r") && bytes[index - 2] == UInt8(ascii: "\n")
+            && bytes[index - 3] == UInt8(ascii: "\r")
+          {
+            return index + 1
+          }
+          // This can only be the first LF of the empty line.
+          index += 2
+        case UInt8(ascii: "\r"):
+          index += 1
+        default:
+          // No CRLF CRLF ending within the next three bytes can contain this byte.
+          index += 4
+        }
+      }
+      return nil
+    }
+  }
+
+  /// Read a line terminated by CRLF, the terminator is consumed but not returned.
+  private mutating func readHTTPLine() -> ByteBuffer? {
+    guard let index = readableBytesView.firstIndex(of: UInt8(ascii: "\n")) else {
+      return nil
+    }
+    let length = index - readerIndex
+    guard length > 0, getInteger(at: index - 1, as: UInt8.self) == UInt8(ascii: "\r") else {
+      return nil
+    }
+    let line = readSlice(length: length - 1)
+    moveReaderIndex(forwardBy: 2)
+    return line
+  }
+}
+
+extension Collection where Element == UInt8 {
+
+  fileprivate func trimmingHTTPWhitespaces() -> SubSequence {
+    let isWhitespace = { (byte: UInt8) in byte == UInt8(ascii: " ") || byte == UInt8(ascii: "\t") }
+    guard let first = firstIndex(where: { !isWhitespace($0) }) else {
+      return self[endIndex...]
+    }
+    var last = first
+    var index = first
+    while index != endIndex {
+      if !isWhitespace(self[index]) {
+        last = index
+      }
+      formIndex(after: &index)
+    }
+    return self[first...last]
+  }
+}
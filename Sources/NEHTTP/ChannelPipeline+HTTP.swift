@@ -26,13 +26,15 @@ extension ChannelPipeline {
   ///   - authenticationRequired: A boolean value to determinse whether HTTP proxy client should perform proxy authentication.
   ///   - preferHTTPTunneling: A boolean value use to determinse whether HTTP proxy client should use CONNECT method. Defaults to `true`.
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - instrumentation: The instrumentation to report handshake events to. Defaults to `nil`.
   /// - Returns: An `EventLoopFuture` that will fire when the pipeline is configured.
   public func addHTTPProxyClientHandlers(
     position: ChannelPipeline.Position = .last,
     passwordReference: String,
     authenticationRequired: Bool,
     preferHTTPTunneling: Bool = true,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) -> EventLoopFuture<Void> {
 
     guard eventLoop.inEventLoop else {
@@ -42,7 +44,8 @@ extension ChannelPipeline {
           passwordReference: passwordReference,
           authenticationRequired: authenticationRequired,
           preferHTTPTunneling: preferHTTPTunneling,
-          destinationAddress: destinationAddress
+          destinationAddress: destinationAddress,
+          instrumentation: instrumentation
         )
       }
     }
@@ -53,7 +56,8 @@ extension ChannelPipeline {
         passwordReference: passwordReference,
         authenticationRequired: authenticationRequired,
         preferHTTPTunneling: preferHTTPTunneling,
-        destinationAddress: destinationAddress
+        destinationAddress: destinationAddress,
+        instrumentation: instrumentation
       )
     }
   }
@@ -63,6 +67,15 @@ extension ChannelPipeline {
   ///   - position: The position in the `ChannelPipeline` where to add the HTTP proxy server handlers. Defaults to `.last`.
   ///   - passwordReference: The credentials to use when authenticate this connection. Defaults to `""`.
   ///   - authenticationRequired: A boolean value to determinse whether HTTP proxy server should perform proxy authentication. Defaults to `false`.
+  ///   - tunnelingOnly: A boolean value determines whether HTTP proxy server only accepts CONNECT
+  ///     tunnels, in which case the request head is parsed without a HTTP codec in the pipeline
+  ///     and other requests are rejected. Defaults to `false`.
+  ///   - streaming: A boolean value determines whether plain HTTP requests are re-encoded in
+  ///     streaming mode, see `PlainHTTPRequestEncoder.init(streaming:)`. Ignored when
+  ///     `tunnelingOnly` is `true`. Defaults to `false`.
+  ///   - connectionPool: The pool plain HTTP requests are forwarded over, see
+  ///     `HTTPProxyRecipientHandelr.init(passwordReference:authenticationRequired:streaming:connectionPool:completion:)`.
+  ///     Ignored when `tunnelingOnly` is `true`. Defaults to `nil`.
   ///   - completion: The completion handler to use when handshake completed and outbound channel established.
   ///       this completion pass request info, server channel and outbound client channel and returns `EventLoopFuture<Void>`.
   /// - Returns: An `EventLoopFuture` that will fire when the pipeline is configured.
@@ -70,6 +83,9 @@ extension ChannelPipeline {
     position: ChannelPipeline.Position = .last,
     passwordReference: String = "",
     authenticationRequired: Bool = false,
+    tunnelingOnly: Bool = false,
+    streaming: Bool = false,
+    connectionPool: HTTPUpstreamConnectionPool? = nil,
     completion: @escaping @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
   ) -> EventLoopFuture<Void> {
 
@@ -79,6 +95,9 @@ extension ChannelPipeline {
           position: position,
           passwordReference: passwordReference,
           authenticationRequired: authenticationRequired,
+          tunnelingOnly: tunnelingOnly,
+          streaming: streaming,
+          connectionPool: connectionPool,
           completion: completion
         )
       }
@@ -89,6 +108,9 @@ extension ChannelPipeline {
         position: position,
         passwordReference: passwordReference,
         authenticationRequired: authenticationRequired,
+        tunnelingOnly: tunnelingOnly,
+        streaming: streaming,
+        connectionPool: connectionPool,
         completion: completion
       )
     }
@@ -104,13 +126,15 @@ extension ChannelPipeline.SynchronousOperations {
   ///   - authenticationRequired: A boolean value to determinse whether HTTP proxy client should perform proxy authentication.
   ///   - preferHTTPTunneling: A boolean value use to determinse whether HTTP proxy client should use CONNECT method. Defaults to `true.`
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - instrumentation: The instrumentation to report handshake events to. Defaults to `nil`.
   /// - Throws: If the pipeline could not be configured.
   public func addHTTPProxyClientHandlers(
     position: ChannelPipeline.Position = .last,
     passwordReference: String,
     authenticationRequired: Bool,
     preferHTTPTunneling: Bool = true,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) throws {
     eventLoop.assertInEventLoop()
     let handlers: [ChannelHandler] = [
@@ -118,7 +142,8 @@ extension ChannelPipeline.SynchronousOperations {
         passwordReference: passwordReference,
         authenticationRequired: authenticationRequired,
         preferHTTPTunneling: preferHTTPTunneling,
-        destinationAddress: destinationAddress
+        destinationAddress: destinationAddress,
+        instrumentation: instrumentation
       )
     ]
     try self.addHTTPClientHandlers()
@@ -130,6 +155,15 @@ extension ChannelPipeline.SynchronousOperations {
   ///   - position: The position in the `ChannelPipeline` where to add the HTTP proxy server handlers. Defaults to `.last`.
   ///   - passwordReference: The credentials to use when authenticate this connection. Defaults to `""`.
   ///   - authenticationRequired: A boolean value to determinse whether HTTP proxy server should perform proxy authentication. Defaults to `false`.
+  ///   - tunnelingOnly: A boolean value determines whether HTTP proxy server only accepts CONNECT
+  ///     tunnels, in which case the request head is parsed without a HTTP codec in the pipeline
+  ///     and other requests are rejected. Defaults to `false`.
+  ///   - streaming: A boolean value determines whether plain HTTP requests are re-encoded in
+  ///     streaming mode, see `PlainHTTPRequestEncoder.init(streaming:)`. Ignored when
+  ///     `tunnelingOnly` is `true`. Defaults to `false`.
+  ///   - connectionPool: The pool plain HTTP requests are forwarded over, see
+  ///     `HTTPProxyRecipientHandelr.init(passwordReference:authenticationRequired:streaming:connectionPool:completion:)`.
+  ///     Ignored when `tunnelingOnly` is `true`. Defaults to `nil`.
   ///   - completion: The completion handler to use when handshake completed and outbound channel established.
   ///       this completion pass request info, server channel and outbound client channel and returns `EventLoopFuture<Void>`.
   /// - Throws: If the pipeline could not be configured.
@@ -137,15 +171,30 @@ extension ChannelPipeline.SynchronousOperations {
     position: ChannelPipeline.Position = .last,
     passwordReference: String = "",
     authenticationRequired: Bool = false,
+    tunnelingOnly: Bool = false,
+    streaming: Bool = false,
+    connectionPool: HTTPUpstreamConnectionPool? = nil,
     completion: @escaping @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
   ) throws {
     self.eventLoop.assertInEventLoop()
 
+    guard !tunnelingOnly else {
+      let serverHandler = HTTPConnectRecipientHandler(
+        passwordReference: passwordReference,
+        authenticationRequired: authenticationRequired,
+        completion: completion
+      )
+      try self.addHandler(serverHandler, position: position)
+      return
+    }
+
     let responseEncoder = HTTPResponseEncoder()
     let requestDecoder = HTTPRequestDecoder(leftOverBytesStrategy: .forwardBytes)
     let serverHandler = HTTPProxyRecipientHandelr(
       passwordReference: passwordReference,
       authenticationRequired: authenticationRequired,
+      streaming: streaming,
+      connectionPool: connectionPool,
       completion: completion
     )
 
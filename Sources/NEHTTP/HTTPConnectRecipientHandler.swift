@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import HTTPTypes
+import NIOCore
+import NIOHTTP1
+
+/// A channel handler that accepts HTTP CONNECT tunnels without a HTTP codec.
+///
+/// This handler can be used in channels that are acting as the server in the HTTP proxy dialog
+/// when only tunnels need serving. It parses the request head from raw bytes and answers with a
+/// pre-encoded `200 Connection Established`, so no `HTTPRequestDecoder` or `HTTPResponseEncoder`
+/// has to be added and removed per tunnel. Requests with other methods are rejected with
+/// `405 Method Not Allowed`.
+final public class HTTPConnectRecipientHandler: ChannelInboundHandler, RemovableChannelHandler {
+  public typealias InboundIn = ByteBuffer
+  public typealias InboundOut = ByteBuffer
+  public typealias OutboundOut = ByteBuffer
+
+  private enum Progress: Equatable {
+    case waitingForRequest
+    case waitingForConnection
+    case completed
+    case failed
+  }
+
+  /// The maximum byte count of the request head.
+  static let maximumHeadLength = 8192
+
+  private static let connectionEstablishedHTTP1_1 = ByteBuffer(
+    string: "HTTP/1.1 200 Connection Established\r\n\r\n"
+  )
+
+  private static let connectionEstablishedHTTP1_0 = ByteBuffer(
+    string: "HTTP/1.0 200 Connection Established\r\n\r\n"
+  )
+
+  private var progress: Progress = .waitingForRequest
+
+  /// The version of the request, this value is updated after the request head parsed.
+  private var version: HTTPVersion = .http1_1
+
+  /// Bytes received before the tunnel established, this includes data sent after the request
+  /// head without waiting for the response.
+  private var cumulationBuffer: ByteBuffer?
+
+  /// The credentials used to authenticate this proxy connection.
+  private let passwordReference: String
+
+  /// A boolean value determines whether server should evaluate proxy authentication request.
+  private let authenticationRequired: Bool
+
+  /// The completion handler when proxy connection established.
+  private let completion: @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
+
+  /// Initialize an instance of `HTTPConnectRecipientHandler` with specified parameters.
+  ///
+  /// - Parameters:
+  ///   - passwordReference: Credentials for proxy authentication.
+  ///   - authenticationRequired: A boolean value determines whether server should evaluate proxy
+  ///     authentication request.
+  ///   - completion: The completion handler when proxy connection established, returns
+  ///     `EventLoopFuture<Void>` using given request info.
+  public init(
+    passwordReference: String,
+    authenticationRequired: Bool,
+    completion: @escaping @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
+  ) {
+    self.passwordReference = passwordReference
+    self.authenticationRequired = authenticationRequired
+    self.completion = completion
+  }
+
+  public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    switch progress {
+    case .completed:
+      context.fireChannelRead(data)
+      return
+    case .failed:
+      return
+    case .waitingForRequest, .waitingForConnection:
+      break
+    }
+
+    var buffer = unwrapInboundIn(data)
+    if cumulationBuffer == nil {
+      cumulationBuffer = buffer
+    } else {
+      cumulationBuffer!.writeBuffer(&buffer)
+    }
+
+    guard progress == .waitingForRequest else {
+      return
+    }
+
+    let request: HTTPRequest
+    do {
+      guard
+        let head = try cumulationBuffer?.readCONNECTRequestHead(
+          maximumLength: Self.maximumHeadLength
+        )
+      else {
+        return
+      }
+      version = head.0
+      request = head.1
+      try authenticate(connection: request)
+    } catch {
+      channelClose(context: context, reason: error)
+      return
+    }
+
+    progress = .waitingForConnection
+    setupHTTPTunnel(context: context, request: request)
+  }
+
+  public func channelReadComplete(context: ChannelHandlerContext) {
+    guard progress == .completed else {
+      return
+    }
+    context.fireChannelReadComplete()
+  }
+
+  private func authenticate(connection: HTTPRequest) throws {
+    guard authenticationRequired else {
+      return
+    }
+
+    guard !passwordReference.isEmpty else {
+      throw HTTPProxyError.unacceptableStatusCode(.proxyAuthenticationRequired)
+    }
+
+    if !connection.headerFields[values: .proxyAuthorization].contains(passwordReference) {
+      throw HTTPProxyError.unacceptableStatusCode(.proxyAuthenticationRequired)
+    }
+  }
+
+  private func setupHTTPTunnel(context: ChannelHandlerContext, request: HTTPRequest) {
+    completion(version, request).whenComplete {
+      switch $0 {
+      case .success:
+        let response =
+          self.version == .http1_0
+          ? Self.connectionEstablishedHTTP1_0 : Self.connectionEstablishedHTTP1_1
+        context.writeAndFlush(self.wrapOutboundOut(response), promise: nil)
+
+        self.progress = .completed
+
+        // Forward data that arrived after the request head to next handler in one read.
+        let byteBuffer = self.cumulationBuffer
+        self.cumulationBuffer = nil
+        if let byteBuffer, byteBuffer.readableBytes > 0 {
+          context.fireChannelRead(self.wrapInboundOut(byteBuffer))
+          context.fireChannelReadComplete()
+        }
+        context.pipeline.removeHandler(self, promise: nil)
+      case .failure(let error):
+        self.channelClose(context: context, reason: error)
+      }
+    }
+  }
+
+  private func channelClose(context: ChannelHandlerContext, reason: Error) {
+    progress = .failed
+    cumulationBuffer = nil
+
+    if case .unacceptableStatusCode(let status) = reason as? HTTPProxyError {
+      var buffer = context.channel.allocator.buffer(capacity: 64)
+      buffer.writeHTTPVersion(version)
+      buffer.writeWhitespace()
+      buffer.writeString(String(status.code))
+      buffer.writeWhitespace()
+      buffer.writeString(status.reasonPhrase)
+      buffer.writeStaticString(crlf)
+      buffer.writeStaticString("Content-Length: 0")
+      buffer.writeStaticString(crlf)
+      buffer.writeStaticString(crlf)
+      context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+    }
+
+    context.fireErrorCaught(reason)
+    context.close(promise: nil)
+  }
+}
+
+@available(*, unavailable)
+extension HTTPConnectRecipientHandler: Sendable {}
@@ -53,6 +53,15 @@ final public class HTTPProxyClientHandler: ChannelDuplexHandler, RemovableChanne
   /// All buffered write will unbuffered when proxy established.
   private var bufferedWrites: MarkedCircularBuffer<BufferedWrite>
 
+  /// The instrumentation to report handshake events to.
+  private let instrumentation: (any ProxyInstrumentation)?
+
+  /// The time the handshake began, set only when `instrumentation` is not `nil`.
+  private var handshakeStartTime: NIODeadline?
+
+  /// The largest number of writes buffered at once during the handshake.
+  private var bufferedWritesHighWaterMark = 0
+
   /// Initialize an instance of `HTTP1ClientCONNECTTunnelHandler` with specified parameters.
   ///
   /// - Parameters:
@@ -61,12 +70,16 @@ final public class HTTPProxyClientHandler: ChannelDuplexHandler, RemovableChanne
   ///   - preferHTTPTunneling: A boolean value determinse whether client should use HTTP CONNECT tunnel to proxy connection.
   ///   - destinationAddress: The destination for this proxy connection.
   ///   - timeoutInterval: A TimeAmount use to calculate deadline for handshaking timeout. The default timeout interval is 60 seconds.
+  ///   - instrumentation: The instrumentation to report handshake timings and buffered writes to.
+  ///     Payload bytes are not reported, the handler forwards writes without knowing their type
+  ///     and leaves the pipeline once the tunnel is established. Defaults to `nil`.
   public init(
     passwordReference: String,
     authenticationRequired: Bool,
     preferHTTPTunneling: Bool,
     destinationAddress: NWEndpoint,
-    timeoutInterval: TimeAmount = .seconds(60)
+    timeoutInterval: TimeAmount = .seconds(60),
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) {
     self.passwordReference = passwordReference
     self.authenticationRequired = authenticationRequired
@@ -74,6 +87,7 @@ final public class HTTPProxyClientHandler: ChannelDuplexHandler, RemovableChanne
     self.destinationAddress = destinationAddress
     self.bufferedWrites = .init(initialCapacity: 6)
     self.timeoutInterval = timeoutInterval
+    self.instrumentation = instrumentation
   }
 
   public func handlerAdded(context: ChannelHandlerContext) {
@@ -101,6 +115,9 @@ final public class HTTPProxyClientHandler: ChannelDuplexHandler, RemovableChanne
     switch (unwrapInboundIn(data), progress) {
     case (.head(let head), .waitingForComplete):
       if !(200..<300).contains(head.status.code) {
+        if head.status == .proxyAuthenticationRequired {
+          instrumentation?.authenticationDidFail(component: .httpProxyClient)
+        }
         scheduled?.cancel()
         channelClose(
           context: context,
@@ -123,6 +140,7 @@ final public class HTTPProxyClientHandler: ChannelDuplexHandler, RemovableChanne
     promise: EventLoopPromise<Void>?
   ) {
     bufferedWrites.append((data, promise))
+    bufferedWritesHighWaterMark = max(bufferedWritesHighWaterMark, bufferedWrites.count)
   }
 
   public func flush(context: ChannelHandlerContext) {
@@ -141,6 +159,14 @@ extension HTTPProxyClientHandler {
   private typealias BufferedWrite = (data: NIOAny, promise: EventLoopPromise<Void>?)
 
   private func unbufferWrites(context: ChannelHandlerContext) {
+    if let instrumentation, bufferedWritesHighWaterMark > 0 {
+      instrumentation.bufferedWritesHighWaterMark(
+        bufferedWritesHighWaterMark,
+        component: .httpProxyClient
+      )
+      bufferedWritesHighWaterMark = 0
+    }
+
     while bufferedWrites.hasMark {
       let bufferedWrite = bufferedWrites.removeFirst()
       context.write(bufferedWrite.data, promise: bufferedWrite.promise)
@@ -176,6 +202,9 @@ extension HTTPProxyClientHandler {
     }
 
     progress = .waitingForComplete
+    if instrumentation != nil {
+      handshakeStartTime = .now()
+    }
 
     let uri: String
     switch destinationAddress {
@@ -231,6 +260,17 @@ extension HTTPProxyClientHandler {
       }
       .flatMap {
         self.progress = .completed
+        if let instrumentation = self.instrumentation,
+          let handshakeStartTime = self.handshakeStartTime
+        {
+          let duration = NIODeadline.now() - handshakeStartTime
+          instrumentation.handshakeStageDidComplete(
+            .connect,
+            component: .httpProxyClient,
+            duration: duration
+          )
+          instrumentation.handshakeDidComplete(component: .httpProxyClient, duration: duration)
+        }
         self.unbufferWrites(context: context)
         self.scheduled?.cancel()
         return context.pipeline.removeHandler(self)
@@ -241,10 +281,17 @@ extension HTTPProxyClientHandler {
   }
 
   private func channelClose(context: ChannelHandlerContext, reason: Error) {
+    instrumentation?.handshakeDidFail(component: .httpProxyClient, error: reason)
     context.fireErrorCaught(reason)
     context.close(promise: nil)
   }
 }
 
+extension ProxyComponent {
+
+  /// A `HTTPProxyClientHandler`.
+  public static let httpProxyClient = ProxyComponent(rawValue: "http-proxy-client")
+}
+
 @available(*, unavailable)
 extension HTTPProxyClientHandler: Sendable {}
@@ -45,6 +45,9 @@ final public class HTTPProxyRecipientHandelr: ChannelInboundHandler, RemovableCh
   /// A boolean value deterinse whether server should evaluate proxy authentication request.
   private let authenticationRequired: Bool
 
+  /// A boolean value determines whether plain HTTP requests are re-encoded in streaming mode.
+  private let streaming: Bool
+
   /// When a proxy request is received, we will send a new request to the target server.
   /// During the request is established, we need to buffer events.
   private var eventBuffer: CircularBuffer<EventBuffer> = .init(initialCapacity: 2)
@@ -52,24 +55,95 @@ final public class HTTPProxyRecipientHandelr: ChannelInboundHandler, RemovableCh
   /// The completion handler when proxy connection established.
   private let completion: @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
 
+  /// The pool plain HTTP requests are forwarded over, nil to hand them to `completion` instead.
+  private let connectionPool: HTTPUpstreamConnectionPool?
+
+  /// A plain HTTP request forwarded over a connection leased from `connectionPool`.
+  private struct PooledExchange {
+    var key: HTTPUpstreamConnectionPool.Key
+    /// The leased connection and the handler writing to it, nil while leasing.
+    var upstream: (channel: Channel, handler: HTTPUpstreamExchangeHandler)?
+    var isRequestKeepAlive: Bool
+    var isResponseKeepAlive = false
+    var isRequestComplete = false
+    var isResponseComplete = false
+  }
+
+  private var exchange: PooledExchange?
+
+  /// Request parts read in pooled mode and not written to an upstream yet.
+  private var pendingRequestParts: CircularBuffer<HTTPServerRequestPart> = .init()
+
+  private var context: ChannelHandlerContext?
+
   /// Initialize an instance of `HTTPProxyRecipientHandelr` with specified parameters.
   ///
   /// - Parameters:
   ///   - username: Username for proxy authentication.
   ///   - passwordReference: Credentials for proxy authentication.
   ///   - authenticationRequired: A boolean value deterinse whether server should evaluate proxy authentication request.
+  ///   - streaming: A boolean value determines whether plain HTTP requests are re-encoded with a
+  ///     streaming `PlainHTTPRequestEncoder`, which strips hop-by-hop fields from every pipelined
+  ///     request on a keep-alive connection. Defaults to `false`.
+  ///   - connectionPool: The pool plain HTTP requests are forwarded over. Each request leases a
+  ///     connection to its origin, which is released to the pool after a keep-alive response, and
+  ///     the handler stays in the pipeline for the next request. `completion` is then called for
+  ///     CONNECT requests only. The pool must be bound to the event loop of the channel and make
+  ///     connections that read and write HTTP client parts. Defaults to `nil`.
   ///   - completion: The completion handler when proxy connection established, returns `EventLoopFuture<Void>` using given request info.
   public init(
     passwordReference: String,
     authenticationRequired: Bool,
+    streaming: Bool = false,
+    connectionPool: HTTPUpstreamConnectionPool? = nil,
     completion: @escaping @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
   ) {
     self.passwordReference = passwordReference
     self.authenticationRequired = authenticationRequired
+    self.streaming = streaming
+    self.connectionPool = connectionPool
     self.completion = completion
   }
 
+  public func handlerAdded(context: ChannelHandlerContext) {
+    connectionPool?.eventLoop.preconditionInEventLoop()
+    self.context = context
+  }
+
+  public func handlerRemoved(context: ChannelHandlerContext) {
+    self.context = nil
+  }
+
   public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    guard connectionPool == nil || progress != .waitingForData else {
+      pendingRequestParts.append(unwrapInboundIn(data))
+      forwardPendingRequestParts(context: context)
+      return
+    }
+    channelReadHandingOver(context: context, data: data)
+  }
+
+  public func channelReadComplete(context: ChannelHandlerContext) {
+    guard connectionPool == nil || progress != .waitingForData else {
+      exchange?.upstream?.handler.flush()
+      return
+    }
+    eventBuffer.append(.channelReadComplete)
+  }
+
+  public func channelInactive(context: ChannelHandlerContext) {
+    if let upstream = exchange?.upstream {
+      // The response is incomplete, so the connection cannot be reused.
+      upstream.handler.detach()
+      upstream.channel.close(promise: nil)
+    }
+    exchange = nil
+    pendingRequestParts.removeAll()
+    context.fireChannelInactive()
+  }
+
+  /// Handle a request part for handing the connection over to `completion`.
+  private func channelReadHandingOver(context: ChannelHandlerContext, data: NIOAny) {
     guard progress == .waitingForData else {
       guard progress == .waitingForComplete else {
         context.fireChannelRead(data)
@@ -102,10 +176,6 @@ final public class HTTPProxyRecipientHandelr: ChannelInboundHandler, RemovableCh
     }
   }
 
-  public func channelReadComplete(context: ChannelHandlerContext) {
-    eventBuffer.append(.channelReadComplete)
-  }
-
   private func flushBuffers(context: ChannelHandlerContext) {
     // We're being removed from the pipeline. If we have buffered events, deliver them.
     while !eventBuffer.isEmpty {
@@ -158,7 +228,7 @@ final public class HTTPProxyRecipientHandelr: ChannelInboundHandler, RemovableCh
         .cascade(to: promise)
     } else {
       // For plain http proxy we need re-encode request to byte buffer.
-      context.pipeline.addHandler(PlainHTTPRequestEncoder())
+      context.pipeline.addHandler(PlainHTTPRequestEncoder(streaming: streaming))
         .cascade(to: promise)
     }
 
@@ -236,5 +306,159 @@ final public class HTTPProxyRecipientHandelr: ChannelInboundHandler, RemovableCh
   }
 }
 
+extension HTTPProxyRecipientHandelr {
+
+  /// Write pending request parts to the upstream of the current exchange, starting the exchange
+  /// of the next request once the current one is complete.
+  private func forwardPendingRequestParts(context: ChannelHandlerContext) {
+    while progress == .waitingForData, let part = pendingRequestParts.first {
+      guard let exchange else {
+        guard case .head(let head) = part, head.method != .CONNECT else {
+          // CONNECT tunnels are handed over to `completion` as without a pool, which also
+          // rejects requests that do not start with a head.
+          pendingRequestParts.removeFirst()
+          channelReadHandingOver(context: context, data: wrapInboundOut(part))
+          continue
+        }
+        guard beginExchange(context: context, head: head) else {
+          return
+        }
+        continue
+      }
+
+      guard let upstream = exchange.upstream, !exchange.isRequestComplete else {
+        return
+      }
+      pendingRequestParts.removeFirst()
+      upstream.handler.write(part)
+      if case .end = part {
+        self.exchange?.isRequestComplete = true
+        upstream.handler.flush()
+        finishExchangeIfComplete(context: context)
+      }
+    }
+
+    // The rest of the parts follow a CONNECT request, buffer them until the tunnel is set up.
+    while progress != .waitingForData, let part = pendingRequestParts.popFirst() {
+      channelReadHandingOver(context: context, data: wrapInboundOut(part))
+    }
+  }
+
+  /// Start the exchange of the request `head` at the front of the pending parts and lease a
+  /// connection to its origin, returns false if the request is rejected.
+  private func beginExchange(context: ChannelHandlerContext, head: HTTPRequestHead) -> Bool {
+    guard let connectionPool else {
+      preconditionFailure("Pooled exchanges need a connection pool.")
+    }
+
+    originalHTTPRequest = head
+    guard let request = try? HTTPRequest(head), let key = HTTPUpstreamConnectionPool.Key(request)
+    else {
+      pendingRequestParts.removeAll()
+      channelClose(context: context, reason: HTTPProxyError.invalidHTTPOrdering)
+      return false
+    }
+    do {
+      try authenticate(connection: request)
+    } catch {
+      pendingRequestParts.removeAll()
+      channelClose(context: context, reason: error)
+      return false
+    }
+
+    var forwardedHead = head
+    forwardedHead.headers.trimmingHopByHopFields()
+    pendingRequestParts[pendingRequestParts.startIndex] = .head(forwardedHead)
+    exchange = PooledExchange(key: key, isRequestKeepAlive: head.isKeepAlive)
+
+    connectionPool.leaseConnection(to: key).whenComplete { result in
+      switch result {
+      case .success(let channel):
+        guard self.context != nil, self.exchange != nil else {
+          // The client went away while leasing.
+          connectionPool.releaseConnection(channel, to: key)
+          return
+        }
+        let handler = HTTPUpstreamExchangeHandler(recipient: self)
+        do {
+          try channel.pipeline.syncOperations.addHandler(handler)
+        } catch {
+          channel.close(promise: nil)
+          self.channelClose(context: context, reason: error)
+          return
+        }
+        self.exchange?.upstream = (channel, handler)
+        self.forwardPendingRequestParts(context: context)
+      case .failure(let error):
+        guard self.context != nil else {
+          return
+        }
+        self.channelClose(context: context, reason: error)
+      }
+    }
+    return true
+  }
+
+  /// End the current exchange once both its request and its response are complete, releasing
+  /// the connection to the pool if the response keeps it alive.
+  private func finishExchangeIfComplete(context: ChannelHandlerContext) {
+    guard let exchange, exchange.isRequestComplete, exchange.isResponseComplete,
+      let connectionPool, let upstream = exchange.upstream
+    else {
+      return
+    }
+    self.exchange = nil
+
+    upstream.handler.detach()
+    let key = exchange.key
+    let isReusable = exchange.isResponseKeepAlive
+    upstream.channel.pipeline.removeHandler(upstream.handler).whenComplete { _ in
+      if isReusable {
+        connectionPool.releaseConnection(upstream.channel, to: key)
+      } else {
+        upstream.channel.close(promise: nil)
+      }
+    }
+
+    guard exchange.isRequestKeepAlive else {
+      pendingRequestParts.removeAll()
+      context.close(promise: nil)
+      return
+    }
+    forwardPendingRequestParts(context: context)
+  }
+
+  /// Relay a response part read from the upstream of the current exchange to the client.
+  func upstreamDidRead(_ part: HTTPClientResponsePart) {
+    guard let context, exchange != nil else {
+      return
+    }
+
+    switch part {
+    case .head(var head):
+      exchange?.isResponseKeepAlive = head.isKeepAlive
+      head.headers.trimmingHopByHopFields()
+      context.write(wrapOutboundOut(.head(head)), promise: nil)
+    case .body(let body):
+      context.write(wrapOutboundOut(.body(.byteBuffer(body))), promise: nil)
+    case .end(let trailers):
+      context.writeAndFlush(wrapOutboundOut(.end(trailers)), promise: nil)
+      exchange?.isResponseComplete = true
+      finishExchangeIfComplete(context: context)
+    }
+  }
+
+  /// Close the client when the upstream of the current exchange closes before its response is
+  /// complete.
+  func upstreamDidClose() {
+    guard let context, let exchange, !exchange.isResponseComplete else {
+      return
+    }
+    self.exchange = nil
+    pendingRequestParts.removeAll()
+    context.close(promise: nil)
+  }
+}
+
 @available(*, unavailable)
 extension HTTPProxyRecipientHandelr: Sendable {}
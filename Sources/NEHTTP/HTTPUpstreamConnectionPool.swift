@@ -0,0 +1,209 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import HTTPTypes
+import NIOCore
+
+/// A pool of idle upstream connections that plain HTTP proxying can reuse across requests.
+///
+/// Connections are keyed by host, port and whether they use TLS. A connection released after a
+/// complete response is kept idle for `idleTimeout` and handed out again by the next lease of
+/// the same key, so requests to a warm origin skip the TCP and TLS handshakes. At most
+/// `maximumIdleConnectionsPerKey` connections are kept per key, others are closed on release.
+///
+/// A pool is bound to one event loop, create one per event loop and make connections on it so
+/// that leasing never crosses threads. Calls from other threads hop to the event loop.
+final public class HTTPUpstreamConnectionPool: @unchecked Sendable {
+
+  /// The identity of interchangeable upstream connections.
+  public struct Key: Hashable, Sendable {
+
+    /// The host name or address literal of the upstream.
+    public var host: String
+
+    /// The port of the upstream.
+    public var port: Int
+
+    /// A boolean value determines whether connections to the upstream use TLS.
+    public var usesTLS: Bool
+
+    /// Initialize an instance of `Key` with specified parameters.
+    public init(host: String, port: Int, usesTLS: Bool) {
+      self.host = host
+      self.port = port
+      self.usesTLS = usesTLS
+    }
+
+    /// Initialize an instance of `Key` for the origin of `request`.
+    ///
+    /// The port defaults to the one of the scheme, returns nil if `request` has no authority.
+    public init?(_ request: HTTPRequest) {
+      guard let authority = request.authority, !authority.isEmpty else {
+        return nil
+      }
+      let usesTLS = request.scheme?.lowercased() == "https"
+      var host = Substring(authority)
+      var port = usesTLS ? 443 : 80
+      if let separator = authority.lastIndex(of: ":"), !authority[separator...].contains("]"),
+        let explicitPort = Int(authority[authority.index(after: separator)...])
+      {
+        host = authority[..<separator]
+        port = explicitPort
+      }
+      if host.hasPrefix("[") && host.hasSuffix("]") {
+        host = host.dropFirst().dropLast()
+      }
+      self.init(host: String(host), port: port, usesTLS: usesTLS)
+    }
+  }
+
+  private struct IdleConnection {
+    var channel: Channel
+    var timeout: Scheduled<Void>
+  }
+
+  /// The event loop the state of this pool is confined to.
+  public let eventLoop: EventLoop
+
+  private let idleTimeout: TimeAmount
+
+  private let maximumIdleConnectionsPerKey: Int
+
+  private let connectionFactory: @Sendable (Key, EventLoop) -> EventLoopFuture<Channel>
+
+  private var idleConnections: [Key: [IdleConnection]] = [:]
+
+  /// Channels whose close is already observed, so that a connection that is reused many times
+  /// registers one close callback only.
+  private var observedChannels: Set<ObjectIdentifier> = []
+
+  private var isClosed = false
+
+  /// Initialize an instance of `HTTPUpstreamConnectionPool` with specified parameters.
+  ///
+  /// - Parameters:
+  ///   - eventLoop: The event loop the pool is bound to.
+  ///   - idleTimeout: The time amount an idle connection is kept before it is closed. Defaults
+  ///     to 60 seconds.
+  ///   - maximumIdleConnectionsPerKey: The maximum number of idle connections kept per key.
+  ///     Defaults to 8.
+  ///   - connectionFactory: The factory making new connections, it is given the key and the
+  ///     event loop of the pool and returns a connected channel ready for sending requests.
+  public init(
+    eventLoop: EventLoop,
+    idleTimeout: TimeAmount = .seconds(60),
+    maximumIdleConnectionsPerKey: Int = 8,
+    connectionFactory: @escaping @Sendable (Key, EventLoop) -> EventLoopFuture<Channel>
+  ) {
+    self.eventLoop = eventLoop
+    self.idleTimeout = idleTimeout
+    self.maximumIdleConnectionsPerKey = maximumIdleConnectionsPerKey
+    self.connectionFactory = connectionFactory
+  }
+
+  /// Lease a connection to `key`.
+  ///
+  /// An active idle connection is reused if there is one, otherwise a new connection is made by
+  /// the connection factory. The connection belongs to the caller until it is released.
+  ///
+  /// - Parameter key: The upstream of the connection.
+  /// - Returns: An `EventLoopFuture` that will fire with the connection.
+  public func leaseConnection(to key: Key) -> EventLoopFuture<Channel> {
+    guard eventLoop.inEventLoop else {
+      return eventLoop.flatSubmit {
+        self.leaseConnection(to: key)
+      }
+    }
+
+    while let connection = idleConnections[key]?.popLast() {
+      connection.timeout.cancel()
+      if idleConnections[key]?.isEmpty == true {
+        idleConnections[key] = nil
+      }
+      if connection.channel.isActive {
+        return eventLoop.makeSucceededFuture(connection.channel)
+      }
+    }
+    return connectionFactory(key, eventLoop)
+  }
+
+  /// Return a leased connection to the pool.
+  ///
+  /// Release a connection only after the response of its last request is complete and the
+  /// connection is left reusable. It is closed instead if it is inactive, the pool is closed or
+  /// `key` has `maximumIdleConnectionsPerKey` idle connections already.
+  ///
+  /// - Parameters:
+  ///   - channel: The connection to release.
+  ///   - key: The key the connection is leased with.
+  public func releaseConnection(_ channel: Channel, to key: Key) {
+    guard eventLoop.inEventLoop else {
+      eventLoop.execute {
+        self.releaseConnection(channel, to: key)
+      }
+      return
+    }
+
+    guard !isClosed, channel.isActive,
+      idleConnections[key, default: []].count < maximumIdleConnectionsPerKey
+    else {
+      channel.close(promise: nil)
+      return
+    }
+
+    let timeout = eventLoop.scheduleTask(in: idleTimeout) {
+      self.removeIdleConnection(channel, to: key)
+      channel.close(promise: nil)
+    }
+    idleConnections[key, default: []].append(.init(channel: channel, timeout: timeout))
+
+    // Upstream servers may close idle connections at any time.
+    if observedChannels.insert(ObjectIdentifier(channel)).inserted {
+      channel.closeFuture.whenComplete { _ in
+        self.eventLoop.execute {
+          self.observedChannels.remove(ObjectIdentifier(channel))
+          self.removeIdleConnection(channel, to: key)
+        }
+      }
+    }
+  }
+
+  /// Close all idle connections, connections released afterwards are closed instead of pooled.
+  public func close() {
+    guard eventLoop.inEventLoop else {
+      eventLoop.execute {
+        self.close()
+      }
+      return
+    }
+
+    isClosed = true
+    let connections = idleConnections.values.joined()
+    idleConnections = [:]
+    for connection in connections {
+      connection.timeout.cancel()
+      connection.channel.close(promise: nil)
+    }
+  }
+
+  private func removeIdleConnection(_ channel: Channel, to key: Key) {
+    guard let index = idleConnections[key]?.firstIndex(where: { $0.channel === channel }) else {
+      return
+    }
+    idleConnections[key]?.remove(at: index).timeout.cancel()
+    if idleConnections[key]?.isEmpty == true {
+      idleConnections[key] = nil
+    }
+  }
+}
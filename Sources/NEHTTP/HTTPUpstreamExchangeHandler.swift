@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOHTTP1
+
+/// A channel handler that carries one plain HTTP request of a `HTTPProxyRecipientHandelr` over a
+/// connection leased from a `HTTPUpstreamConnectionPool`.
+///
+/// It is added to the leased connection for one request and response only, and removed before
+/// the connection is released to the pool.
+final class HTTPUpstreamExchangeHandler: ChannelInboundHandler, RemovableChannelHandler {
+
+  typealias InboundIn = HTTPClientResponsePart
+
+  typealias OutboundOut = HTTPClientRequestPart
+
+  private var recipient: HTTPProxyRecipientHandelr?
+
+  private var context: ChannelHandlerContext?
+
+  init(recipient: HTTPProxyRecipientHandelr) {
+    self.recipient = recipient
+  }
+
+  func handlerAdded(context: ChannelHandlerContext) {
+    self.context = context
+  }
+
+  func handlerRemoved(context: ChannelHandlerContext) {
+    self.recipient = nil
+    self.context = nil
+  }
+
+  /// Write a request part to the upstream, without flushing.
+  func write(_ part: HTTPServerRequestPart) {
+    switch part {
+    case .head(let head):
+      context?.write(wrapOutboundOut(.head(head)), promise: nil)
+    case .body(let body):
+      context?.write(wrapOutboundOut(.body(.byteBuffer(body))), promise: nil)
+    case .end(let trailers):
+      context?.write(wrapOutboundOut(.end(trailers)), promise: nil)
+    }
+  }
+
+  /// Flush the request parts written to the upstream.
+  func flush() {
+    context?.flush()
+  }
+
+  /// Stop reporting the upstream to the recipient.
+  func detach() {
+    recipient = nil
+  }
+
+  func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    recipient?.upstreamDidRead(unwrapInboundIn(data))
+  }
+
+  func channelInactive(context: ChannelHandlerContext) {
+    recipient?.upstreamDidClose()
+    recipient = nil
+    context.fireChannelInactive()
+  }
+
+  func errorCaught(context: ChannelHandlerContext, error: Error) {
+    context.close(promise: nil)
+  }
+}
+
+@available(*, unavailable)
+extension HTTPUpstreamExchangeHandler: Sendable {}
@@ -20,94 +20,157 @@ protocol HashFunctionImplementationDetails: HashFunction where Digest: DigestPri
 struct DigestImpl<H: HashFunctionImplementationDetails> {
   private var context: DigestContext
 
-  init() {
-    self.context = DigestContext()
+  init(finalizesOnEveryUpdate: Bool = false) {
+    self.context = DigestContext(finalizesOnEveryUpdate: finalizesOnEveryUpdate)
   }
 
   internal mutating func update(data: UnsafeRawBufferPointer) {
-    if !isKnownUniquelyReferenced(&self.context) {
-      self.context = DigestContext(copying: self.context)
-    }
     self.context.update(data: data)
   }
 
   internal func finalize() -> H.Digest {
-    // To have a non-destructive finalize operation we must allocate.
-    let copyContext = DigestContext(copying: self.context)
-    let digestBytes = copyContext.finalize()
-    return digestBytes.withUnsafeBytes {
-      // We force unwrap here because if the digest size is wrong it's an internal error.
-      H.Digest(bufferPointer: $0)!
-    }
+    // The context is a value, finalizing a copy leaves `self` able to absorb more input.
+    var copyContext = self.context
+    return copyContext.read(digestSize: H.byteCount)
   }
 
-  internal func read(digestSize: Int) -> H.Digest {
-    // To have a non-destructive finalize operation we must allocate.
-    let copyContext = self.context
-    let digestBytes = copyContext.read(digestSize: digestSize)
-    return digestBytes.withUnsafeBytes {
-      // We force unwrap here because if the digest size is wrong it's an internal error.
-      H.Digest(bufferPointer: $0)!
+  internal consuming func finalize(digestSize: Int) -> H.Digest {
+    self.context.read(digestSize: digestSize)
+  }
+
+  internal mutating func read(into buffer: UnsafeMutableRawBufferPointer) {
+    self.context.read(into: buffer)
+  }
+
+  /// A copy of the underlying sponge state, padded and ready to squeeze.
+  internal var state: sha3_ctx_t {
+    self.context.state
+  }
+
+  internal mutating func read(digestSize: Int) -> H.Digest {
+    self.context.read(digestSize: digestSize)
+  }
+}
+
+/// The SHAKE128 sponge, stored inline.
+///
+/// `Sponge` mirrors the layout of `sha3_ctx_t` so the C functions can work on it in place, without
+/// the heap allocation a class wrapping a `sha3_ctx_t` pointer would need. It is spelled out with
+/// Swift types rather than storing a `sha3_ctx_t` because `CNESHAKE128` is an implementation-only
+/// import and must not leak into the layout of `SHAKE128`.
+private struct Sponge {
+  var lanes: (
+    UInt64, UInt64, UInt64, UInt64, UInt64,
+    UInt64, UInt64, UInt64, UInt64, UInt64,
+    UInt64, UInt64, UInt64, UInt64, UInt64,
+    UInt64, UInt64, UInt64, UInt64, UInt64,
+    UInt64, UInt64, UInt64, UInt64, UInt64
+  ) = (
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0
+  )
+  var pt: Int32 = 0
+  var rsiz: Int32 = 0
+  var mdlen: Int32 = 0
+
+  /// The tail padding C adds after `mdlen` to round `sha3_ctx_t` up to the alignment of its lanes,
+  /// spelled out so `Sponge` is exactly as large as the struct it is rebound to.
+  private var tailPadding: Int32 = 0
+
+  mutating func withUnsafeMutableContext<R>(
+    _ body: (UnsafeMutablePointer<sha3_ctx_t>) throws -> R
+  ) rethrows -> R {
+    // The layouts are compile time constants, so these fold away in optimized builds.
+    precondition(MemoryLayout<Sponge>.size == MemoryLayout<sha3_ctx_t>.size)
+    precondition(MemoryLayout<Sponge>.alignment == MemoryLayout<sha3_ctx_t>.alignment)
+    precondition(
+      MemoryLayout<Sponge>.offset(of: \.pt) == MemoryLayout<sha3_ctx_t>.offset(of: \.pt)
+    )
+    precondition(
+      MemoryLayout<Sponge>.offset(of: \.rsiz) == MemoryLayout<sha3_ctx_t>.offset(of: \.rsiz)
+    )
+    precondition(
+      MemoryLayout<Sponge>.offset(of: \.mdlen) == MemoryLayout<sha3_ctx_t>.offset(of: \.mdlen)
+    )
+    return try withUnsafeMutablePointer(to: &self) {
+      try UnsafeMutableRawPointer($0).withMemoryRebound(to: sha3_ctx_t.self, capacity: 1, body)
     }
   }
 }
 
-class DigestContext {
+struct DigestContext {
 
-  private var contextPointer: UnsafeMutablePointer<sha3_ctx_t>
+  private var sponge = Sponge()
 
-  init() {
-    // We force unwrap because we cannot recover from allocation failure.
-    self.contextPointer = UnsafeMutablePointer<sha3_ctx_t>.allocate(
-      capacity: MemoryLayout<sha3_ctx_t>.size
-    )
-    self.contextPointer.initialize(to: .init())
+  /// Whether every update pads and permutes the sponge, instead of the first read doing it once.
+  private let finalizesOnEveryUpdate: Bool
 
-    CSHAKE128_shake128_init(self.contextPointer)
+  /// Whether the input has been padded and output may be squeezed.
+  private var isSqueezing = false
+
+  init(finalizesOnEveryUpdate: Bool) {
+    self.finalizesOnEveryUpdate = finalizesOnEveryUpdate
+    self.sponge.withUnsafeMutableContext {
+      _ = CSHAKE128_shake128_init($0)
+    }
   }
 
-  init(copying original: DigestContext) {
-    // We force unwrap because we cannot recover from allocation failure.
-    self.contextPointer = UnsafeMutablePointer<sha3_ctx_t>.allocate(
-      capacity: MemoryLayout<sha3_ctx_t>.size
-    )
-    self.contextPointer.initialize(to: original.contextPointer.pointee)
+  var state: sha3_ctx_t {
+    var copySponge = self.sponge
+    return copySponge.withUnsafeMutableContext {
+      if !self.finalizesOnEveryUpdate && !self.isSqueezing {
+        CSHAKE128_shake_xof($0)
+      }
+      return $0.pointee
+    }
   }
 
-  func update(data: UnsafeRawBufferPointer) {
+  mutating func update(data: UnsafeRawBufferPointer) {
     guard let baseAddress = data.baseAddress else {
       return
     }
-    CSHAKE128_shake_update(self.contextPointer, baseAddress, data.count)
-    CSHAKE128_shake_xof(self.contextPointer)
+    guard self.finalizesOnEveryUpdate else {
+      precondition(!self.isSqueezing, "SHAKE128 cannot absorb more input once output has been read")
+      self.sponge.withUnsafeMutableContext {
+        _ = CSHAKE128_shake_update($0, baseAddress, data.count)
+      }
+      return
+    }
+    self.sponge.withUnsafeMutableContext {
+      _ = CSHAKE128_shake_update($0, baseAddress, data.count)
+      CSHAKE128_shake_xof($0)
+    }
   }
 
-  func read(digestSize: Int) -> [UInt8] {
-    var digestBytes = Array(repeating: UInt8(0), count: Int(digestSize))
-
-    digestBytes.withUnsafeMutableBytes { digestPointer in
-      assert(digestPointer.count == digestSize)
-      CSHAKE128_shake_read(self.contextPointer, digestPointer.baseAddress, digestSize)
+  private mutating func beginSqueezingIfNeeded() {
+    guard !self.finalizesOnEveryUpdate && !self.isSqueezing else {
+      return
     }
-
-    return digestBytes
+    self.sponge.withUnsafeMutableContext {
+      CSHAKE128_shake_xof($0)
+    }
+    self.isSqueezing = true
   }
 
-  // This finalize function is _destructive_: do not call it if you want to reuse the object!
-  func finalize() -> [UInt8] {
-    let digestSize = 16
-    var digestBytes = Array(repeating: UInt8(0), count: Int(digestSize))
-
-    digestBytes.withUnsafeMutableBytes { digestPointer in
-      assert(digestPointer.count == digestSize)
-      CSHAKE128_shake_read(self.contextPointer, digestPointer.baseAddress, digestSize)
+  mutating func read<D: DigestPrivate>(digestSize: Int) -> D {
+    self.beginSqueezingIfNeeded()
+    return withUnsafeTemporaryAllocation(byteCount: digestSize, alignment: 1) { digestPointer in
+      self.read(into: digestPointer)
+      // We force unwrap here because if the digest size is wrong it's an internal error.
+      return D(bufferPointer: UnsafeRawBufferPointer(digestPointer))!
     }
-
-    return digestBytes
   }
 
-  deinit {
-    self.contextPointer.deinitialize(count: MemoryLayout<sha3_ctx_t>.size)
-    self.contextPointer.deallocate()
+  mutating func read(into buffer: UnsafeMutableRawBufferPointer) {
+    guard let baseAddress = buffer.baseAddress else {
+      return
+    }
+    self.beginSqueezingIfNeeded()
+    self.sponge.withUnsafeMutableContext {
+      CSHAKE128_shake_read($0, baseAddress, buffer.count)
+    }
   }
 }
@@ -26,11 +26,34 @@ public struct SHAKE128: HashFunctionImplementationDetails {
     return 16
   }
 
+  /// The way updates are absorbed into the sponge.
+  public enum AbsorbMode: Hashable, Sendable {
+
+    /// All updates are absorbed as one message, which is padded once when output is first read.
+    ///
+    /// This is SHAKE128 of the concatenated input, output can be squeezed without limit but no
+    /// input may be added once output has been read.
+    case incremental
+
+    /// Every update pads and permutes the sponge, as earlier versions of this type did.
+    ///
+    /// Output only differs from `incremental` when input is fed in more than one update, keep
+    /// this for peers that hashed multi-part messages that way.
+    case finalizeOnEveryUpdate
+  }
+
   var impl: DigestImpl<SHAKE128>
 
   /// Initializes the hash function instance.
   public init() {
-    impl = DigestImpl()
+    self.init(absorbMode: .incremental)
+  }
+
+  /// Initializes the hash function instance with the given absorb mode.
+  ///
+  /// - Parameter absorbMode: The way updates are absorbed into the sponge.
+  public init(absorbMode: AbsorbMode) {
+    impl = DigestImpl(finalizesOnEveryUpdate: absorbMode == .finalizeOnEveryUpdate)
   }
 
   // Once https://github.com/apple/swift-evolution/pull/910 is landed,
@@ -40,14 +63,34 @@ public struct SHAKE128: HashFunctionImplementationDetails {
     impl.update(data: bufferPointer)
   }
 
-  public func read(digestSize: Int) -> Self.Digest {
+  /// Squeezes the next `digestSize` bytes of output.
+  ///
+  /// - Parameter digestSize: The number of bytes to read.
+  /// - Returns: The next bytes of the output stream.
+  public mutating func read(digestSize: Int) -> Self.Digest {
     return impl.read(digestSize: digestSize)
   }
 
+  /// Squeezes `buffer.count` bytes of output into `buffer` without allocating.
+  ///
+  /// - Parameter buffer: The buffer to fill with the next bytes of the output stream.
+  public mutating func read(into buffer: UnsafeMutableRawBufferPointer) {
+    impl.read(into: buffer)
+  }
+
   /// Returns the digest from the data input in the hash function instance.
   ///
   /// - Returns: The digest of the inputted data
   public func finalize() -> Self.Digest {
     return impl.finalize()
   }
+
+  /// Returns the first `digestSize` bytes of output, consuming the hash function instance.
+  ///
+  /// Unlike `finalize()` this pads the sponge in place instead of in a copy.
+  /// - Parameter digestSize: The number of bytes to read.
+  /// - Returns: The digest from the data input in the hash function instance.
+  public consuming func finalize(digestSize: Int) -> Self.Digest {
+    return impl.finalize(digestSize: digestSize)
+  }
 }
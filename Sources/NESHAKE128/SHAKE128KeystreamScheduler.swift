@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+@_implementationOnly import CNESHAKE128
+
+/// A scheduler that squeezes the SHAKE128 keystreams of many connections together.
+///
+/// Every registered stream buffers up to two rate blocks of output. When a read finds its stream
+/// empty, the scheduler refills every stream that has room for another block in one batch, using
+/// the multi-buffer permutations, so streams advancing at similar rates share permutations.
+///
+/// The scheduler is not thread-safe, use one per `EventLoop`.
+public final class SHAKE128KeystreamScheduler {
+
+  /// A handle to a stream registered with a scheduler.
+  public struct Stream: Hashable, Sendable {
+    fileprivate let index: Int
+  }
+
+  private struct Slot {
+    var isRegistered = false
+    var readerIndex = 0
+    var readableBytes = 0
+    var writerIndex = 0
+  }
+
+  private static let blockByteCount = SHAKE128.blockByteCount
+  private static let bufferByteCount = 2 * SHAKE128.blockByteCount
+
+  private var slots: [Slot] = []
+  private var freeList: [Int] = []
+
+  // `capacity` sponge states and keystream buffers, laid out contiguously.
+  private var capacity = 0
+  private var states: UnsafeMutableRawPointer?
+  private var buffers: UnsafeMutableRawPointer?
+
+  // Reused between refills so a refill does not allocate.
+  private var statePointers: [UnsafeMutableRawPointer?] = []
+  private var outputPointers: [UnsafeMutablePointer<UInt8>?] = []
+
+  /// Creates a new scheduler.
+  public init() {}
+
+  deinit {
+    states?.deallocate()
+    buffers?.deallocate()
+  }
+
+  /// Registers the output stream of `hasher`.
+  ///
+  /// The stream continues from the current position of `hasher`, reading from it does not advance
+  /// `hasher` itself.
+  /// - Parameter hasher: The hash function to squeeze.
+  /// - Returns: A handle to use with `readUInt16(from:)`.
+  public func register(_ hasher: SHAKE128) -> Stream {
+    let index: Int
+    if let reusable = freeList.popLast() {
+      index = reusable
+    } else {
+      index = slots.count
+      slots.append(Slot())
+      reserveCapacity(slots.count)
+    }
+
+    var state = hasher.impl.state
+    var slot = Slot(isRegistered: true)
+    if state.pt != 0 && state.pt < state.rsiz {
+      // Drain the partially squeezed block so the state sits on a block boundary, the drained
+      // bytes end where the next block starts so every refill writes a whole block.
+      let count = Int(state.rsiz - state.pt)
+      CSHAKE128_shake_read(&state, buffer(at: index) + Self.blockByteCount - count, count)
+      slot.readerIndex = Self.blockByteCount - count
+      slot.readableBytes = count
+      slot.writerIndex = Self.blockByteCount
+    }
+    self.state(at: index).pointee = state
+    slots[index] = slot
+    return Stream(index: index)
+  }
+
+  /// Unregisters `stream`, the handle must not be used afterwards.
+  public func unregister(_ stream: Stream) {
+    precondition(slots[stream.index].isRegistered, "stream is not registered")
+    slots[stream.index] = Slot()
+    freeList.append(stream.index)
+  }
+
+  /// Reads the next two bytes of `stream` as a big-endian `UInt16`.
+  public func readUInt16(from stream: Stream) -> UInt16 {
+    precondition(slots[stream.index].isRegistered, "stream is not registered")
+    if slots[stream.index].readableBytes < 2 {
+      refill()
+    }
+
+    let buffer = self.buffer(at: stream.index)
+    var slot = slots[stream.index]
+    var value = UInt16(buffer[slot.readerIndex]) << 8
+    slot.readerIndex = (slot.readerIndex + 1) % Self.bufferByteCount
+    value |= UInt16(buffer[slot.readerIndex])
+    slot.readerIndex = (slot.readerIndex + 1) % Self.bufferByteCount
+    slot.readableBytes -= 2
+    slots[stream.index] = slot
+    return value
+  }
+
+  /// Squeezes one more block for every registered stream that has room for it.
+  public func refill() {
+    statePointers.removeAll(keepingCapacity: true)
+    outputPointers.removeAll(keepingCapacity: true)
+
+    for index in slots.indices
+    where slots[index].isRegistered && slots[index].readableBytes <= Self.blockByteCount {
+      let writerIndex = slots[index].writerIndex
+      statePointers.append(UnsafeMutableRawPointer(state(at: index)))
+      outputPointers.append(buffer(at: index) + writerIndex)
+      slots[index].writerIndex = (writerIndex + Self.blockByteCount) % Self.bufferByteCount
+      slots[index].readableBytes += Self.blockByteCount
+    }
+
+    let count = statePointers.count
+    guard count > 0 else {
+      return
+    }
+    statePointers.withUnsafeMutableBufferPointer { states in
+      outputPointers.withUnsafeMutableBufferPointer { outputs in
+        states.baseAddress!.withMemoryRebound(
+          to: UnsafeMutablePointer<sha3_ctx_t>?.self,
+          capacity: count
+        ) {
+          CSHAKE128_shake_squeeze_blocks($0, outputs.baseAddress!, count)
+        }
+      }
+    }
+  }
+
+  private func state(at index: Int) -> UnsafeMutablePointer<sha3_ctx_t> {
+    states!.assumingMemoryBound(to: sha3_ctx_t.self) + index
+  }
+
+  private func buffer(at index: Int) -> UnsafeMutablePointer<UInt8> {
+    buffers!.assumingMemoryBound(to: UInt8.self) + index * Self.bufferByteCount
+  }
+
+  private func reserveCapacity(_ minimumCapacity: Int) {
+    guard minimumCapacity > capacity else {
+      return
+    }
+    let newCapacity = max(minimumCapacity, capacity * 2, 8)
+
+    let newStates = UnsafeMutableRawPointer.allocate(
+      byteCount: newCapacity * MemoryLayout<sha3_ctx_t>.stride,
+      alignment: MemoryLayout<sha3_ctx_t>.alignment
+    )
+    newStates.initializeMemory(as: sha3_ctx_t.self, repeating: .init(), count: newCapacity)
+    let newBuffers = UnsafeMutableRawPointer.allocate(
+      byteCount: newCapacity * Self.bufferByteCount,
+      alignment: MemoryLayout<UInt64>.alignment
+    )
+    newBuffers.initializeMemory(
+      as: UInt8.self,
+      repeating: 0,
+      count: newCapacity * Self.bufferByteCount
+    )
+
+    if let states, let buffers {
+      newStates.copyMemory(from: states, byteCount: capacity * MemoryLayout<sha3_ctx_t>.stride)
+      newBuffers.copyMemory(from: buffers, byteCount: capacity * Self.bufferByteCount)
+      states.deallocate()
+      buffers.deallocate()
+    }
+
+    states = newStates
+    buffers = newBuffers
+    capacity = newCapacity
+    statePointers.reserveCapacity(newCapacity)
+    outputPointers.reserveCapacity(newCapacity)
+  }
+}
+
+@available(*, unavailable)
+extension SHAKE128KeystreamScheduler: Sendable {}
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+extension SHAKE128 {
+
+  /// A buffered reader over the SHAKE128 output stream.
+  ///
+  /// `Reader` squeezes a whole rate block at a time into inline storage and serves small reads,
+  /// such as the 2-byte VMESS length and padding masks, from it without allocating. The bytes it
+  /// returns are exactly the ones successive `read(digestSize:)` calls would have returned.
+  public struct Reader {
+
+    // 21 lanes, one SHAKE128 rate block.
+    private typealias Block = (
+      UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64,
+      UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64,
+      UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64
+    )
+
+    private var hasher: SHAKE128
+    private var block: Block = (
+      0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0
+    )
+    private var readerIndex: Int
+
+    /// Creates a reader that continues the output stream of `hasher`.
+    ///
+    /// Reading from the reader does not advance `hasher` itself.
+    /// - Parameter hasher: The hash function to squeeze.
+    public init(_ hasher: SHAKE128) {
+      assert(MemoryLayout<Block>.size == SHAKE128.blockByteCount)
+      self.hasher = hasher
+      self.readerIndex = SHAKE128.blockByteCount
+    }
+
+    /// Reads the next two bytes of the output stream as a big-endian `UInt16`.
+    public mutating func readUInt16() -> UInt16 {
+      let index = readerIndex
+      guard index + 2 <= SHAKE128.blockByteCount else {
+        var value = UInt16.zero
+        withUnsafeMutableBytes(of: &value) {
+          read(into: $0)
+        }
+        return UInt16(bigEndian: value)
+      }
+
+      readerIndex = index + 2
+      return withUnsafeBytes(of: &block) {
+        UInt16($0[index]) << 8 | UInt16($0[index + 1])
+      }
+    }
+
+    /// Fills `buffer` with the next bytes of the output stream.
+    public mutating func read(into buffer: UnsafeMutableRawBufferPointer) {
+      var bytesWritten = 0
+      while bytesWritten < buffer.count {
+        if readerIndex == SHAKE128.blockByteCount {
+          refill()
+        }
+        let index = readerIndex
+        let count = min(SHAKE128.blockByteCount - index, buffer.count - bytesWritten)
+        withUnsafeBytes(of: &block) {
+          UnsafeMutableRawBufferPointer(rebasing: buffer[bytesWritten..<bytesWritten + count])
+            .copyMemory(from: UnsafeRawBufferPointer(rebasing: $0[index..<index + count]))
+        }
+        readerIndex = index + count
+        bytesWritten += count
+      }
+    }
+
+    private mutating func refill() {
+      // Squeeze into a local so the closure only has to access `hasher`.
+      var block = self.block
+      withUnsafeMutableBytes(of: &block) {
+        hasher.read(into: $0)
+      }
+      self.block = block
+      readerIndex = 0
+    }
+  }
+}
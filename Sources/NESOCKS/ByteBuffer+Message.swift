@@ -133,14 +133,14 @@ extension ByteBuffer {
     return written
   }
 
-  mutating func readRequestDetails() throws -> Request? {
+  mutating func readRequestDetails(internTable: HostNameInternTable? = nil) throws -> Request? {
     var buffer = self
 
     guard
       let version = buffer.readInteger(as: UInt8.self),
       let command = buffer.readInteger(as: UInt8.self),
       let reserved = buffer.readInteger(as: UInt8.self),
-      let address = try buffer.readRFC1928RequestAddressAsEndpoint()
+      let address = try buffer.readRFC1928RequestAddressAsEndpoint(internTable: internTable)
     else {
       return nil
     }
@@ -191,4 +191,36 @@ extension ByteBuffer {
       + writeInteger(response.reply.rawValue)
       + writeInteger(UInt8.zero) + writeEndpointInRFC1928RequestAddressFormat(response.boundAddress)
   }
+
+  /// Read a UDP relay datagram of structure, RFC 1928:
+  ///
+  ///      [RSV][FRAG][ATYP][DST.ADDR][DST.PORT][DATA]
+  ///
+  /// Fragmentation is not supported, fragments are read as `nil` like truncated datagrams so
+  /// they are dropped.
+  mutating func readDatagram() throws -> SOCKS5Datagram? {
+    var buffer = self
+    guard
+      buffer.readInteger(as: UInt16.self) != nil,
+      let fragment = buffer.readInteger(as: UInt8.self),
+      fragment == 0,
+      let endpoint = try buffer.readRFC1928RequestAddressAsEndpoint()
+    else {
+      return nil
+    }
+
+    let data = buffer.readSlice(length: buffer.readableBytes)!
+    self = buffer
+
+    return .init(endpoint: endpoint, data: data)
+  }
+
+  @discardableResult
+  mutating func writeDatagram(_ datagram: SOCKS5Datagram) -> Int {
+    var written = writeInteger(UInt16.zero)
+    written += writeInteger(UInt8.zero)
+    written += writeEndpointInRFC1928RequestAddressFormat(datagram.endpoint)
+    written += writeImmutableBuffer(datagram.data)
+    return written
+  }
 }
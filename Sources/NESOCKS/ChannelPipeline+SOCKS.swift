@@ -24,13 +24,17 @@ extension ChannelPipeline {
   ///   - passwordReference: The passwordReference to use when authenticate this connection.
   ///   - authenticationRequired: A boolean value to determinse whether SOCKS proxy client should perform proxy authentication.
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - fastOpen: A boolean value to determine whether SOCKS proxy client should send the whole handshake without waiting for replies. Defaults to `false`.
+  ///   - instrumentation: The instrumentation to report handshake and traffic events to. Defaults to `nil`.
   /// - Returns: An `EventLoopFuture` that will fire when the pipeline is configured.
   public func addSOCKSClientHandlers(
     position: Position = .last,
     username: String,
     passwordReference: String,
     authenticationRequired: Bool,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    fastOpen: Bool = false,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) -> EventLoopFuture<Void> {
 
     guard eventLoop.inEventLoop else {
@@ -40,7 +44,9 @@ extension ChannelPipeline {
           username: username,
           passwordReference: passwordReference,
           authenticationRequired: authenticationRequired,
-          destinationAddress: destinationAddress
+          destinationAddress: destinationAddress,
+          fastOpen: fastOpen,
+          instrumentation: instrumentation
         )
       }
     }
@@ -51,7 +57,9 @@ extension ChannelPipeline {
         username: username,
         passwordReference: passwordReference,
         authenticationRequired: authenticationRequired,
-        destinationAddress: destinationAddress
+        destinationAddress: destinationAddress,
+        fastOpen: fastOpen,
+        instrumentation: instrumentation
       )
     }
   }
@@ -62,15 +70,19 @@ extension ChannelPipeline {
   ///   - username: The username to use when authenticate this connection. Defaults to `""`.
   ///   - passwordReference: The passwordReference to use when authenticate this connection. Defaults to `""`.
   ///   - authenticationRequired: A boolean value to determinse whether SOCKS proxy client should perform proxy authentication. Defaults to `false`.
+  ///   - internTable: The table requested domain names are interned into, if any. Defaults to `nil`.
   ///   - completion: The completion handler to use when handshake completed and outbound channel established.
   ///       this completion pass request info, server channel and outbound client channel and returns `EventLoopFuture<Void>`.
+  ///   - udpAssociation: The handler of UDP ASSOCIATE requests that returns the bound address of the opened UDP relay, UDP ASSOCIATE is rejected if `nil`. Defaults to `nil`.
   /// - Returns: An `EventLoopFuture` that will fire when the pipeline is configured.
   public func configureSOCKSServerPipeline(
     position: ChannelPipeline.Position = .last,
     username: String = "",
     passwordReference: String = "",
     authenticationRequired: Bool = false,
-    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>
+    internTable: HostNameInternTable? = nil,
+    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>,
+    udpAssociation: (@Sendable (NWEndpoint) -> EventLoopFuture<SocketAddress>)? = nil
   ) -> EventLoopFuture<Void> {
 
     guard eventLoop.inEventLoop else {
@@ -80,7 +92,9 @@ extension ChannelPipeline {
           username: username,
           passwordReference: passwordReference,
           authenticationRequired: authenticationRequired,
-          completion: completion
+          internTable: internTable,
+          completion: completion,
+          udpAssociation: udpAssociation
         )
       }
     }
@@ -91,7 +105,9 @@ extension ChannelPipeline {
         username: username,
         passwordReference: passwordReference,
         authenticationRequired: authenticationRequired,
-        completion: completion
+        internTable: internTable,
+        completion: completion,
+        udpAssociation: udpAssociation
       )
     }
   }
@@ -106,13 +122,17 @@ extension ChannelPipeline.SynchronousOperations {
   ///   - passwordReference: The passwordReference to use when authenticate this connection.
   ///   - authenticationRequired: A boolean value to determinse whether SOCKS proxy client should perform proxy authentication.
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - fastOpen: A boolean value to determine whether SOCKS proxy client should send the whole handshake without waiting for replies. Defaults to `false`.
+  ///   - instrumentation: The instrumentation to report handshake and traffic events to. Defaults to `nil`.
   /// - Throws: If the pipeline could not be configured.
   public func addSOCKSClientHandlers(
     position: ChannelPipeline.Position = .last,
     username: String,
     passwordReference: String,
     authenticationRequired: Bool,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    fastOpen: Bool = false,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) throws {
     eventLoop.assertInEventLoop()
 
@@ -120,7 +140,9 @@ extension ChannelPipeline.SynchronousOperations {
       username: username,
       passwordReference: passwordReference,
       authenticationRequired: authenticationRequired,
-      destinationAddress: destinationAddress
+      destinationAddress: destinationAddress,
+      fastOpen: fastOpen,
+      instrumentation: instrumentation
     )
 
     try addHandler(handler)
@@ -132,15 +154,19 @@ extension ChannelPipeline.SynchronousOperations {
   ///   - username: The username to use when authenticate this connection. Defaults to `""`.
   ///   - passwordReference: The passwordReference to use when authenticate this connection. Defaults to `""`.
   ///   - authenticationRequired: A boolean value to determinse whether SOCKS proxy client should perform proxy authentication. Defaults to `false`.
+  ///   - internTable: The table requested domain names are interned into, if any. Defaults to `nil`.
   ///   - completion: The completion handler to use when handshake completed and outbound channel established.
   ///       this completion pass request info, server channel and outbound client channel and returns `EventLoopFuture<Void>`.
+  ///   - udpAssociation: The handler of UDP ASSOCIATE requests that returns the bound address of the opened UDP relay, UDP ASSOCIATE is rejected if `nil`. Defaults to `nil`.
   /// - Throws: If the pipeline could not be configured.
   public func configureSOCKSServerPipeline(
     position: ChannelPipeline.Position = .last,
     username: String = "",
     passwordReference: String = "",
     authenticationRequired: Bool = false,
-    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>
+    internTable: HostNameInternTable? = nil,
+    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>,
+    udpAssociation: (@Sendable (NWEndpoint) -> EventLoopFuture<SocketAddress>)? = nil
   ) throws {
     self.eventLoop.assertInEventLoop()
 
@@ -148,9 +174,31 @@ extension ChannelPipeline.SynchronousOperations {
       username: username,
       passwordReference: passwordReference,
       authenticationRequired: authenticationRequired,
-      completion: completion
+      internTable: internTable,
+      completion: completion,
+      udpAssociation: udpAssociation
     )
 
     try self.addHandler(handler, position: position)
   }
+
+  /// Configure a datagram `ChannelPipeline` for use as the client of a SOCKS5 UDP relay.
+  ///
+  /// The pipeline reads and writes `SOCKS5Datagram`, every datagram is sent to `relayAddress`.
+  /// - Parameters:
+  ///   - position: The position in the `ChannelPipeline` where to add the SOCKS datagram handlers. Defaults to `.last`.
+  ///   - relayAddress: The bound address the server replied to the UDP ASSOCIATE request.
+  /// - Throws: If the pipeline could not be configured.
+  public func addSOCKSDatagramClientHandlers(
+    position: ChannelPipeline.Position = .last,
+    relayAddress: SocketAddress
+  ) throws {
+    self.eventLoop.assertInEventLoop()
+
+    let handlers: [ChannelHandler] = [
+      SOCKS5DatagramDecoder(),
+      SOCKS5DatagramEncoder(relayAddress: relayAddress),
+    ]
+    try self.addHandlers(handlers, position: position)
+  }
 }
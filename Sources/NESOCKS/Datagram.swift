@@ -0,0 +1,32 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import _NELinux
+
+/// A datagram relayed through a SOCKS5 UDP ASSOCIATE.
+public struct SOCKS5Datagram: Hashable, Sendable {
+
+  /// The target to send the datagram to, or the source the datagram was received from.
+  public var endpoint: NWEndpoint
+
+  /// The payload of the datagram.
+  public var data: ByteBuffer
+
+  /// Initialize an instance of `SOCKS5Datagram` with specified `endpoint` and `data`.
+  public init(endpoint: NWEndpoint, data: ByteBuffer) {
+    self.endpoint = endpoint
+    self.data = data
+  }
+}
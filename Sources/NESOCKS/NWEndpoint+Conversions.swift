@@ -19,23 +19,37 @@ import _NELinux
 extension IPv4Address {
   /// Create an `IPv4Address` object from a `sockaddr_in`.
   internal init(_ sockAddr: sockaddr_in) {
+    #if canImport(Network)
     var localAddr = sockAddr
     self = withUnsafeBytes(of: &localAddr.sin_addr) {
       precondition($0.count == 4)
       let addrData = Data(bytes: $0.baseAddress!, count: $0.count)
       return IPv4Address(addrData)!
     }
+    #else
+    self.init(packedBytes: sockAddr.sin_addr.s_addr)
+    #endif
   }
 }
 
 extension IPv6Address {
   internal init(_ sockAddr: sockaddr_in6) {
+    #if canImport(Network)
     var localAddr = sockAddr
     self = withUnsafeBytes(of: &localAddr.sin6_addr) {
       precondition($0.count == 16)
       let addrData = Data(bytes: $0.baseAddress!, count: $0.count)
       return IPv6Address(addrData)!
     }
+    #else
+    let packedBytes = withUnsafeBytes(of: sockAddr.sin6_addr) {
+      (
+        $0.loadUnaligned(as: UInt64.self),
+        $0.loadUnaligned(fromByteOffset: 8, as: UInt64.self)
+      )
+    }
+    self.init(packedBytes: packedBytes)
+    #endif
   }
 }
 
@@ -60,3 +74,43 @@ extension NWEndpoint {
     }
   }
 }
+
+extension SocketAddress {
+
+  /// Create a `SocketAddress` of an IP endpoint, returns `nil` for other endpoints, such as
+  /// domain names, that need resolving first.
+  ///
+  /// The socket address is built from the packed address bytes in place, without a buffer.
+  init?(_ endpoint: NWEndpoint) {
+    guard case .hostPort(let host, let port) = endpoint else {
+      return nil
+    }
+    switch host {
+    case .ipv4(let address):
+      var sockAddr = sockaddr_in()
+      sockAddr.sin_family = sa_family_t(AF_INET)
+      sockAddr.sin_port = in_port_t(port.rawValue).bigEndian
+      #if canImport(Network)
+      withUnsafeMutableBytes(of: &sockAddr.sin_addr) { $0.copyBytes(from: address.rawValue) }
+      #else
+      sockAddr.sin_addr.s_addr = address.packedBytes
+      #endif
+      self.init(sockAddr, host: "")
+    case .ipv6(let address):
+      var sockAddr = sockaddr_in6()
+      sockAddr.sin6_family = sa_family_t(AF_INET6)
+      sockAddr.sin6_port = in_port_t(port.rawValue).bigEndian
+      #if canImport(Network)
+      withUnsafeMutableBytes(of: &sockAddr.sin6_addr) { $0.copyBytes(from: address.rawValue) }
+      #else
+      withUnsafeMutableBytes(of: &sockAddr.sin6_addr) {
+        $0.storeBytes(of: address.packedBytes.0, as: UInt64.self)
+        $0.storeBytes(of: address.packedBytes.1, toByteOffset: 8, as: UInt64.self)
+      }
+      #endif
+      self.init(sockAddr, host: "")
+    default:
+      return nil
+    }
+  }
+}
@@ -49,6 +49,21 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
   /// The destination address of the proxy request.
   private let destinationAddress: NWEndpoint
 
+  /// A boolean value determines whether the whole handshake is sent without waiting for replies.
+  private let fastOpen: Bool
+
+  /// The instrumentation to report handshake and traffic events to.
+  private let instrumentation: (any ProxyInstrumentation)?
+
+  /// The time the handshake began, set only when `instrumentation` is not `nil`.
+  private var handshakeStartTime: NIODeadline?
+
+  /// The time the current handshake stage began, set only when `instrumentation` is not `nil`.
+  private var stageStartTime: NIODeadline?
+
+  /// The largest number of writes buffered at once during the handshake.
+  private var bufferedWritesHighWaterMark = 0
+
   /// Creates a new `SOCKS5ClientHandler` that connects to a server
   /// and instructs the server to connect to `destinationAddress`.
   /// - Parameters:
@@ -56,11 +71,20 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
   ///   - passwordReference: The password use for username/password authentication.
   ///   - authenticationRequired: A boolean value determinse whether should use username and password authentication.
   ///   - destinationAddress: The desired end point - note that only IPv4, IPv6, and FQDNs are supported.
+  ///   - fastOpen: If `true`, greeting, credentials, request and the writes buffered so far are
+  ///     sent in one flush and later writes are sent straight away, the replies are validated as
+  ///     they arrive. This saves a round trip per handshake message, but the server must accept
+  ///     pipelined handshakes and data written before the reply is lost if the request fails.
+  ///     Defaults to `false`.
+  ///   - instrumentation: The instrumentation to report handshake stage timings, buffered writes
+  ///     and bytes transferred to. Defaults to `nil`.
   public init(
     username: String,
     passwordReference: String,
     authenticationRequired: Bool,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    fastOpen: Bool = false,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) {
     guard case .hostPort = destinationAddress else {
       preconditionFailure("Initialize with \(destinationAddress) is not supported yet.")
@@ -70,6 +94,8 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
     self.passwordReference = passwordReference
     self.authenticationRequired = authenticationRequired
     self.destinationAddress = destinationAddress
+    self.fastOpen = fastOpen
+    self.instrumentation = instrumentation
     self.state = .idle
     self.bufferedWrites = .init(initialCapacity: 6)
   }
@@ -89,6 +115,13 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
 
     // if we've established the connection then forward on the data
     guard state != .established else {
+      if let instrumentation {
+        instrumentation.bytesTransferred(
+          unwrapInboundIn(data).readableBytes,
+          direction: .inbound,
+          component: .socks5Client
+        )
+      }
       context.fireChannelRead(data)
       return
     }
@@ -97,15 +130,22 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
 
     readBuffer.setOrWriteBuffer(&byteBuffer)
 
-    switch state {
-    case .greeting:
-      receiveAuthenticationMethodResponse(context: context)
-    case .authorizing:
-      receiveAuthenticationResponse(context: context)
-    case .addressing:
-      receiveReplies(context: context)
-    default:
-      break
+    // Replies may arrive together, handle them until one is incomplete.
+    while (readBuffer?.readableBytes ?? 0) > 0 {
+      let previousState = state
+      switch state {
+      case .greeting:
+        receiveAuthenticationMethodResponse(context: context)
+      case .authorizing:
+        receiveAuthenticationResponse(context: context)
+      case .addressing:
+        receiveReplies(context: context)
+      default:
+        return
+      }
+      guard state != previousState else {
+        return
+      }
     }
   }
 
@@ -114,10 +154,26 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
     data: NIOAny,
     promise: EventLoopPromise<Void>?
   ) {
+    if let instrumentation {
+      instrumentation.bytesTransferred(
+        unwrapOutboundIn(data).readableBytes,
+        direction: .outbound,
+        component: .socks5Client
+      )
+    }
+    guard !isSendingEarlyData else {
+      context.write(data, promise: promise)
+      return
+    }
     bufferWrite(data: unwrapOutboundIn(data), promise: promise)
   }
 
   public func flush(context: ChannelHandlerContext) {
+    guard !isSendingEarlyData else {
+      context.flush()
+      return
+    }
+
     bufferFlush()
 
     // Unbuffer writes when handshake is success.
@@ -146,6 +202,20 @@ final public class SOCKS5ClientHandler: ChannelDuplexHandler, RemovableChannelHa
 
 extension SOCKS5ClientHandler {
 
+  /// A boolean value determines whether writes are sent before the handshake completes, that is
+  /// the fast open handshake has been sent and the server has not failed it.
+  private var isSendingEarlyData: Bool {
+    guard fastOpen else {
+      return false
+    }
+    switch state {
+    case .greeting, .authorizing, .addressing:
+      return true
+    case .idle, .established, .failed:
+      return false
+    }
+  }
+
   private typealias BufferedWrite = (data: ByteBuffer, promise: EventLoopPromise<Void>?)
 
   private func bufferWrite(data: ByteBuffer, promise: EventLoopPromise<Void>?) {
@@ -154,6 +224,9 @@ extension SOCKS5ClientHandler {
       return
     }
     bufferedWrites.append((data: data, promise: promise))
+    if state != .established {
+      bufferedWritesHighWaterMark = max(bufferedWritesHighWaterMark, bufferedWrites.count)
+    }
   }
 
   private func bufferFlush() {
@@ -161,6 +234,14 @@ extension SOCKS5ClientHandler {
   }
 
   private func unbufferWrites(context: ChannelHandlerContext) {
+    if let instrumentation, bufferedWritesHighWaterMark > 0 {
+      instrumentation.bufferedWritesHighWaterMark(
+        bufferedWritesHighWaterMark,
+        component: .socks5Client
+      )
+      bufferedWritesHighWaterMark = 0
+    }
+
     while bufferedWrites.hasMark {
       let bufferedWrite = bufferedWrites.removeFirst()
       context.write(wrapOutboundOut(bufferedWrite.data), promise: bufferedWrite.promise)
@@ -178,6 +259,11 @@ extension SOCKS5ClientHandler {
 
     if let byteBuffer = readBuffer, byteBuffer.readableBytes > 0 {
       readBuffer = nil
+      instrumentation?.bytesTransferred(
+        byteBuffer.readableBytes,
+        direction: .inbound,
+        component: .socks5Client
+      )
       context.fireChannelRead(wrapInboundOut(byteBuffer))
     }
   }
@@ -188,7 +274,36 @@ extension SOCKS5ClientHandler {
   private func startHandshaking(context: ChannelHandlerContext) {
     precondition(state == .idle, "Invalid client state: \(state)")
     state = .greeting
-    sendAuthenticationMethodRequest(context: context)
+    if instrumentation != nil {
+      handshakeStartTime = .now()
+      stageStartTime = handshakeStartTime
+    }
+    guard fastOpen else {
+      sendAuthenticationMethodRequest(context: context)
+      return
+    }
+    sendFastOpenHandshake(context: context)
+  }
+
+  /// Send greeting, credentials and request in one buffer, followed by the buffered writes, and
+  /// flush them together.
+  private func sendFastOpenHandshake(context: ChannelHandlerContext) {
+    let method: Authentication.Method = authenticationRequired ? .usernamePassword : .noRequired
+
+    // [version, #methods, methods...] [version, ulen, uname, plen, passwd] [request]
+    let capacity = 3 + 3 + username.utf8.count + passwordReference.utf8.count + 6 + 256
+    var buffer = context.channel.allocator.buffer(capacity: capacity)
+    buffer.writeAuthenticationMethodRequest(.init(methods: [method]))
+    if authenticationRequired {
+      buffer.writeAuthenticationRequest(
+        .init(username: username, password: passwordReference)
+      )
+    }
+    buffer.writeRequestDetails(Request(command: .connect, address: destinationAddress))
+    context.write(wrapOutboundOut(buffer), promise: nil)
+
+    // Writes buffered before the channel became active are early data too.
+    unbufferWrites(context: context)
   }
 
   private func sendAuthenticationMethodRequest(context: ChannelHandlerContext) {
@@ -220,11 +335,17 @@ extension SOCKS5ClientHandler {
 
     switch authentication.method {
     case .noRequired:
+      handshakeStageDidComplete(.methodSelection)
       state = .addressing
-      sendRequestDetails(context: context)
+      if !fastOpen {
+        sendRequestDetails(context: context)
+      }
     case .usernamePassword:
+      handshakeStageDidComplete(.methodSelection)
       state = .authorizing
-      sendAuthenticationRequest(context: context)
+      if !fastOpen {
+        sendAuthenticationRequest(context: context)
+      }
     case .noAcceptable:
       state = .failed
       context.fireErrorCaught(
@@ -259,7 +380,12 @@ extension SOCKS5ClientHandler {
 
   private func receiveAuthenticationResponse(context: ChannelHandlerContext) {
     precondition(state == .authorizing, "Invalid client state: \(state)")
-    guard let authMsg = readBuffer?.readAuthenticationResponse(), authMsg.isSuccess else {
+    guard let authMsg = readBuffer.readAuthenticationResponse() else {
+      return
+    }
+
+    guard authMsg.isSuccess else {
+      instrumentation?.authenticationDidFail(component: .socks5Client)
       state = .failed
       context.fireErrorCaught(
         SOCKSError.authenticationFailed(reason: .badCredentials)
@@ -271,9 +397,12 @@ extension SOCKS5ClientHandler {
       return
     }
 
+    handshakeStageDidComplete(.authentication)
     state = .addressing
 
-    sendRequestDetails(context: context)
+    if !fastOpen {
+      sendRequestDetails(context: context)
+    }
   }
 
   private func sendRequestDetails(context: ChannelHandlerContext) {
@@ -313,6 +442,13 @@ extension SOCKS5ClientHandler {
       return
     }
 
+    handshakeStageDidComplete(.connect)
+    if let instrumentation, let handshakeStartTime {
+      instrumentation.handshakeDidComplete(
+        component: .socks5Client,
+        duration: .now() - handshakeStartTime
+      )
+    }
     state = .established
 
     flushBuffers(context: context)
@@ -324,11 +460,31 @@ extension SOCKS5ClientHandler {
     }
   }
 
+  private func handshakeStageDidComplete(_ stage: ProxyHandshakeStage) {
+    guard let instrumentation, let stageStartTime else {
+      return
+    }
+    let now = NIODeadline.now()
+    instrumentation.handshakeStageDidComplete(
+      stage,
+      component: .socks5Client,
+      duration: now - stageStartTime
+    )
+    self.stageStartTime = now
+  }
+
   private func channelClose(context: ChannelHandlerContext, reason: Error) {
+    instrumentation?.handshakeDidFail(component: .socks5Client, error: reason)
     context.close(promise: nil)
   }
 }
 
+extension ProxyComponent {
+
+  /// A `SOCKS5ClientHandler`.
+  public static let socks5Client = ProxyComponent(rawValue: "socks5-client")
+}
+
 /// A `Channel` user event that is sent when a SOCKS connection has been established
 ///
 /// After this event has been received it is save to remove the `SOCKS5ClientHandler` from the channel pipeline.
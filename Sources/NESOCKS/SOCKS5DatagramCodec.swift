@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import _NELinux
+
+/// Sends datagrams through the UDP relay of a SOCKS5 UDP ASSOCIATE.
+///
+/// Every `SOCKS5Datagram` is prefixed with the RFC 1928 UDP request header of its endpoint and
+/// sent to the relay. Writes are only flushed when the channel is flushed, so datagrams written
+/// together leave in one vectored write.
+final public class SOCKS5DatagramEncoder: ChannelOutboundHandler {
+
+  public typealias OutboundIn = SOCKS5Datagram
+
+  public typealias OutboundOut = AddressedEnvelope<ByteBuffer>
+
+  private let relayAddress: SocketAddress
+
+  /// Initialize an instance of `SOCKS5DatagramEncoder` with specified `relayAddress`.
+  /// - Parameter relayAddress: The bound address the server replied to the UDP ASSOCIATE request.
+  public init(relayAddress: SocketAddress) {
+    self.relayAddress = relayAddress
+  }
+
+  public func write(context: ChannelHandlerContext, data: NIOAny, promise: EventLoopPromise<Void>?)
+  {
+    let datagram = unwrapOutboundIn(data)
+
+    // [RSV, FRAG, ATYP, DST.ADDR, DST.PORT] the largest address is a domain name of 255 bytes.
+    let capacity = 2 + 1 + 1 + 1 + 255 + 2 + datagram.data.readableBytes
+    var byteBuffer = context.channel.allocator.buffer(capacity: capacity)
+    byteBuffer.writeDatagram(datagram)
+
+    let envelope = AddressedEnvelope(remoteAddress: relayAddress, data: byteBuffer)
+    context.write(wrapOutboundOut(envelope), promise: promise)
+  }
+}
+
+@available(*, unavailable)
+extension SOCKS5DatagramEncoder: Sendable {}
+
+/// Receives datagrams from the UDP relay of a SOCKS5 UDP ASSOCIATE.
+///
+/// The RFC 1928 UDP request header of every packet is read as the `SOCKS5Datagram` endpoint, the
+/// source the relay received the payload from. Fragments and truncated packets are dropped.
+final public class SOCKS5DatagramDecoder: ChannelInboundHandler {
+
+  public typealias InboundIn = AddressedEnvelope<ByteBuffer>
+
+  public typealias InboundOut = SOCKS5Datagram
+
+  /// Initialize an instance of `SOCKS5DatagramDecoder`.
+  public init() {}
+
+  public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    var envelope = unwrapInboundIn(data)
+    do {
+      guard let datagram = try envelope.data.readDatagram() else {
+        return
+      }
+      context.fireChannelRead(wrapInboundOut(datagram))
+    } catch {
+      context.fireErrorCaught(error)
+    }
+  }
+}
+
+@available(*, unavailable)
+extension SOCKS5DatagramDecoder: Sendable {}
@@ -26,21 +26,22 @@ final public class SOCKS5ServerHandler: ChannelInboundHandler, RemovableChannelH
   public typealias OutboundOut = ByteBuffer
 
   private enum Progress: Equatable {
-    case waitingForGreeting(ByteBuffer?)
-    case waitingForAuthorizing(ByteBuffer)
-    case waitingForRequest(ByteBuffer)
+    case waitingForGreeting
+    case waitingForAuthorizing
+    case waitingForRequest
+    case waitingForConnection
     case completed
+    case failed
   }
 
-  private var progress: Progress = .waitingForGreeting(nil)
+  private var progress: Progress = .waitingForGreeting
 
-  private enum EventBuffer {
-    case channelRead(data: NIOAny)
-    case channelReadComplete
-  }
-
-  /// Buffered channel read buffer.
-  private var eventBuffer: CircularBuffer<EventBuffer> = .init(initialCapacity: 2)
+  /// The bytes received and not handled yet.
+  ///
+  /// Greeting, authentication and request are parsed straight from this buffer, so pipelined
+  /// messages are handled in one pass, and the bytes that follow the request are forwarded in
+  /// one read once the proxy connection is established.
+  private var cumulationBuffer: ByteBuffer?
 
   /// The usename used to authenticate this proxy connection.
   private let username: String
@@ -51,165 +52,241 @@ final public class SOCKS5ServerHandler: ChannelInboundHandler, RemovableChannelH
   /// A boolean value deterinse whether server should evaluate proxy authentication request.
   private let authenticationRequired: Bool
 
+  /// The table requested domain names are interned into, if any.
+  private let internTable: HostNameInternTable?
+
   /// The completion handler when proxy connection established.
   private let completion: @Sendable (NWEndpoint) -> EventLoopFuture<Void>
 
+  /// The handler that opens the UDP relay of a UDP ASSOCIATE request.
+  private let udpAssociation: (@Sendable (NWEndpoint) -> EventLoopFuture<SocketAddress>)?
+
   /// Initialize an instance of `SOCKS5ServerHandler` with specified parameters.
   ///
   /// - Parameters:
   ///   - username: Username for proxy authentication.
   ///   - passwordReference: Password for proxy authentication.
   ///   - authenticationRequired: A boolean value deterinse whether server should evaluate proxy authentication request.
+  ///   - internTable: The table requested domain names are interned into, so that servers that
+  ///     see the same destinations over and over share their names. Defaults to `nil`.
   ///   - completion: The completion handler when proxy connection established, returns `EventLoopFuture<Void>` using given request info, server channel and outbound client channel.
+  ///   - udpAssociation: The handler of UDP ASSOCIATE requests, it is given the address the client
+  ///     expects to send datagrams from and returns the bound address of the opened UDP relay, for
+  ///     example a datagram channel with `SOCKS5UDPRelayHandler`. The relay must be closed when
+  ///     this connection closes. UDP ASSOCIATE is rejected if `nil`. Defaults to `nil`.
   public init(
     username: String,
     passwordReference: String,
     authenticationRequired: Bool,
-    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>
+    internTable: HostNameInternTable? = nil,
+    completion: @escaping @Sendable (NWEndpoint) -> EventLoopFuture<Void>,
+    udpAssociation: (@Sendable (NWEndpoint) -> EventLoopFuture<SocketAddress>)? = nil
   ) {
     self.username = username
     self.passwordReference = passwordReference
     self.authenticationRequired = authenticationRequired
+    self.internTable = internTable
     self.completion = completion
+    self.udpAssociation = udpAssociation
   }
 
   public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
-    var buffer = unwrapInboundIn(data)
-
     switch progress {
-    case .waitingForGreeting(let byteBuffer):
-      var byteBuffer = byteBuffer ?? context.channel.allocator.buffer(capacity: 3)
-      byteBuffer.writeBuffer(&buffer)
-      handleGreeting(context: context, data: byteBuffer)
-    case .waitingForAuthorizing(var byteBuffer):
-      byteBuffer.writeBuffer(&buffer)
-      handleAuthorizing(context: context, data: byteBuffer)
-    case .waitingForRequest(var byteBuffer):
-      byteBuffer.writeBuffer(&buffer)
-      handleRequest(context: context, data: byteBuffer)
     case .completed:
-      eventBuffer.append(.channelRead(data: data))
+      context.fireChannelRead(data)
+      return
+    case .failed:
+      return
+    case .waitingForGreeting, .waitingForAuthorizing, .waitingForRequest, .waitingForConnection:
+      break
     }
+
+    var buffer = unwrapInboundIn(data)
+    if cumulationBuffer == nil {
+      cumulationBuffer = buffer
+    } else {
+      cumulationBuffer!.writeBuffer(&buffer)
+    }
+
+    handshake(context: context)
   }
 
   public func channelReadComplete(context: ChannelHandlerContext) {
     guard progress == .completed else {
       return
     }
-    eventBuffer.append(.channelReadComplete)
+    context.fireChannelReadComplete()
   }
 
-  private func handleGreeting(context: ChannelHandlerContext, data: ByteBuffer) {
-    var byteBuffer = data
-    guard let message = byteBuffer.readAuthenticationMethodRequest() else {
-      progress = .waitingForGreeting(byteBuffer)
+  /// Handle every complete handshake message in `cumulationBuffer`, replies of pipelined
+  /// messages are written in one buffer and flushed once.
+  private func handshake(context: ChannelHandlerContext) {
+    var replies = context.channel.allocator.buffer(capacity: 4)
+    do {
+      try handleMessages(context: context, replies: &replies)
+    } catch {
+      // Send the replies written so far, like the rejected authentication method, first.
+      flush(replies, context: context)
+      channelClose(context: context, reason: error)
       return
     }
+    flush(replies, context: context)
+
+    if progress == .failed {
+      cumulationBuffer = nil
+      context.close(promise: nil)
+    }
+  }
+
+  private func handleMessages(context: ChannelHandlerContext, replies: inout ByteBuffer) throws {
+    while true {
+      switch progress {
+      case .waitingForGreeting:
+        guard let message = cumulationBuffer?.readAuthenticationMethodRequest() else {
+          return
+        }
+        try handleGreeting(message, replies: &replies)
+      case .waitingForAuthorizing:
+        guard let message = cumulationBuffer?.readAuthenticationRequest() else {
+          // Need more bytes to parse authentication message.
+          return
+        }
+        handleAuthorizing(message, replies: &replies)
+      case .waitingForRequest:
+        guard let details = try cumulationBuffer?.readRequestDetails(internTable: internTable)
+        else {
+          return
+        }
+        progress = .waitingForConnection
+        handleRequest(context: context, details: details)
+        return
+      case .waitingForConnection, .completed, .failed:
+        return
+      }
+    }
+  }
 
+  private func handleGreeting(
+    _ message: Authentication.Method.Request,
+    replies: inout ByteBuffer
+  ) throws {
     guard message.version == .v5 else {
-      channelClose(context: context, reason: SOCKSError.unsupportedProtocolVersion)
-      return
+      throw SOCKSError.unsupportedProtocolVersion
     }
 
     // Choose authentication method
-    let response: Authentication.Method.Response
-
     if authenticationRequired && message.methods.contains(.usernamePassword) {
-      response = .init(method: .usernamePassword)
-      progress = .waitingForAuthorizing(byteBuffer)
+      replies.writeAuthenticationMethodResponse(.init(method: .usernamePassword))
+      progress = .waitingForAuthorizing
     } else if message.methods.contains(.noRequired) {
-      response = .init(method: .noRequired)
-      progress = .waitingForRequest(byteBuffer)
+      replies.writeAuthenticationMethodResponse(.init(method: .noRequired))
+      progress = .waitingForRequest
     } else {
-      response = .init(method: .noAcceptable)
-      // TODO: Error handling NO acceptable method.
+      replies.writeAuthenticationMethodResponse(.init(method: .noAcceptable))
+      throw SOCKSError.authenticationFailed(reason: .noAcceptableMethod)
     }
+  }
 
-    var buffer = context.channel.allocator.buffer(capacity: 2)
-    buffer.writeAuthenticationMethodResponse(response)
+  private func handleAuthorizing(
+    _ message: Authentication.UsernameAuthenticationRequest,
+    replies: inout ByteBuffer
+  ) {
+    let success = message.username == username && message.password == passwordReference
 
-    context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+    replies.writeAuthenticationResponse(
+      Authentication.UsernameAuthenticationResponse(status: success ? 0 : 1)
+    )
+
+    // The connection must be closed after a failure status, so a request pipelined after
+    // rejected credentials is never handled, RFC 1929.
+    progress = success ? .waitingForRequest : .failed
   }
 
-  private func handleAuthorizing(context: ChannelHandlerContext, data: ByteBuffer) {
-    var byteBuffer = data
-    guard let authMsg = byteBuffer.readAuthenticationRequest() else {
-      // Need more bytes to parse authentication message.
-      progress = .waitingForAuthorizing(data)
+  private func flush(_ replies: ByteBuffer, context: ChannelHandlerContext) {
+    guard replies.readableBytes > 0 else {
       return
     }
-
-    progress = .waitingForRequest(byteBuffer)
-
-    let success = authMsg.username == username && authMsg.password == passwordReference
-
-    var buffer = context.channel.allocator.buffer(capacity: 2)
-    buffer.writeAuthenticationResponse(
-      Authentication.UsernameAuthenticationResponse(status: success ? 0 : 1)
-    )
-    context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+    context.writeAndFlush(wrapOutboundOut(replies), promise: nil)
   }
 
-  private func handleRequest(context: ChannelHandlerContext, data: ByteBuffer) {
-    do {
-      var byteBuffer = data
-      guard let details = try byteBuffer.readRequestDetails() else {
-        progress = .waitingForRequest(data)
-        return
-      }
+  private func handleRequest(context: ChannelHandlerContext, details: Request) {
+    switch details.command {
+    case .connect:
+      handleConnect(context: context, address: details.address)
+    case .udpAssociate where udpAssociation != nil:
+      handleUDPAssociate(context: context, address: details.address)
+    default:
+      fail(context: context, reply: .commandUnsupported, address: details.address)
+    }
+  }
 
-      let address = details.address
-
-      completion(address).whenComplete {
-        switch $0 {
-        case .success:
-          // FIXME: SOCKS5 response
-          let response = Response(
-            reply: .succeeded,
-            boundAddress: .init(context.channel.localAddress!)
-          )
-          var buffer = context.channel.allocator.buffer(capacity: 16)
-          buffer.writeServerResponse(response)
-          context.writeAndFlush(self.wrapOutboundOut(buffer), promise: nil)
-
-          context.fireUserInboundEventTriggered(SOCKSUserEvent.handshakeCompleted)
-
-          self.progress = .completed
-
-          // Prepare data that need forward to next handler.
-          if byteBuffer.readableBytes > 0 {
-            byteBuffer.discardReadBytes()
-            self.eventBuffer.append(.channelRead(data: self.wrapInboundOut(byteBuffer)))
-          }
-          self.flushBuffers(context: context)
-          context.pipeline.removeHandler(self, promise: nil)
-        case .failure:
-          let response: Response = .init(
-            reply: .hostUnreachable,
-            boundAddress: address
-          )
-          var buffer = context.channel.allocator.buffer(capacity: 16)
-          buffer.writeServerResponse(response)
-          context.writeAndFlush(self.wrapOutboundOut(buffer), promise: nil)
+  private func handleConnect(context: ChannelHandlerContext, address: NWEndpoint) {
+    completion(address).whenComplete {
+      switch $0 {
+      case .success:
+        // FIXME: SOCKS5 response
+        let response = Response(
+          reply: .succeeded,
+          boundAddress: .init(context.channel.localAddress!)
+        )
+        var buffer = context.channel.allocator.buffer(capacity: 16)
+        buffer.writeServerResponse(response)
+        context.writeAndFlush(self.wrapOutboundOut(buffer), promise: nil)
+
+        context.fireUserInboundEventTriggered(SOCKSUserEvent.handshakeCompleted)
+
+        self.progress = .completed
+
+        // Forward data that arrived after the request to next handler in one read.
+        let byteBuffer = self.cumulationBuffer
+        self.cumulationBuffer = nil
+        if let byteBuffer, byteBuffer.readableBytes > 0 {
+          context.fireChannelRead(self.wrapInboundOut(byteBuffer))
+          context.fireChannelReadComplete()
         }
+        context.pipeline.removeHandler(self, promise: nil)
+      case .failure:
+        self.fail(context: context, reply: .hostUnreachable, address: address)
       }
-    } catch {
-      channelClose(context: context, reason: error)
-      return
     }
   }
 
-  private func flushBuffers(context: ChannelHandlerContext) {
-    while !eventBuffer.isEmpty {
-      switch eventBuffer.removeFirst() {
-      case .channelRead(let data):
-        context.fireChannelRead(data)
-      case .channelReadComplete:
-        context.fireChannelReadComplete()
+  private func handleUDPAssociate(context: ChannelHandlerContext, address: NWEndpoint) {
+    udpAssociation!(address).whenComplete {
+      switch $0 {
+      case .success(let relayAddress):
+        let response = Response(reply: .succeeded, boundAddress: .init(relayAddress))
+        var buffer = context.channel.allocator.buffer(capacity: 22)
+        buffer.writeServerResponse(response)
+        context.writeAndFlush(self.wrapOutboundOut(buffer), promise: nil)
+
+        context.fireUserInboundEventTriggered(SOCKSUserEvent.handshakeCompleted)
+
+        // The connection only keeps the association alive, nothing is relayed over it.
+        self.progress = .completed
+        self.cumulationBuffer = nil
+        context.pipeline.removeHandler(self, promise: nil)
+      case .failure:
+        self.fail(context: context, reply: .generalSOCKSServerFailure, address: address)
       }
     }
   }
 
+  /// Reply the failure of the request and close the connection.
+  private func fail(context: ChannelHandlerContext, reply: Response.Reply, address: NWEndpoint) {
+    let response: Response = .init(
+      reply: reply,
+      boundAddress: address
+    )
+    var buffer = context.channel.allocator.buffer(capacity: 16)
+    buffer.writeServerResponse(response)
+    context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+
+    progress = .failed
+    cumulationBuffer = nil
+    context.close(promise: nil)
+  }
+
   private func channelClose(context: ChannelHandlerContext, reason: Error) {
     context.fireErrorCaught(reason)
     context.close(promise: nil)
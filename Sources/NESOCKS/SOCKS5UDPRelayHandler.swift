@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import _NELinux
+
+/// Relays the datagrams of one SOCKS5 UDP ASSOCIATE between the client and its targets.
+///
+/// Add this handler to a datagram channel bound to the address replied to the UDP ASSOCIATE
+/// request. Datagrams from the client have their RFC 1928 UDP request header stripped and are
+/// sent to the target, datagrams from anywhere else are sent back to the client with the header
+/// of their source. The association must be closed together with its TCP connection.
+///
+/// Relayed writes are flushed once per read burst. With
+/// `ChannelOptions.datagramVectorReadMessageCount` set on the channel, a burst is received with
+/// one vectored read and relayed with one vectored write.
+///
+/// Only IP targets are relayed, datagrams to domain names are dropped because they need resolving.
+final public class SOCKS5UDPRelayHandler: ChannelInboundHandler {
+
+  public typealias InboundIn = AddressedEnvelope<ByteBuffer>
+
+  public typealias OutboundOut = AddressedEnvelope<ByteBuffer>
+
+  /// The IP address of the client, datagrams from it are relayed to their targets.
+  private let clientIPAddress: String?
+
+  /// The address of the client, known once the client sent its first datagram.
+  private var clientAddress: SocketAddress?
+
+  /// A boolean value determines whether datagrams were written since the last flush.
+  private var needsFlush = false
+
+  /// Initialize an instance of `SOCKS5UDPRelayHandler` with specified `clientAddress`.
+  /// - Parameter clientAddress: The remote address of the TCP connection that requested the
+  ///   association, only datagrams from its IP address are accepted from the client.
+  public init(clientAddress: SocketAddress) {
+    self.clientIPAddress = clientAddress.ipAddress
+  }
+
+  public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    let envelope = unwrapInboundIn(data)
+
+    if let clientAddress, envelope.remoteAddress != clientAddress {
+      relayToClient(context: context, envelope: envelope, clientAddress: clientAddress)
+      return
+    }
+
+    guard envelope.remoteAddress.ipAddress == clientIPAddress else {
+      return
+    }
+    clientAddress = envelope.remoteAddress
+    relayToTarget(context: context, envelope: envelope)
+  }
+
+  public func channelReadComplete(context: ChannelHandlerContext) {
+    if needsFlush {
+      needsFlush = false
+      context.flush()
+    }
+    context.fireChannelReadComplete()
+  }
+
+  private func relayToTarget(
+    context: ChannelHandlerContext,
+    envelope: AddressedEnvelope<ByteBuffer>
+  ) {
+    var byteBuffer = envelope.data
+    guard let datagram = try? byteBuffer.readDatagram(),
+      let remoteAddress = SocketAddress(datagram.endpoint)
+    else {
+      return
+    }
+    write(context: context, to: remoteAddress, data: datagram.data)
+  }
+
+  private func relayToClient(
+    context: ChannelHandlerContext,
+    envelope: AddressedEnvelope<ByteBuffer>,
+    clientAddress: SocketAddress
+  ) {
+    let datagram = SOCKS5Datagram(endpoint: .init(envelope.remoteAddress), data: envelope.data)
+
+    // [RSV, FRAG, ATYP, DST.ADDR, DST.PORT] of an IP address.
+    let capacity = 2 + 1 + 1 + 16 + 2 + datagram.data.readableBytes
+    var byteBuffer = context.channel.allocator.buffer(capacity: capacity)
+    byteBuffer.writeDatagram(datagram)
+    write(context: context, to: clientAddress, data: byteBuffer)
+  }
+
+  private func write(
+    context: ChannelHandlerContext,
+    to remoteAddress: SocketAddress,
+    data: ByteBuffer
+  ) {
+    needsFlush = true
+    let envelope = AddressedEnvelope(remoteAddress: remoteAddress, data: data)
+    context.write(wrapOutboundOut(envelope), promise: nil)
+  }
+}
+
+@available(*, unavailable)
+extension SOCKS5UDPRelayHandler: Sendable {}
@@ -12,6 +12,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import NEAEAD
+
 /// Shadowsocks crypto algorithm.
 ///
 /// We don't care about rawValue is uppercase or lowercase for example:
@@ -35,3 +37,18 @@ public enum Algorithm: String, CaseIterable, Equatable, Hashable, Sendable {
     }
   }
 }
+
+extension Algorithm {
+
+  /// The AEAD algorithm of the `ChunkSealer` that seals and opens chunks of this algorithm.
+  var chunkSealerAlgorithm: ChunkSealer.Algorithm {
+    switch self {
+    case .aes128Gcm:
+      return .aes128Gcm
+    case .aes256Gcm:
+      return .aes256Gcm
+    case .chaCha20Poly1305:
+      return .chaCha20Poly1305
+    }
+  }
+}
@@ -1 +0,0 @@
-../NESOCKS/ByteBuffer+NWEndpoint.swift
\ No newline at end of file
@@ -51,6 +51,41 @@ extension ChannelPipeline {
       )
     }
   }
+
+  /// Configure a datagram `ChannelPipeline` for use as a Shadowsocks UDP relay client.
+  /// - Parameters:
+  ///   - position: The position in the `ChannelPipeline` where to add the Shadowsocks UDP relay handlers. Defaults to `.last`.
+  ///   - algorithm: The algorithm to use to encrypt/decript datagrams for this channel.
+  ///   - passwordReference: The passwordReference to use to generate symmetric key for datagram encription/decryption.
+  ///   - serverAddress: The address of the Shadowsocks server to relay datagrams through.
+  /// - Returns: An `EventLoopFuture` that will fire when the pipeline is configured.
+  public func addSSDatagramClientHandlers(
+    position: Position = .last,
+    algorithm: Algorithm,
+    passwordReference: String,
+    serverAddress: SocketAddress
+  ) -> EventLoopFuture<Void> {
+
+    guard eventLoop.inEventLoop else {
+      return eventLoop.submit {
+        try self.syncOperations.addSSDatagramClientHandlers(
+          position: position,
+          algorithm: algorithm,
+          passwordReference: passwordReference,
+          serverAddress: serverAddress
+        )
+      }
+    }
+
+    return eventLoop.makeCompletedFuture {
+      try syncOperations.addSSDatagramClientHandlers(
+        position: position,
+        algorithm: algorithm,
+        passwordReference: passwordReference,
+        serverAddress: serverAddress
+      )
+    }
+  }
 }
 
 extension ChannelPipeline.SynchronousOperations {
@@ -81,4 +116,34 @@ extension ChannelPipeline.SynchronousOperations {
     let handlers: [ChannelHandler] = [ByteToMessageHandler(inboundDecoder), outboundHandler]
     try addHandlers(handlers, position: position)
   }
+
+  /// Configure a datagram `ChannelPipeline` for use as a Shadowsocks UDP relay client.
+  ///
+  /// The pipeline reads and writes `SSDatagram`, every datagram is sealed into one UDP packet
+  /// sent to `serverAddress`.
+  /// - Parameters:
+  ///   - position: The position in the `ChannelPipeline` where to add the Shadowsocks UDP relay handlers. Defaults to `.last`.
+  ///   - algorithm: The algorithm to use to encrypt/decript datagrams for this channel.
+  ///   - passwordReference: The passwordReference to use to generate symmetric key for datagram encription/decryption.
+  ///   - serverAddress: The address of the Shadowsocks server to relay datagrams through.
+  /// - Throws: If the pipeline could not be configured.
+  public func addSSDatagramClientHandlers(
+    position: ChannelPipeline.Position = .last,
+    algorithm: Algorithm,
+    passwordReference: String,
+    serverAddress: SocketAddress
+  ) throws {
+    eventLoop.assertInEventLoop()
+    let inboundDecoder = DatagramResponseDecoder(
+      algorithm: algorithm,
+      passwordReference: passwordReference
+    )
+    let outboundHandler = DatagramRequestEncoder(
+      algorithm: algorithm,
+      passwordReference: passwordReference,
+      serverAddress: serverAddress
+    )
+    let handlers: [ChannelHandler] = [inboundDecoder, outboundHandler]
+    try addHandlers(handlers, position: position)
+  }
 }
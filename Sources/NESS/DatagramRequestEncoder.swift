@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+import NEAEAD
+import NEPrettyBytes
+import NIOCore
+import _NELinux
+
+/// Relays datagrams through a Shadowsocks server.
+///
+/// Every `SSDatagram` is sealed independently into one UDP packet with the structure:
+///
+///      [salt][encrypted payload][tag]
+///
+/// where the payload is the RFC 1928 address of `SSDatagram.endpoint` followed by
+/// `SSDatagram.data`, encrypted with a subkey derived from a random salt and a nonce with all zero
+/// bytes.
+final public class DatagramRequestEncoder: ChannelOutboundHandler {
+
+  public typealias OutboundIn = SSDatagram
+
+  public typealias OutboundOut = AddressedEnvelope<ByteBuffer>
+
+  private let algorithm: Algorithm
+
+  private let passwordReference: String
+
+  private let serverAddress: SocketAddress
+
+  /// Initialize an instance of `DatagramRequestEncoder` with specified `algorithm`,
+  /// `passwordReference` and `serverAddress`.
+  /// - Parameters:
+  ///   - algorithm: The algorithm to use to encrypt datagrams.
+  ///   - passwordReference: The password to use to generate symmetric key for encryptor.
+  ///   - serverAddress: The address of the Shadowsocks server to send the datagrams to.
+  public init(algorithm: Algorithm, passwordReference: String, serverAddress: SocketAddress) {
+    self.algorithm = algorithm
+    self.passwordReference = passwordReference
+    self.serverAddress = serverAddress
+  }
+
+  public func write(context: ChannelHandlerContext, data: NIOAny, promise: EventLoopPromise<Void>?)
+  {
+    do {
+      let datagram = unwrapOutboundIn(data)
+      let saltByteCount = algorithm.saltByteCount
+
+      // The largest RFC 1928 address is a domain name of 255 bytes.
+      let maximumAddressByteCount = 1 + 1 + 255 + 2
+      var byteBuffer = context.channel.allocator.buffer(
+        capacity: saltByteCount + maximumAddressByteCount + datagram.data.readableBytes
+          + ChunkSealer.tagByteCount
+      )
+      byteBuffer.writeWithUnsafeMutableBytes(minimumWritableBytes: saltByteCount) {
+        UnsafeMutableRawBufferPointer(rebasing: $0.prefix(saltByteCount))
+          .initializeWithRandomBytes(count: saltByteCount)
+        return saltByteCount
+      }
+
+      // Write the plaintext after the salt followed by room for the tag, and encrypt it in
+      // place, the ciphertext of AEAD ciphers is exactly as long as the plaintext.
+      byteBuffer.writeEndpointInRFC1928RequestAddressFormat(datagram.endpoint)
+      byteBuffer.writeImmutableBuffer(datagram.data)
+      byteBuffer.writeRepeatingByte(0, count: ChunkSealer.tagByteCount)
+      try byteBuffer.withUnsafeMutableReadableBytes {
+        try algorithm.sealDatagram($0, passwordReference: passwordReference)
+      }
+
+      let envelope = AddressedEnvelope(remoteAddress: serverAddress, data: byteBuffer)
+      context.write(wrapOutboundOut(envelope), promise: promise)
+    } catch {
+      promise?.fail(error)
+      context.fireErrorCaught(error)
+    }
+  }
+}
+
+@available(*, unavailable)
+extension DatagramRequestEncoder: Sendable {}
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NEAEAD
+import NIOCore
+import _NELinux
+
+/// Receives datagrams relayed through a Shadowsocks server.
+///
+/// Every UDP packet is opened independently into one `SSDatagram` whose `endpoint` is the source
+/// the server received the datagram from. Packets that fail to open are reported with
+/// `fireErrorCaught(_:)` and dropped, without closing the channel.
+///
+/// Per-packet setup costs only the HKDF subkey derivation, the master key is cached. Enable
+/// `ChannelOptions.datagramVectorReadMessageCount` on the channel to receive packets in batches.
+final public class DatagramResponseDecoder: ChannelInboundHandler {
+
+  public typealias InboundIn = AddressedEnvelope<ByteBuffer>
+
+  public typealias InboundOut = SSDatagram
+
+  private let algorithm: Algorithm
+
+  private let passwordReference: String
+
+  /// Initialize an instance of `DatagramResponseDecoder` with specified `algorithm` and
+  /// `passwordReference`.
+  /// - Parameters:
+  ///   - algorithm: The algorithm use to decrypt datagrams.
+  ///   - passwordReference: The password use to generate symmetric key for decryptor.
+  public init(algorithm: Algorithm, passwordReference: String) {
+    self.algorithm = algorithm
+    self.passwordReference = passwordReference
+  }
+
+  public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    let envelope = unwrapInboundIn(data)
+    do {
+      let payloadByteCount =
+        envelope.data.readableBytes - algorithm.saltByteCount - ChunkSealer.tagByteCount
+      guard payloadByteCount >= 0 else {
+        throw SSError.malformedDatagram
+      }
+      // Open the payload straight into the buffer that is fired.
+      var byteBuffer = context.channel.allocator.buffer(capacity: payloadByteCount)
+      try envelope.data.withUnsafeReadableBytes { datagram in
+        try byteBuffer.writeWithUnsafeMutableBytes(minimumWritableBytes: payloadByteCount) {
+          try algorithm.openDatagram(
+            datagram,
+            into: UnsafeMutableRawBufferPointer(rebasing: $0.prefix(payloadByteCount)),
+            passwordReference: passwordReference
+          )
+          return payloadByteCount
+        }
+      }
+      guard let endpoint = try byteBuffer.readRFC1928RequestAddressAsEndpoint() else {
+        throw SSError.malformedDatagram
+      }
+      context.fireChannelRead(wrapInboundOut(SSDatagram(endpoint: endpoint, data: byteBuffer)))
+    } catch {
+      context.fireErrorCaught(error)
+    }
+  }
+}
+
+@available(*, unavailable)
+extension DatagramResponseDecoder: Sendable {}
@@ -14,30 +14,76 @@
 
 import Crypto
 import Foundation
+import NIOConcurrencyHelpers
 
 /// Generate key like `Evp_BytesToKey`.
 /// - Parameters:
 ///   - secretKey: user input secretKey
 ///   - outputByteCount: key length for deliver key.
-///   - saltByteCount: salt length for deliver key.
 /// - Returns: hash result
-@inline(__always)
-private func bytesToKey(_ secretKey: String, saltByteCount: Int, outputByteCount: Int) -> [UInt8] {
-  var i = 0
+private func bytesToKey(_ secretKey: String, outputByteCount: Int) -> [UInt8] {
+  let bytes = Array(secretKey.utf8)
   var initialResult: [UInt8] = []
-  var partialResult: [UInt8] = []
-  while initialResult.count < outputByteCount + saltByteCount {
-    var bytes = Array(secretKey.utf8)
-    if i > 0 {
-      bytes = partialResult + bytes
+  initialResult.reserveCapacity(outputByteCount + Insecure.MD5Digest.byteCount)
+  var partialResult: Insecure.MD5.Digest?
+  while initialResult.count < outputByteCount {
+    // D_i = MD5(D_(i-1) || secretKey), hashed incrementally instead of concatenating.
+    var md5 = Insecure.MD5()
+    if let partialResult {
+      partialResult.withUnsafeBytes { md5.update(bufferPointer: $0) }
     }
-    partialResult = Array(Insecure.MD5.hash(data: bytes))
-    initialResult.append(contentsOf: partialResult)
-    i += 1
+    md5.update(data: bytes)
+    let digest = md5.finalize()
+    initialResult.append(contentsOf: digest)
+    partialResult = digest
   }
   return Array(initialResult.prefix(outputByteCount))
 }
 
+/// A thread-safe cache of Shadowsocks master keys keyed by password and key size.
+///
+/// The master key depends only on the password and the key size of the algorithm, so it is
+/// derived once instead of once per connection, leaving only the HKDF subkey derivation per
+/// connection. The cache is cleared when it grows beyond `capacity`, which bounds its memory
+/// when passwords churn.
+final class MasterKeyCache: Sendable {
+
+  private struct Key: Hashable {
+    var secretKey: String
+    var outputByteCount: Int
+  }
+
+  /// The cache shared by all Shadowsocks encoders and decoders.
+  static let shared = MasterKeyCache()
+
+  private let capacity: Int
+  private let storage = NIOLockedValueBox<[Key: SymmetricKey]>([:])
+
+  init(capacity: Int = 64) {
+    self.capacity = capacity
+  }
+
+  /// Returns the master key of `secretKey` of `outputByteCount` bytes, deriving it on first use.
+  func masterKey(secretKey: String, outputByteCount: Int) -> SymmetricKey {
+    let key = Key(secretKey: secretKey, outputByteCount: outputByteCount)
+    if let masterKey = storage.withLockedValue({ $0[key] }) {
+      return masterKey
+    }
+
+    // Derive outside of the lock, racing derivations produce equal keys.
+    let masterKey = SymmetricKey(
+      data: bytesToKey(secretKey, outputByteCount: outputByteCount)
+    )
+    storage.withLockedValue {
+      if $0.count >= capacity {
+        $0.removeAll(keepingCapacity: true)
+      }
+      $0[key] = masterKey
+    }
+    return masterKey
+  }
+}
+
 ///
 /// Key Derivation
 ///
@@ -57,8 +103,9 @@ func hkdfDerivedSymmetricKey<Salt: DataProtocol>(
   salt: Salt,
   outputByteCount: Int
 ) -> SymmetricKey {
-  let inputKeyMaterial = SymmetricKey(
-    data: bytesToKey(secretKey, saltByteCount: salt.count, outputByteCount: outputByteCount)
+  let inputKeyMaterial = MasterKeyCache.shared.masterKey(
+    secretKey: secretKey,
+    outputByteCount: outputByteCount
   )
   let info = Data("ss-subkey".utf8)
 
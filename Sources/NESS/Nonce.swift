@@ -12,6 +12,58 @@
 //
 //===----------------------------------------------------------------------===//
 
+import Crypto
+
+/// The counting nonce of a Shadowsocks AEAD stream.
+///
+/// The 12 nonce bytes are stored inline as a little-endian `UInt64` followed by a little-endian
+/// `UInt32`, so incrementing the nonce is an addition with carry instead of rebuilding an array,
+/// and creating an `AES.GCM.Nonce` or `ChaChaPoly.Nonce` from it never allocates.
+struct CountingNonce: ContiguousBytes, Equatable, Sendable {
+
+  private var low: UInt64
+
+  private var high: UInt32
+
+  /// Creates a nonce whose little-endian value is `high << 64 | low`, all zero bytes by default.
+  init(low: UInt64 = 0, high: UInt32 = 0) {
+    self.low = low
+    self.high = high
+  }
+
+  /// Increment nonce as if it were an unsigned little-endian integer, like `sodium_increment(_:)`.
+  mutating func increment() {
+    let (partialValue, overflow) = low.addingReportingOverflow(1)
+    low = partialValue
+    if overflow {
+      high &+= 1
+    }
+  }
+
+  func withUnsafeBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+    try Swift.withUnsafeBytes(of: (low.littleEndian, high.littleEndian)) {
+      assert($0.count == 12)
+      return try body($0)
+    }
+  }
+}
+
+extension AES.GCM.Nonce {
+
+  init(_ nonce: CountingNonce) {
+    // A counting nonce is always 12 bytes, which is valid for AES-GCM.
+    self = nonce.withUnsafeBytes { try! AES.GCM.Nonce(data: $0) }
+  }
+}
+
+extension ChaChaPoly.Nonce {
+
+  init(_ nonce: CountingNonce) {
+    // A counting nonce is always 12 bytes, which is valid for ChaCha20-Poly1305.
+    self = nonce.withUnsafeBytes { try! ChaChaPoly.Nonce(data: $0) }
+  }
+}
+
 extension Array where Element == UInt8 {
 
   /// Increment array like `sodium_increment(_:)`
@@ -19,10 +71,10 @@ extension Array where Element == UInt8 {
   mutating func increment(_ length: Int) {
     var c: UInt16 = 1
 
-    self = self.map { e in
-      c += UInt16(e)
-      defer { c >>= 8 }
-      return UInt8(truncatingIfNeeded: c)
+    for i in indices.prefix(length) {
+      c += UInt16(self[i])
+      self[i] = UInt8(truncatingIfNeeded: c)
+      c >>= 8
     }
   }
 }
@@ -14,6 +14,7 @@
 
 import Crypto
 import Foundation
+import NEAEAD
 import NEPrettyBytes
 import NIOCore
 import _NELinux
@@ -25,15 +26,22 @@ final public class RequestEncoder: ChannelOutboundHandler {
 
   public typealias OutboundOut = ByteBuffer
 
+  /// Payload length is capped at 0x3FFF, the higher two bits of the length field are reserved.
+  private static let maximumPayloadSize = 0x3FFF
+
+  /// The payload size of one output buffer, larger writes are split into several buffers.
+  private static let maximumBufferPayloadSize = 4 * maximumPayloadSize
+
   private let algorithm: Algorithm
 
   private let passwordReference: String
 
   private let destinationAddress: NWEndpoint
 
-  private var symmetricKey: SymmetricKey?
+  /// The sealer keyed with the subkey of this connection, set up with the salt.
+  private var sealer: ChunkSealer?
 
-  private var nonce: [UInt8]?
+  private var nonce = CountingNonce()
 
   /// Initialize an instance of `RequestEncoder` with specified `algorithm`, `passwordReference` and `destinationAddress`.
   /// - Parameters:
@@ -49,96 +57,115 @@ final public class RequestEncoder: ChannelOutboundHandler {
   public func write(context: ChannelHandlerContext, data: NIOAny, promise: EventLoopPromise<Void>?)
   {
     do {
-      if symmetricKey == nil {
+      var unwrapped = unwrapOutboundIn(data)
+
+      var payloadSize = min(unwrapped.readableBytes, Self.maximumBufferPayloadSize)
+      var byteBuffer: ByteBuffer
+
+      if sealer == nil {
         let byteCount = algorithm == .aes128Gcm ? 16 : 32
         var saltBytes = Array(repeating: UInt8.zero, count: byteCount)
         saltBytes.withUnsafeMutableBytes {
           $0.initializeWithRandomBytes(count: byteCount)
         }
-        nonce = .init(repeating: 0, count: 12)
-        symmetricKey = hkdfDerivedSymmetricKey(
-          secretKey: passwordReference,
-          salt: saltBytes,
-          outputByteCount: byteCount
-        )
-
-        // An AEAD encrypted TCP stream starts with a randomly generated salt to derive the per-session subkey.
-        context.write(
-          wrapOutboundOut(context.channel.allocator.buffer(bytes: saltBytes)),
-          promise: promise
+        nonce = CountingNonce()
+        sealer = try ChunkSealer(
+          algorithm: algorithm.chunkSealerAlgorithm,
+          key: hkdfDerivedSymmetricKey(
+            secretKey: passwordReference,
+            salt: saltBytes,
+            outputByteCount: byteCount
+          )
         )
 
         // Prepare address data.
-        var byteBuffer = context.channel.allocator.buffer(capacity: 36)
-        byteBuffer.writeEndpointInRFC1928RequestAddressFormat(destinationAddress)
-        let message = byteBuffer.readBytes(length: byteBuffer.readableBytes) ?? []
-
-        // Prepare address size data
-        byteBuffer.writeInteger(UInt16(message.count))
-        let sizeBytes = byteBuffer.readBytes(length: byteBuffer.readableBytes) ?? []
+        var address = context.channel.allocator.buffer(capacity: 36)
+        address.writeEndpointInRFC1928RequestAddressFormat(destinationAddress)
 
-        byteBuffer.discardReadBytes()
-
-        byteBuffer.writeBytes(try process(message: sizeBytes))
-        byteBuffer.writeBytes(try process(message: message))
+        byteBuffer = context.channel.allocator.buffer(
+          capacity: byteCount
+            + Self.sealedSize(payloadSize: address.readableBytes)
+            + Self.sealedSize(payloadSize: payloadSize)
+        )
 
-        context.write(wrapOutboundOut(byteBuffer), promise: promise)
+        // An AEAD encrypted TCP stream starts with a randomly generated salt to derive the per-session subkey.
+        byteBuffer.writeBytes(saltBytes)
+        try sealChunk(address, into: &byteBuffer)
+      } else {
+        byteBuffer = context.channel.allocator.buffer(
+          capacity: Self.sealedSize(payloadSize: payloadSize)
+        )
       }
 
-      var unwrapped = unwrapOutboundIn(data)
-
-      // Encrypt and write trucks to server.
-      while unwrapped.readableBytes > 0 {
-        let maxLength = unwrapped.readableBytes & 0x3FFF
-        if let message = unwrapped.readBytes(length: maxLength) {
-          var byteBuffer = context.channel.allocator.buffer(
-            capacity: MemoryLayout<UInt16>.size
-          )
-          byteBuffer.writeInteger(UInt16(message.count))
-          let sizeBytes = byteBuffer.readBytes(length: byteBuffer.readableBytes) ?? []
-
-          byteBuffer.discardReadBytes()
-
-          byteBuffer.writeBytes(try process(message: sizeBytes))
-          byteBuffer.writeBytes(try process(message: message))
+      // Encrypt and write trucks to server. Large writes are split into several buffers, the
+      // channel gathers them into one vectored write on flush.
+      while true {
+        var payload = unwrapped.readSlice(length: payloadSize)!
+        while payload.readableBytes > 0 {
+          let chunk = payload.readSlice(
+            length: min(Self.maximumPayloadSize, payload.readableBytes)
+          )!
+          try sealChunk(chunk, into: &byteBuffer)
+        }
 
-          context.write(wrapOutboundOut(byteBuffer), promise: promise)
+        guard unwrapped.readableBytes > 0 else {
+          break
         }
+        context.write(wrapOutboundOut(byteBuffer), promise: nil)
+
+        payloadSize = min(unwrapped.readableBytes, Self.maximumBufferPayloadSize)
+        byteBuffer = context.channel.allocator.buffer(
+          capacity: Self.sealedSize(payloadSize: payloadSize)
+        )
       }
+
+      context.write(wrapOutboundOut(byteBuffer), promise: promise)
     } catch {
+      promise?.fail(error)
       context.fireErrorCaught(error)
     }
   }
 
-  /// Process message into structure [ciphertext][tag].
-  /// - Parameter message: the plaintext waiting to encrypt which confirm to `DataProtocol`
-  private func process<Plaintext>(message: Plaintext) throws -> Data where Plaintext: DataProtocol {
-    var bytes: Data = .init()
-    guard let symmetricKey, let nonce else {
-      return bytes
+  /// Returns the size of the chunks that carry `payloadSize` bytes.
+  private static func sealedSize(payloadSize: Int) -> Int {
+    let chunkCount = (payloadSize + maximumPayloadSize - 1) / maximumPayloadSize
+    return payloadSize + chunkCount * (MemoryLayout<UInt16>.size + 2 * ChunkSealer.tagByteCount)
+  }
+
+  /// Seal `payload` as one chunk and append it to `byteBuffer`.
+  ///
+  /// A chunk has the structure:
+  ///
+  ///      [encrypted payload length][length tag][encrypted payload][payload tag]
+  private func sealChunk(_ payload: ByteBuffer, into byteBuffer: inout ByteBuffer) throws {
+    assert(payload.readableBytes <= Self.maximumPayloadSize)
+    try withUnsafeBytes(of: UInt16(payload.readableBytes).bigEndian) {
+      try seal(message: $0, into: &byteBuffer)
+    }
+    try payload.withUnsafeReadableBytes {
+      try seal(message: $0, into: &byteBuffer)
     }
+  }
 
-    switch algorithm {
-    case .aes128Gcm, .aes256Gcm:
-      let sealedBox = try AES.GCM.seal(
-        message,
-        using: symmetricKey,
-        nonce: .init(data: nonce)
-      )
-      bytes.append(sealedBox.ciphertext)
-      bytes.append(sealedBox.tag)
-    case .chaCha20Poly1305:
-      let sealedBox = try ChaChaPoly.seal(
-        message,
-        using: symmetricKey,
-        nonce: .init(data: nonce)
-      )
-      bytes.append(sealedBox.ciphertext)
-      bytes.append(sealedBox.tag)
+  /// Seal message into structure [ciphertext][tag] straight into the writable bytes of
+  /// `byteBuffer`.
+  /// - Parameters:
+  ///   - message: The plaintext waiting to encrypt, it must not be stored in `byteBuffer`.
+  ///   - byteBuffer: The buffer to write the sealed message to.
+  private func seal(message: UnsafeRawBufferPointer, into byteBuffer: inout ByteBuffer) throws {
+    guard let sealer else {
+      return
+    }
+
+    let sealedByteCount = message.count + ChunkSealer.tagByteCount
+    try byteBuffer.writeWithUnsafeMutableBytes(minimumWritableBytes: sealedByteCount) { output in
+      try nonce.withUnsafeBytes {
+        try sealer.seal(message, into: output, nonce: $0)
+      }
+      return sealedByteCount
     }
 
-    self.nonce?.increment(nonce.count)
-    return bytes
+    nonce.increment()
   }
 }
 
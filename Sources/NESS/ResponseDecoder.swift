@@ -13,7 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 import Crypto
-import Foundation
+import NEAEAD
 import NIOCore
 
 ///
@@ -45,6 +45,12 @@ import NIOCore
 ///
 ///
 
+private enum ResponseDecodingState {
+  case saltBegin
+  case lengthBegin
+  case payloadBegin(length: Int)
+}
+
 final public class ResponseDecoder: ByteToMessageDecoder {
 
   public typealias InboundOut = ByteBuffer
@@ -53,80 +59,151 @@ final public class ResponseDecoder: ByteToMessageDecoder {
 
   private let passwordReference: String
 
-  private var symmetricKey: SymmetricKey?
+  /// The opener keyed with the subkey of this connection, set up with the salt.
+  private var opener: ChunkSealer?
+
+  private var nonce = CountingNonce()
 
-  private var nonce: [UInt8]
+  private var decodingState: ResponseDecodingState = .saltBegin
+
+  private let maximumCoalescedReadBytes: Int?
+
+  /// The chunks decoded in the current decode pass and not fired yet.
+  private var coalescedOutput: ByteBuffer?
 
   /// Initialize an instance of `ResponseDecoder` with specified `algorithm` and `passwordReference`.
   /// - Parameters:
   ///   - algorithm: The algorithm use to decrypt response message.
   ///   - passwordReference: The password use to generate symmetric key for message decryptor.
-  public init(algorithm: Algorithm, passwordReference: String) {
+  ///   - maximumCoalescedReadBytes: If not `nil`, every complete chunk available in one decode
+  ///     pass is decoded into one buffer of at most this many bytes, which is fired once when the
+  ///     pass runs out of data, instead of firing one read per chunk. Defaults to `nil`.
+  public init(
+    algorithm: Algorithm,
+    passwordReference: String,
+    maximumCoalescedReadBytes: Int? = nil
+  ) {
+    precondition(
+      maximumCoalescedReadBytes.map { $0 > 0 } ?? true,
+      "maximumCoalescedReadBytes must be positive"
+    )
     self.algorithm = algorithm
     self.passwordReference = passwordReference
-    self.nonce = .init(repeating: 0, count: 12)
+    self.maximumCoalescedReadBytes = maximumCoalescedReadBytes
   }
 
   public func decode(context: ChannelHandlerContext, buffer: inout ByteBuffer) throws
     -> DecodingState
   {
-    // Record data for fallback if buffer is not enough to decode as message.
-    let fallbackNonce = nonce
-    let fallbackBuffer = buffer
-
-    // Decode salt from first packet.
-    if symmetricKey == nil {
+    switch decodingState {
+    case .saltBegin:
+      // Decode salt from first packet.
       let saltByteCount = algorithm == .aes128Gcm ? 16 : 32
       let keyByteCount = algorithm == .aes128Gcm ? 16 : 32
-      guard buffer.readableBytes >= saltByteCount else {
-        return .needMoreData
+      guard let salt = buffer.readSlice(length: saltByteCount) else {
+        return needMoreData(context: context)
       }
-      let salt = buffer.readBytes(length: saltByteCount) ?? []
-      symmetricKey = hkdfDerivedSymmetricKey(
-        secretKey: passwordReference,
-        salt: salt,
-        outputByteCount: keyByteCount
+      opener = try ChunkSealer(
+        algorithm: algorithm.chunkSealerAlgorithm,
+        key: hkdfDerivedSymmetricKey(
+          secretKey: passwordReference,
+          salt: salt.readableBytesView,
+          outputByteCount: keyByteCount
+        )
       )
+      decodingState = .lengthBegin
+      return continueDecoding(buffer, context: context)
+    case .lengthBegin:
+      // Check if data is enough to decode as size message.
+      guard let message = buffer.readSlice(length: 2 + ChunkSealer.tagByteCount) else {
+        return needMoreData(context: context)
+      }
+      // Payload length is a 2-byte big-endian unsigned integer.
+      var length = UInt16.zero
+      try withUnsafeMutableBytes(of: &length) {
+        try open(message: message, into: $0)
+      }
+      decodingState = .payloadBegin(length: Int(UInt16(bigEndian: length)))
+      return continueDecoding(buffer, context: context)
+    case .payloadBegin(let length):
+      // Check if buffer is enougth to decode as response message.
+      guard let message = buffer.readSlice(length: length + ChunkSealer.tagByteCount) else {
+        return needMoreData(context: context)
+      }
+      var byteBuffer = context.channel.allocator.buffer(capacity: length)
+      try byteBuffer.writeWithUnsafeMutableBytes(minimumWritableBytes: length) {
+        try open(message: message, into: UnsafeMutableRawBufferPointer(rebasing: $0.prefix(length)))
+        return length
+      }
+      decodingState = .lengthBegin
+      if let maximumCoalescedReadBytes {
+        coalesce(byteBuffer, maximumBytes: maximumCoalescedReadBytes, context: context)
+      } else {
+        context.fireChannelRead(wrapInboundOut(byteBuffer))
+      }
+      return continueDecoding(buffer, context: context)
     }
+  }
 
-    let tagByteCount = 16
-    let trunkSize = 2
-    var readLength = trunkSize + tagByteCount
-    // Check if data is enough to decode as size message.
-    guard buffer.readableBytes > readLength else {
-      return .needMoreData
-    }
-    var byteBuffer = try process(message: buffer.readBytes(length: readLength) ?? [], on: context)
-    let size = byteBuffer.readInteger(as: UInt16.self)
-
-    // Check if buffer is enougth to decode as response message.
-    guard let size = size, buffer.readableBytes >= Int(size) + tagByteCount else {
-      buffer = fallbackBuffer
-      nonce = fallbackNonce
-      return .needMoreData
+  /// Keep decoding while `buffer` has bytes left. `decode` is not called again on an empty
+  /// buffer, so the output of this pass must be fired before the buffer runs dry.
+  private func continueDecoding(
+    _ buffer: ByteBuffer,
+    context: ChannelHandlerContext
+  ) -> DecodingState {
+    guard buffer.readableBytes > 0 else {
+      return needMoreData(context: context)
     }
-    readLength = Int(size) + tagByteCount
-    byteBuffer = try process(message: buffer.readBytes(length: readLength) ?? [], on: context)
-    context.fireChannelRead(wrapInboundOut(byteBuffer))
     return .continue
   }
 
-  private func process(message: [UInt8], on context: ChannelHandlerContext) throws -> ByteBuffer {
-    var data: Data = .init()
-    let combined = nonce + message
+  /// Append `byteBuffer` to the pending output, firing the pending output first if `byteBuffer`
+  /// would make it exceed `maximumBytes`.
+  private func coalesce(
+    _ byteBuffer: ByteBuffer,
+    maximumBytes: Int,
+    context: ChannelHandlerContext
+  ) {
+    guard var output = coalescedOutput,
+      output.readableBytes + byteBuffer.readableBytes <= maximumBytes
+    else {
+      flushCoalescedOutput(context: context)
+      coalescedOutput = byteBuffer
+      return
+    }
+    // Drop the stored reference so appending does not copy the storage.
+    coalescedOutput = nil
+    var byteBuffer = byteBuffer
+    output.writeBuffer(&byteBuffer)
+    coalescedOutput = output
+  }
+
+  private func flushCoalescedOutput(context: ChannelHandlerContext) {
+    guard let output = coalescedOutput else {
+      return
+    }
+    coalescedOutput = nil
+    context.fireChannelRead(wrapInboundOut(output))
+  }
 
-    guard let symmetricKey else {
-      return context.channel.allocator.buffer(bytes: data)
+  /// Fire the output of this decode pass and wait for more data.
+  private func needMoreData(context: ChannelHandlerContext) -> DecodingState {
+    flushCoalescedOutput(context: context)
+    return .needMoreData
+  }
+
+  /// Open message of structure [ciphertext][tag] with the current nonce into `output`.
+  private func open(message: ByteBuffer, into output: UnsafeMutableRawBufferPointer) throws {
+    guard let opener else {
+      preconditionFailure("Chunks are opened only after the salt is decoded.")
     }
 
-    switch algorithm {
-    case .aes128Gcm, .aes256Gcm:
-      data = try AES.GCM.open(.init(combined: combined), using: symmetricKey)
-    case .chaCha20Poly1305:
-      data = try ChaChaPoly.open(.init(combined: combined), using: symmetricKey)
+    try message.withUnsafeReadableBytes { message in
+      try nonce.withUnsafeBytes {
+        try opener.open(message, into: output, nonce: $0)
+      }
     }
-    nonce.increment(nonce.count)
-    return context.channel.allocator.buffer(bytes: data)
+    nonce.increment()
   }
 }
 
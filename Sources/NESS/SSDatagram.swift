@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NEAEAD
+import NIOCore
+import _NELinux
+
+/// A datagram relayed through a Shadowsocks server.
+public struct SSDatagram: Hashable, Sendable {
+
+  /// The target to send the datagram to, or the source the datagram was received from.
+  public var endpoint: NWEndpoint
+
+  /// The payload of the datagram.
+  public var data: ByteBuffer
+
+  /// Initialize an instance of `SSDatagram` with specified `endpoint` and `data`.
+  public init(endpoint: NWEndpoint, data: ByteBuffer) {
+    self.endpoint = endpoint
+    self.data = data
+  }
+}
+
+extension Algorithm {
+
+  /// The salt size of this algorithm, equal to its key size.
+  var saltByteCount: Int {
+    self == .aes128Gcm ? 16 : 32
+  }
+
+  /// Seal datagram of structure [salt][payload][tag] in place, with the subkey derived from the
+  /// salt and a nonce with all zero bytes.
+  ///
+  /// The payload is overwritten by its ciphertext, which is exactly as long, and the tag is
+  /// written to the last `ChunkSealer.tagByteCount` bytes.
+  func sealDatagram(_ datagram: UnsafeMutableRawBufferPointer, passwordReference: String) throws {
+    precondition(datagram.count >= saltByteCount + ChunkSealer.tagByteCount)
+    let sealer = try datagramSealer(
+      salt: UnsafeRawBufferPointer(rebasing: datagram.prefix(saltByteCount)),
+      passwordReference: passwordReference
+    )
+    let output = UnsafeMutableRawBufferPointer(rebasing: datagram.dropFirst(saltByteCount))
+    let message = UnsafeRawBufferPointer(rebasing: output.dropLast(ChunkSealer.tagByteCount))
+    try CountingNonce().withUnsafeBytes {
+      try sealer.seal(message, into: output, nonce: $0)
+    }
+  }
+
+  /// Open datagram of structure [salt][encrypted payload][tag] into `output`, which holds
+  /// exactly the payload.
+  func openDatagram(
+    _ datagram: UnsafeRawBufferPointer,
+    into output: UnsafeMutableRawBufferPointer,
+    passwordReference: String
+  ) throws {
+    precondition(output.count == datagram.count - saltByteCount - ChunkSealer.tagByteCount)
+    let sealer = try datagramSealer(
+      salt: UnsafeRawBufferPointer(rebasing: datagram.prefix(saltByteCount)),
+      passwordReference: passwordReference
+    )
+    try CountingNonce().withUnsafeBytes {
+      try sealer.open(
+        UnsafeRawBufferPointer(rebasing: datagram.dropFirst(saltByteCount)),
+        into: output,
+        nonce: $0
+      )
+    }
+  }
+
+  /// Returns the sealer keyed with the subkey derived from `salt`.
+  private func datagramSealer(
+    salt: UnsafeRawBufferPointer,
+    passwordReference: String
+  ) throws -> ChunkSealer {
+    try ChunkSealer(
+      algorithm: chunkSealerAlgorithm,
+      key: hkdfDerivedSymmetricKey(
+        secretKey: passwordReference,
+        salt: salt,
+        outputByteCount: saltByteCount
+      )
+    )
+  }
+}
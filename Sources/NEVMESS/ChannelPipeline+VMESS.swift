@@ -27,12 +27,14 @@ extension ChannelPipeline {
   ///   - user: VMESS client ID.
   ///   - commandCode: Command code for VMESS request/response. Defaults to `.tcp`.
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - instrumentation: The instrumentation to report the chunks sealed and opened to. Defaults to `nil`.
   public func addVMESSClientHandlers(
     position: Position = .last,
     contentSecurity: ContentSecurity,
     user: UUID,
     commandCode: CommandCode = .tcp,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) -> EventLoopFuture<Void> {
     let eventLoopFuture: EventLoopFuture<Void>
 
@@ -43,7 +45,8 @@ extension ChannelPipeline {
           contentSecurity: contentSecurity,
           user: user,
           commandCode: commandCode,
-          destinationAddress: destinationAddress
+          destinationAddress: destinationAddress,
+          instrumentation: instrumentation
         )
       }
       eventLoopFuture = eventLoop.makeCompletedFuture(result)
@@ -54,7 +57,52 @@ extension ChannelPipeline {
           contentSecurity: contentSecurity,
           user: user,
           commandCode: commandCode,
-          destinationAddress: destinationAddress
+          destinationAddress: destinationAddress,
+          instrumentation: instrumentation
+        )
+      }
+    }
+    return eventLoopFuture
+  }
+
+  /// Configure a `ChannelPipeline` for use as a VMESS mux client.
+  ///
+  /// The tunnel carries streams in Mux.Cool frames, open them with the returned session.
+  /// - Parameters:
+  ///   - position: The position in the `ChannelPipeline` where to add the VMESS mux client handlers. Defaults to `.last`.
+  ///   - contentSecurity: VMESS data stream security settings.
+  ///   - user: VMESS client ID.
+  ///   - maximumConcurrentStreams: The maximum number of open streams. Defaults to 8.
+  ///   - instrumentation: The instrumentation to report the chunks sealed and opened to. Defaults to `nil`.
+  /// - Returns: An `EventLoopFuture` that will fire with the session of the tunnel.
+  public func addVMESSMuxClientHandlers(
+    position: Position = .last,
+    contentSecurity: ContentSecurity,
+    user: UUID,
+    maximumConcurrentStreams: Int = 8,
+    instrumentation: (any ProxyInstrumentation)? = nil
+  ) -> EventLoopFuture<VMESSMuxSession> {
+    let eventLoopFuture: EventLoopFuture<VMESSMuxSession>
+
+    if eventLoop.inEventLoop {
+      let result = Result<VMESSMuxSession, Error> {
+        try syncOperations.addVMESSMuxClientHandlers(
+          position: position,
+          contentSecurity: contentSecurity,
+          user: user,
+          maximumConcurrentStreams: maximumConcurrentStreams,
+          instrumentation: instrumentation
+        )
+      }
+      eventLoopFuture = eventLoop.makeCompletedFuture(result)
+    } else {
+      eventLoopFuture = eventLoop.submit {
+        try self.syncOperations.addVMESSMuxClientHandlers(
+          position: position,
+          contentSecurity: contentSecurity,
+          user: user,
+          maximumConcurrentStreams: maximumConcurrentStreams,
+          instrumentation: instrumentation
         )
       }
     }
@@ -71,12 +119,14 @@ extension ChannelPipeline.SynchronousOperations {
   ///   - user: VMESS client ID.
   ///   - commandCode: Command code for VMESS request/response. Defaults to `.tcp`.
   ///   - destinationAddress: The destination for proxy connection.
+  ///   - instrumentation: The instrumentation to report the chunks sealed and opened to. Defaults to `nil`.
   public func addVMESSClientHandlers(
     position: ChannelPipeline.Position = .last,
     contentSecurity: ContentSecurity,
     user: UUID,
     commandCode: CommandCode = .tcp,
-    destinationAddress: NWEndpoint
+    destinationAddress: NWEndpoint,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) throws {
     eventLoop.assertInEventLoop()
 
@@ -94,7 +144,8 @@ extension ChannelPipeline.SynchronousOperations {
       symmetricKey: symmetricKey,
       nonce: nonce,
       options: options,
-      commandCode: commandCode
+      commandCode: commandCode,
+      instrumentation: instrumentation
     )
 
     let messageDecoder = VMESSDecoder<VMESSPart<VMESSResponseHead, ByteBuffer>>(
@@ -102,7 +153,8 @@ extension ChannelPipeline.SynchronousOperations {
       symmetricKey: symmetricKey,
       nonce: Array(nonce),
       options: options,
-      commandCode: commandCode
+      commandCode: commandCode,
+      instrumentation: instrumentation
     )
 
     let handlers: [ChannelHandler] = [
@@ -120,4 +172,41 @@ extension ChannelPipeline.SynchronousOperations {
 
     try addHandlers(handlers, position: position)
   }
+
+  /// Configure a `ChannelPipeline` for use as a VMESS mux client.
+  ///
+  /// The tunnel carries streams in Mux.Cool frames, open them with the returned session.
+  /// - Parameters:
+  ///   - position: The position in the `ChannelPipeline` where to add the VMESS mux client handlers. Defaults to `.last`.
+  ///   - contentSecurity: VMESS data stream security settings.
+  ///   - user: VMESS client ID.
+  ///   - maximumConcurrentStreams: The maximum number of open streams. Defaults to 8.
+  ///   - instrumentation: The instrumentation to report the chunks sealed and opened to. Defaults to `nil`.
+  /// - Returns: The session of the tunnel.
+  @discardableResult
+  public func addVMESSMuxClientHandlers(
+    position: ChannelPipeline.Position = .last,
+    contentSecurity: ContentSecurity,
+    user: UUID,
+    maximumConcurrentStreams: Int = 8,
+    instrumentation: (any ProxyInstrumentation)? = nil
+  ) throws -> VMESSMuxSession {
+    eventLoop.assertInEventLoop()
+
+    // The destination is not sent for mux requests, this is the one Mux.Cool servers expect.
+    try addVMESSClientHandlers(
+      position: position,
+      contentSecurity: contentSecurity,
+      user: user,
+      commandCode: .mux,
+      destinationAddress: .hostPort(host: "v1.mux.cool", port: 9527),
+      instrumentation: instrumentation
+    )
+
+    let sessionHandler = VMESSMuxSessionHandler(
+      maximumConcurrentStreams: maximumConcurrentStreams
+    )
+    try addHandler(sessionHandler, position: .after(handler(type: VMESSClientHandler.self)))
+    return VMESSMuxSession(handler: sessionHandler, eventLoop: eventLoop)
+  }
 }
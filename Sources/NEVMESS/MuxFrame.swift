@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import _NELinux
+
+// +-----------------+------------+--------+--------+----------------------+-------------+------+
+// | METADATA.LENGTH | SESSION ID | STATUS | OPTION | NETWORK, PORT, ADDR  | DATA.LENGTH | DATA |
+// +-----------------+------------+--------+--------+----------------------+-------------+------+
+// |        2        |     2      |   1    |   1    | VARIABLE, `new` only |      2      |  VAR |
+// +-----------------+------------+--------+--------+----------------------+-------------+------+
+
+/// A Mux.Cool frame, the unit sub-connections are multiplexed in over a VMESS `.mux` tunnel.
+struct MuxFrame: Equatable {
+
+  enum Status: UInt8 {
+    /// Opens a sub-connection to the destination in the metadata.
+    case new = 0x01
+
+    /// Carries data of an open sub-connection.
+    case keep = 0x02
+
+    /// Closes a sub-connection.
+    case end = 0x03
+
+    /// Keeps the tunnel alive, it belongs to no sub-connection.
+    case keepAlive = 0x04
+  }
+
+  struct Option: OptionSet, Hashable {
+    var rawValue: UInt8
+
+    /// The frame carries data.
+    static let data = Option(rawValue: 0x01)
+
+    /// The sub-connection ended with an error.
+    static let error = Option(rawValue: 0x02)
+  }
+
+  enum Network: UInt8 {
+    case tcp = 0x01
+    case udp = 0x02
+  }
+
+  var sessionID: UInt16
+
+  var status: Status
+
+  var option: Option
+
+  /// The network of the sub-connection opened by a `.new` frame.
+  var network: Network?
+
+  /// The destination of the sub-connection opened by a `.new` frame.
+  var destination: NWEndpoint?
+
+  var data: ByteBuffer?
+
+  init(
+    sessionID: UInt16,
+    status: Status,
+    option: Option = [],
+    network: Network? = nil,
+    destination: NWEndpoint? = nil,
+    data: ByteBuffer? = nil
+  ) {
+    self.sessionID = sessionID
+    self.status = status
+    self.option = data == nil ? option.subtracting(.data) : option.union(.data)
+    self.network = network
+    self.destination = destination
+    self.data = data
+  }
+}
+
+extension ByteBuffer {
+
+  /// Read a Mux.Cool frame.
+  ///
+  /// - Throws: `CodingError.failedToParseData` if the frame is malformed.
+  /// - Returns: The frame, or nil if more bytes are needed.
+  mutating func readMuxFrame() throws -> MuxFrame? {
+    try parseUnwinding { buffer in
+      guard var metadata = buffer.readLengthPrefixedSlice(as: UInt16.self) else {
+        return nil
+      }
+
+      guard let sessionID = metadata.readInteger(as: UInt16.self),
+        let status = metadata.readInteger(as: UInt8.self).flatMap(MuxFrame.Status.init(rawValue:)),
+        let option = metadata.readInteger(as: UInt8.self).map(MuxFrame.Option.init(rawValue:))
+      else {
+        throw CodingError.failedToParseData
+      }
+
+      var network: MuxFrame.Network?
+      var destination: NWEndpoint?
+      if status == .new {
+        network = metadata.readInteger(as: UInt8.self).flatMap(MuxFrame.Network.init(rawValue:))
+        destination = try metadata.readVMESSAddress()
+        guard network != nil, destination != nil else {
+          throw CodingError.failedToParseData
+        }
+      }
+
+      var data: ByteBuffer?
+      if option.contains(.data) {
+        guard let slice = buffer.readLengthPrefixedSlice(as: UInt16.self) else {
+          return nil
+        }
+        data = slice
+      }
+
+      return MuxFrame(
+        sessionID: sessionID,
+        status: status,
+        option: option,
+        network: network,
+        destination: destination,
+        data: data
+      )
+    }
+  }
+
+  /// Write a Mux.Cool frame.
+  ///
+  /// - Parameter frame: The frame to write, its data must be shorter than 64 KiB.
+  /// - Returns: Byte count.
+  @discardableResult
+  mutating func writeMuxFrame(_ frame: MuxFrame) -> Int {
+    // swift-format-ignore: NeverUseForceTry
+    var totalBytesWritten = try! writeLengthPrefixed(as: UInt16.self) { buffer in
+      var bytesWritten =
+        buffer.writeInteger(frame.sessionID)
+        + buffer.writeInteger(frame.status.rawValue)
+        + buffer.writeInteger(frame.option.rawValue)
+      if frame.status == .new, let network = frame.network, let destination = frame.destination {
+        bytesWritten += buffer.writeInteger(network.rawValue)
+        bytesWritten += buffer.writeVMESSAddress(destination)
+      }
+      return bytesWritten
+    }
+    if let data = frame.data {
+      precondition(data.readableBytes <= UInt16.max, "Mux.Cool frame data is too large")
+      totalBytesWritten += writeInteger(UInt16(data.readableBytes))
+      totalBytesWritten += writeImmutableBuffer(data)
+    }
+    return totalBytesWritten
+  }
+
+  /// Read an address in the VMESS address format, port first.
+  ///
+  /// - Throws: `CodingError.failedToParseData` if the address type is unknown.
+  /// - Returns: The address, or nil if more bytes are needed.
+  mutating func readVMESSAddress() throws -> NWEndpoint? {
+    try parseUnwinding { buffer in
+      guard let rawPort = buffer.readInteger(as: UInt16.self),
+        let type = buffer.readInteger(as: UInt8.self)
+      else {
+        return nil
+      }
+
+      let host: NWEndpoint.Host
+      switch type {
+      case 1:
+        guard let address = buffer.readIPv4Address() else {
+          return nil
+        }
+        host = .ipv4(address)
+      case 2:
+        guard let slice = buffer.readLengthPrefixedSlice(as: UInt8.self) else {
+          return nil
+        }
+        host = .name(String(buffer: slice), nil)
+      case 3:
+        guard let address = buffer.readIPv6Address() else {
+          return nil
+        }
+        host = .ipv6(address)
+      default:
+        throw CodingError.failedToParseData
+      }
+
+      guard let port = NWEndpoint.Port(rawValue: rawPort) else {
+        return nil
+      }
+      return .hostPort(host: host, port: port)
+    }
+  }
+}
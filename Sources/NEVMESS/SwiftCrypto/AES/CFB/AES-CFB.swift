@@ -17,8 +17,10 @@ import Foundation
 
 #if canImport(CommonCrypto)
 private typealias AESCFBImpl = CommonCryptoAESCFBImpl
+private typealias AESCFBCryptorImpl = CommonCryptoAESCFBCryptorImpl
 #else
 private typealias AESCFBImpl = OpenSSLAESCFBImpl
+private typealias AESCFBCryptorImpl = OpenSSLAESCFBCryptorImpl
 #endif
 
 extension AES {
@@ -63,6 +65,59 @@ extension AES {
       }
     }
 
+    /// A streaming AES-128-CFB cryptor.
+    ///
+    /// The cryptor expands the key once and carries the feedback register and its offset across
+    /// calls, so a stream processed in several `update` calls equals the stream processed at once.
+    public final class Cryptor {
+
+      /// The direction of a cryptor.
+      public enum Operation: Sendable {
+        case encrypt
+        case decrypt
+      }
+
+      private let impl: AESCFBCryptorImpl
+
+      /// Creates a cryptor.
+      ///
+      /// - Parameters:
+      ///   - operation: Whether the cryptor encrypts or decrypts.
+      ///   - key: An encryption key of 128 bits
+      ///   - nonce: The initial feedback register.
+      public init(operation: Operation, key: SymmetricKey, nonce: Nonce) throws {
+        self.impl = try AESCFBCryptorImpl(
+          encrypting: operation == .encrypt,
+          key: key,
+          nonce: nonce
+        )
+      }
+
+      /// Encrypts or decrypts `input` into `output`, continuing the stream of previous calls.
+      ///
+      /// - Parameters:
+      ///   - input: The bytes to process.
+      ///   - output: The memory to write the result to, at least as large as `input`. It may be
+      ///     the same memory as `input`.
+      public func update(
+        input: UnsafeRawBufferPointer,
+        output: UnsafeMutableRawBufferPointer
+      ) throws {
+        precondition(output.count >= input.count, "output buffer is too small")
+        guard !input.isEmpty else {
+          return
+        }
+        try impl.update(input: input, output: output)
+      }
+
+      /// Encrypts or decrypts `buffer` in place, continuing the stream of previous calls.
+      ///
+      /// - Parameter buffer: The bytes to process.
+      public func update(_ buffer: UnsafeMutableRawBufferPointer) throws {
+        try update(input: UnsafeRawBufferPointer(buffer), output: buffer)
+      }
+    }
+
     /// Encrypts data using AES-128-CFB without padding.
     ///
     /// - Parameters:
@@ -94,3 +149,6 @@ extension AES {
     }
   }
 }
+
+@available(*, unavailable)
+extension AES.CFB.Cryptor: Sendable {}
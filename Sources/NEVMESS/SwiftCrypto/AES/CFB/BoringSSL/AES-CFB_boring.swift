@@ -45,19 +45,43 @@ extension OpenSSLAESCFBImpl {
     nonce: AES.CFB.Nonce
   ) throws -> Data where Message: DataProtocol {
     precondition(operation == AES_ENCRYPT || operation == AES_DECRYPT)
+    let cryptor = try OpenSSLAESCFBCryptorImpl(
+      encrypting: operation == AES_ENCRYPT,
+      key: key,
+      nonce: nonce
+    )
+
+    var dataOut = Data(message)
+    try dataOut.withUnsafeMutableBytes {
+      try cryptor.update(input: UnsafeRawBufferPointer($0), output: $0)
+    }
+    return dataOut
+  }
+}
+
+final class OpenSSLAESCFBCryptorImpl {
+
+  private let operation: Int32
+  private let symmetricKey: UnsafeMutablePointer<AES_KEY>
+  private let iv: UnsafeMutablePointer<UInt8>
+  private var num: Int32 = 0
+
+  init(encrypting: Bool, key: SymmetricKey, nonce: AES.CFB.Nonce) throws {
     guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
       throw CryptoKitError.incorrectKeySize
     }
 
-    let symmetricKey = UnsafeMutablePointer<AES_KEY>.allocate(
-      capacity: MemoryLayout<AES_KEY>.size
-    )
+    let symmetricKey = UnsafeMutablePointer<AES_KEY>.allocate(capacity: 1)
     symmetricKey.initialize(to: .init())
-    defer {
-      symmetricKey.deinitialize(count: MemoryLayout<AES_KEY>.size)
-      symmetricKey.deallocate()
+    let iv = UnsafeMutablePointer<UInt8>.allocate(capacity: Int(AES_BLOCK_SIZE))
+    nonce.withUnsafeBytes {
+      iv.initialize(from: $0.bindMemory(to: UInt8.self).baseAddress!, count: Int(AES_BLOCK_SIZE))
     }
+    self.operation = encrypting ? AES_ENCRYPT : AES_DECRYPT
+    self.symmetricKey = symmetricKey
+    self.iv = iv
 
+    // CFB runs the block cipher forwards in both directions.
     let retval = key.withUnsafeBytes {
       CCryptoBoringSSL_AES_set_encrypt_key(
         $0.bindMemory(to: UInt8.self).baseAddress,
@@ -70,30 +94,25 @@ extension OpenSSLAESCFBImpl {
         error: Int32(CCryptoBoringSSL_ERR_get_error())
       )
     }
+  }
 
-    var numRounds: Int32 = 0
-    let dataOutMoved = message.count
-
-    var dataOut = Data(repeating: .zero, count: dataOutMoved)
-
-    var nonce = Array(nonce)
-    nonce.withUnsafeMutableBytes { nonce in
-      dataOut.withUnsafeMutableBytes { dataOut in
-        Array(message).withUnsafeBufferPointer { dataIn in
-          CCryptoBoringSSL_AES_cfb128_encrypt(
-            dataIn.baseAddress,
-            dataOut.bindMemory(to: UInt8.self).baseAddress,
-            dataOutMoved,
-            symmetricKey,
-            nonce.baseAddress,
-            &numRounds,
-            operation
-          )
-        }
-      }
-    }
+  deinit {
+    symmetricKey.deinitialize(count: 1)
+    symmetricKey.deallocate()
+    iv.deinitialize(count: Int(AES_BLOCK_SIZE))
+    iv.deallocate()
+  }
 
-    return dataOut.prefix(dataOutMoved)
+  func update(input: UnsafeRawBufferPointer, output: UnsafeMutableRawBufferPointer) throws {
+    CCryptoBoringSSL_AES_cfb128_encrypt(
+      input.bindMemory(to: UInt8.self).baseAddress,
+      output.bindMemory(to: UInt8.self).baseAddress,
+      input.count,
+      symmetricKey,
+      iv,
+      &num,
+      operation
+    )
   }
 }
 #endif
@@ -44,19 +44,34 @@ extension CommonCryptoAESCFBImpl {
     using key: SymmetricKey,
     nonce: AES.CFB.Nonce
   ) throws -> Data where Message: DataProtocol {
+    let cryptor = try CommonCryptoAESCFBCryptorImpl(
+      encrypting: operation == CCOperation(kCCEncrypt),
+      key: key,
+      nonce: nonce
+    )
+
+    var dataOut = Data(message)
+    try dataOut.withUnsafeMutableBytes {
+      try cryptor.update(input: UnsafeRawBufferPointer($0), output: $0)
+    }
+    return dataOut
+  }
+}
+
+final class CommonCryptoAESCFBCryptorImpl {
+
+  private let cryptor: CCCryptorRef
+
+  init(encrypting: Bool, key: SymmetricKey, nonce: AES.CFB.Nonce) throws {
     guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
       throw CryptoKitError.incorrectKeySize
     }
 
     var cryptor: CCCryptorRef?
-    var retval: CCCryptorStatus
-    var updateLen = 0
-    var finalLen = 0
-
-    retval = nonce.withUnsafeBytes { iv in
+    let retval = nonce.withUnsafeBytes { iv in
       key.withUnsafeBytes {
         CCCryptorCreateWithMode(
-          operation,
+          CCOperation(encrypting ? kCCEncrypt : kCCDecrypt),
           CCMode(kCCModeCFB),
           CCAlgorithm(kCCAlgorithmAES128),
           CCPadding(ccNoPadding),
@@ -71,47 +86,29 @@ extension CommonCryptoAESCFBImpl {
         )
       }
     }
-    guard retval == kCCSuccess else {
+    guard retval == kCCSuccess, let cryptor else {
       throw CryptoKitError.underlyingCoreCryptoError(error: Int32(retval))
     }
+    self.cryptor = cryptor
+  }
 
-    let dataInLength = message.count
-    let needed = CCCryptorGetOutputLength(cryptor, dataInLength, true)
-    var dataOutMoved = needed
-    var dataOutAvailable = needed
-
-    var dataOut = Data(repeating: .zero, count: needed)
+  deinit {
+    CCCryptorRelease(cryptor)
+  }
 
-    retval = dataOut.withUnsafeMutableBytes { dataOut in
-      Array(message).withUnsafeBytes { dataIn in
-        CCCryptorUpdate(
-          cryptor,
-          dataIn.baseAddress,
-          dataInLength,
-          dataOut.baseAddress,
-          dataOutAvailable,
-          &updateLen
-        )
-      }
-    }
+  func update(input: UnsafeRawBufferPointer, output: UnsafeMutableRawBufferPointer) throws {
+    var dataOutMoved = 0
+    let retval = CCCryptorUpdate(
+      cryptor,
+      input.baseAddress,
+      input.count,
+      output.baseAddress,
+      output.count,
+      &dataOutMoved
+    )
     guard retval == kCCSuccess else {
-      CCCryptorRelease(cryptor)
       throw CryptoKitError.underlyingCoreCryptoError(error: Int32(retval))
     }
-
-    dataOutAvailable -= updateLen
-    retval = dataOut.withUnsafeMutableBytes { dataOut in
-      CCCryptorFinal(
-        cryptor,
-        dataOut.baseAddress?.advanced(by: updateLen),
-        dataOutAvailable,
-        &finalLen
-      )
-    }
-    dataOutMoved = updateLen + finalLen
-
-    CCCryptorRelease(cryptor)
-    return dataOut.prefix(dataOutMoved)
   }
 }
 #endif
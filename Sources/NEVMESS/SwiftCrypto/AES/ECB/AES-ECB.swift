@@ -17,8 +17,10 @@ import Foundation
 
 #if canImport(CommonCrypto)
 private typealias AESECBImpl = CommonCryptoAESECBImpl
+private typealias AESECBKeyScheduleImpl = CommonCryptoAESECBKeyScheduleImpl
 #else
 private typealias AESECBImpl = OpenSSLAESECBImpl
+private typealias AESECBKeyScheduleImpl = OpenSSLAESECBKeyScheduleImpl
 #endif
 
 extension AES {
@@ -26,6 +28,23 @@ extension AES {
   /// AES in ECB mode with 128-bit key.
   public enum ECB {
 
+    /// An expanded AES-128 key schedule.
+    ///
+    /// Expanding the key is most of the cost of encrypting a single block, keep a key schedule to
+    /// encrypt or decrypt many messages with the same key. A key schedule can be shared between
+    /// threads.
+    public struct KeySchedule: Sendable {
+
+      fileprivate let impl: AESECBKeyScheduleImpl
+
+      /// Expands `key` into a key schedule.
+      ///
+      /// - Parameter key: A 128-bits encryption key
+      public init(key: SymmetricKey) throws {
+        self.impl = try AESECBKeyScheduleImpl(key: key)
+      }
+    }
+
     /// Encrypts data using AES-128-ECB with PKCS7Padding.
     ///
     /// - Parameters:
@@ -51,5 +70,31 @@ extension AES {
     ) throws -> Data where Ciphertext: DataProtocol {
       try AESECBImpl.decrypt(message, using: key)
     }
+
+    /// Encrypts data using AES-128-ECB with PKCS7Padding.
+    ///
+    /// - Parameters:
+    ///   - message: The message to encrypt
+    ///   - keySchedule: The expanded 128-bits encryption key
+    /// - Returns: The encrypted ciphertext
+    public static func encrypt<Plaintext>(
+      _ message: Plaintext,
+      using keySchedule: KeySchedule
+    ) throws -> Data where Plaintext: DataProtocol {
+      try keySchedule.impl.encrypt(message)
+    }
+
+    /// Decrypts data using AES-128-ECB with PKCS7Padding.
+    ///
+    /// - Parameters:
+    ///   - message: The message to decrypt
+    ///   - keySchedule: The expanded 128-bits encryption key
+    /// - Returns: The decrypted message if success
+    public static func decrypt<Ciphertext>(
+      _ message: Ciphertext,
+      using keySchedule: KeySchedule
+    ) throws -> Data where Ciphertext: DataProtocol {
+      try keySchedule.impl.decrypt(message)
+    }
   }
 }
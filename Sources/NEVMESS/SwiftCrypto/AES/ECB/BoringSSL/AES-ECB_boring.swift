@@ -104,4 +104,84 @@ extension OpenSSLAESECBImpl {
     return dataOut.prefix(Int(dataOutMoved))
   }
 }
+
+final class OpenSSLAESECBKeyScheduleImpl: @unchecked Sendable {
+
+  // Both keys are only read after initialization, so the schedule can be shared between threads.
+  private let encryptKey: UnsafeMutablePointer<AES_KEY>
+  private let decryptKey: UnsafeMutablePointer<AES_KEY>
+
+  init(key: SymmetricKey) throws {
+    guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
+      throw CryptoKitError.incorrectKeySize
+    }
+
+    let encryptKey = UnsafeMutablePointer<AES_KEY>.allocate(capacity: 1)
+    encryptKey.initialize(to: .init())
+    let decryptKey = UnsafeMutablePointer<AES_KEY>.allocate(capacity: 1)
+    decryptKey.initialize(to: .init())
+    self.encryptKey = encryptKey
+    self.decryptKey = decryptKey
+
+    let retval = key.withUnsafeBytes {
+      let userKey = $0.bindMemory(to: UInt8.self).baseAddress
+      return CCryptoBoringSSL_AES_set_encrypt_key(userKey, UInt32(key.bitCount), encryptKey)
+        | CCryptoBoringSSL_AES_set_decrypt_key(userKey, UInt32(key.bitCount), decryptKey)
+    }
+    guard retval == 0 else {
+      throw CryptoKitError.underlyingCoreCryptoError(error: Int32(CCryptoBoringSSL_ERR_get_error()))
+    }
+  }
+
+  deinit {
+    encryptKey.deinitialize(count: 1)
+    encryptKey.deallocate()
+    decryptKey.deinitialize(count: 1)
+    decryptKey.deallocate()
+  }
+
+  func encrypt<Plaintext>(_ message: Plaintext) throws -> Data where Plaintext: DataProtocol {
+    let blockSize = Int(AES_BLOCK_SIZE)
+    let dataInLength = message.count
+    let needed = (dataInLength + blockSize) / blockSize * blockSize
+    let padding = UInt8(needed - dataInLength)
+
+    var dataOut = Data(repeating: padding, count: needed)
+    dataOut.withUnsafeMutableBytes { dataOut in
+      dataOut.copyBytes(from: message)
+      let blocks = dataOut.bindMemory(to: UInt8.self).baseAddress!
+      for offset in stride(from: 0, to: needed, by: blockSize) {
+        CCryptoBoringSSL_AES_encrypt(blocks + offset, blocks + offset, encryptKey)
+      }
+    }
+    return dataOut
+  }
+
+  func decrypt<Ciphertext>(_ message: Ciphertext) throws -> Data where Ciphertext: DataProtocol {
+    let blockSize = Int(AES_BLOCK_SIZE)
+    let dataInLength = message.count
+    guard dataInLength > 0 && dataInLength % blockSize == 0 else {
+      throw CryptoKitError.incorrectParameterSize
+    }
+
+    var dataOut = Data(message)
+    let padding = dataOut.withUnsafeMutableBytes { dataOut in
+      let blocks = dataOut.bindMemory(to: UInt8.self).baseAddress!
+      for offset in stride(from: 0, to: dataInLength, by: blockSize) {
+        CCryptoBoringSSL_AES_decrypt(blocks + offset, blocks + offset, decryptKey)
+      }
+      let padding = Int(dataOut[dataInLength - 1])
+      guard (1...blockSize).contains(padding),
+        dataOut[(dataInLength - padding)...].allSatisfy({ $0 == UInt8(padding) })
+      else {
+        return 0
+      }
+      return padding
+    }
+    guard padding > 0 else {
+      throw CryptoKitError.incorrectParameterSize
+    }
+    return dataOut.prefix(dataInLength - padding)
+  }
+}
 #endif
@@ -15,6 +15,7 @@
 #if canImport(CommonCrypto)
 import Crypto
 import Foundation
+import NIOConcurrencyHelpers
 @_implementationOnly import CommonCrypto
 
 enum CommonCryptoAESECBImpl {
@@ -107,4 +108,118 @@ extension CommonCryptoAESECBImpl {
     return dataOut.prefix(dataOutMoved)
   }
 }
+
+final class CommonCryptoAESECBKeyScheduleImpl: @unchecked Sendable {
+
+  // ECB carries no state between blocks, so one cryptor per direction can serve every message,
+  // the lock only serializes access to the cryptor objects.
+  private let lock = NIOLock()
+  private let encryptor: CCCryptorRef
+  private let decryptor: CCCryptorRef
+
+  init(key: SymmetricKey) throws {
+    guard key.bitCount == SymmetricKeySize.bits128.bitCount else {
+      throw CryptoKitError.incorrectKeySize
+    }
+
+    var encryptor: CCCryptorRef?
+    var decryptor: CCCryptorRef?
+    let retval = key.withUnsafeBytes { key in
+      let encryptorStatus = CCCryptorCreate(
+        CCOperation(kCCEncrypt),
+        CCAlgorithm(kCCAlgorithmAES128),
+        CCOptions(kCCOptionECBMode),
+        key.baseAddress,
+        key.count,
+        nil,
+        &encryptor
+      )
+      guard encryptorStatus == kCCSuccess else {
+        return encryptorStatus
+      }
+      return CCCryptorCreate(
+        CCOperation(kCCDecrypt),
+        CCAlgorithm(kCCAlgorithmAES128),
+        CCOptions(kCCOptionECBMode),
+        key.baseAddress,
+        key.count,
+        nil,
+        &decryptor
+      )
+    }
+    guard retval == kCCSuccess, let encryptor, let decryptor else {
+      if let encryptor {
+        CCCryptorRelease(encryptor)
+      }
+      if let decryptor {
+        CCCryptorRelease(decryptor)
+      }
+      throw CryptoKitError.underlyingCoreCryptoError(error: Int32(retval))
+    }
+    self.encryptor = encryptor
+    self.decryptor = decryptor
+  }
+
+  deinit {
+    CCCryptorRelease(encryptor)
+    CCCryptorRelease(decryptor)
+  }
+
+  func encrypt<Plaintext>(_ message: Plaintext) throws -> Data where Plaintext: DataProtocol {
+    let blockSize = kCCBlockSizeAES128
+    let dataInLength = message.count
+    let needed = (dataInLength + blockSize) / blockSize * blockSize
+    let padding = UInt8(needed - dataInLength)
+
+    var dataOut = Data(repeating: padding, count: needed)
+    let retval = dataOut.withUnsafeMutableBytes { dataOut in
+      dataOut.copyBytes(from: message)
+      return update(encryptor, dataOut)
+    }
+    guard retval == kCCSuccess else {
+      throw CryptoKitError.underlyingCoreCryptoError(error: Int32(retval))
+    }
+    return dataOut
+  }
+
+  func decrypt<Ciphertext>(_ message: Ciphertext) throws -> Data where Ciphertext: DataProtocol {
+    let blockSize = kCCBlockSizeAES128
+    let dataInLength = message.count
+    guard dataInLength > 0 && dataInLength % blockSize == 0 else {
+      throw CryptoKitError.incorrectParameterSize
+    }
+
+    var dataOut = Data(message)
+    let retval = dataOut.withUnsafeMutableBytes { dataOut in
+      update(decryptor, dataOut)
+    }
+    guard retval == kCCSuccess else {
+      throw CryptoKitError.underlyingCoreCryptoError(error: Int32(retval))
+    }
+
+    let padding = Int(dataOut[dataOut.index(before: dataOut.endIndex)])
+    guard (1...blockSize).contains(padding),
+      dataOut.suffix(padding).allSatisfy({ $0 == UInt8(padding) })
+    else {
+      throw CryptoKitError.incorrectParameterSize
+    }
+    return dataOut.prefix(dataInLength - padding)
+  }
+
+  private func update(_ cryptor: CCCryptorRef, _ blocks: UnsafeMutableRawBufferPointer)
+    -> CCCryptorStatus
+  {
+    var dataOutMoved = 0
+    return lock.withLock {
+      CCCryptorUpdate(
+        cryptor,
+        blocks.baseAddress,
+        blocks.count,
+        blocks.baseAddress,
+        blocks.count,
+        &dataOutMoved
+      )
+    }
+  }
+}
 #endif
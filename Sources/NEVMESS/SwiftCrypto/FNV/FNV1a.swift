@@ -14,7 +14,14 @@
 
 import Foundation
 
-enum FNV1a32 {
+@_spi(Benchmarks)
+public enum FNV1a32 {
+
+  @usableFromInline
+  static let prime: UInt32 = 16_777_619
+
+  @usableFromInline
+  static let offsetBasis: UInt32 = 2_166_136_261
 
   /// FNV-1a 32 bit variant hash.
   ///
@@ -22,15 +29,51 @@ enum FNV1a32 {
   ///
   /// - Parameter data: Data to combined.
   /// - Returns: Hash value.
-  @inlinable static func hash<D>(data: D) -> UInt32 where D: DataProtocol {
-    let prime: UInt32 = 16_777_619
-    let offsetBasis: UInt32 = 2_166_136_261
-
-    return data.reduce(offsetBasis) { partialResult, byte in
-      var partialResult = partialResult
-      partialResult ^= UInt32(byte)
-      partialResult &*= prime
-      return partialResult
+  @inlinable public static func hash<D>(data: D) -> UInt32 where D: DataProtocol {
+    data.regions.reduce(offsetBasis) { partialResult, region in
+      region.withUnsafeBytes {
+        combine($0, into: partialResult)
+      }
+    }
+  }
+
+  /// FNV-1a 32 bit variant hash of the bytes in `bufferPointer`.
+  ///
+  /// - Parameter bufferPointer: Bytes to combined.
+  /// - Returns: Hash value.
+  @inlinable public static func hash(bufferPointer: UnsafeRawBufferPointer) -> UInt32 {
+    combine(bufferPointer, into: offsetBasis)
+  }
+
+  /// Combines `bufferPointer` into `partialResult`, eight bytes per iteration.
+  ///
+  /// FNV-1a is sequential byte by byte, so unrolling only saves the per-byte load and loop
+  /// overhead, the multiplications stay in order.
+  @inlinable
+  static func combine(_ bufferPointer: UnsafeRawBufferPointer, into partialResult: UInt32) -> UInt32
+  {
+    var hash = partialResult
+    var offset = 0
+
+    while bufferPointer.count - offset >= 8 {
+      let word = UInt64(
+        littleEndian: bufferPointer.loadUnaligned(fromByteOffset: offset, as: UInt64.self)
+      )
+      hash = (hash ^ UInt32(truncatingIfNeeded: word & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 8) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 16) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 24) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 32) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 40) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: (word >> 48) & 0xFF)) &* prime
+      hash = (hash ^ UInt32(truncatingIfNeeded: word >> 56)) &* prime
+      offset += 8
+    }
+
+    while offset < bufferPointer.count {
+      hash = (hash ^ UInt32(bufferPointer[offset])) &* prime
+      offset += 1
     }
+    return hash
   }
 }
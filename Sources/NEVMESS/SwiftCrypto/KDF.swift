@@ -15,91 +15,105 @@
 import Crypto
 import Foundation
 
-private protocol HashFunction {
+@_spi(Benchmarks)
+public struct KDF {
 
-  static var blockSize: Int { get }
-
-  mutating func update(bufferPointer: UnsafeRawBufferPointer)
-
-  mutating func update<D: DataProtocol>(data: D)
-
-  func _finalize() -> [UInt8]
-}
-
-extension SHA256: HashFunction {
-
-  fileprivate static let blockSize: Int = 64
-
-  fileprivate func _finalize() -> [UInt8] {
-    Array(finalize())
-  }
-}
-
-struct KDF {
-
-  private struct HMAC: HashFunction {
+  /// An HMAC chain nested over a hash function, as used by the VMESS KDF.
+  ///
+  /// `HMAC(H, key)` keeps an inner and an outer `H`, so nesting `n` levels yields `2^n` states of
+  /// the underlying hash function. They are stored flattened as the leaves of a complete binary
+  /// tree, inner subtree first, so adding a level copies plain values instead of boxing hashers in
+  /// existentials, and a partially built chain can be cached and reused.
+  struct NestedHMAC<H: HashFunction> {
 
-    static var blockSize: Int { SHA256.blockSize }
+    private var leaves: [H]
 
-    mutating func update(bufferPointer: UnsafeRawBufferPointer) {
-      innerHasher.update(bufferPointer: bufferPointer)
+    /// Creates a chain without HMAC levels, which hashes like `H`.
+    init() {
+      self.leaves = [H()]
     }
 
-    mutating func update<D: DataProtocol>(data: D) {
-      data.regions.forEach { (regionData) in
-        regionData.withUnsafeBytes({ (dataPtr) in
-          self.update(bufferPointer: dataPtr)
-        })
+    /// Returns the HMAC of this chain keyed with `key`.
+    func appending<Key: ContiguousBytes>(key: Key) -> Self {
+      key.withUnsafeBytes { key in
+        guard key.count > H.blockByteCount else {
+          return appending(shortKey: key)
+        }
+        var hasher = self
+        hasher.update(bufferPointer: key)
+        return hasher.finalize().withUnsafeBytes {
+          appending(shortKey: $0)
+        }
       }
     }
 
-    func _finalize() -> [UInt8] {
-      let buffer = innerHasher._finalize()
-      var outerHashForFinalization = outerHasher
-      buffer.withUnsafeBytes {
-        outerHashForFinalization.update(bufferPointer: $0)
+    private func appending(shortKey key: UnsafeRawBufferPointer) -> Self {
+      withUnsafeTemporaryAllocation(byteCount: H.blockByteCount, alignment: 1) { pad in
+        var inner = self
+        _ = pad.initializeMemory(as: UInt8.self, repeating: 0x36)
+        for (index, byte) in key.enumerated() {
+          pad[index] ^= byte
+        }
+        inner.update(bufferPointer: UnsafeRawBufferPointer(pad))
+
+        var outer = self
+        _ = pad.initializeMemory(as: UInt8.self, repeating: 0x5c)
+        for (index, byte) in key.enumerated() {
+          pad[index] ^= byte
+        }
+        outer.update(bufferPointer: UnsafeRawBufferPointer(pad))
+
+        inner.leaves.append(contentsOf: outer.leaves)
+        return inner
       }
-      return outerHashForFinalization._finalize()
     }
 
-    var outerHasher: HashFunction
-    var innerHasher: HashFunction
-
-    init<U: HashFunction>(_ H: @autoclosure () -> U, key: SymmetricKey) {
-      var k: ContiguousBytes
+    mutating func update(bufferPointer: UnsafeRawBufferPointer) {
+      // Input only ever reaches the innermost hasher.
+      leaves[0].update(bufferPointer: bufferPointer)
+    }
 
-      if key.withUnsafeBytes({ $0.count }) == U.blockSize {
-        k = key
-      } else if key.withUnsafeBytes({ $0.count }) > U.blockSize {
-        k = key.withUnsafeBytes { (keyBytes) in
-          var hash = H()
-          hash.update(bufferPointer: keyBytes)
-          return hash._finalize()
-        }
-      } else {
-        var keyArray = Array(repeating: UInt8(0), count: U.blockSize)
-        key.withUnsafeBytes { keyArray.replaceSubrange(0..<$0.count, with: $0) }
-        k = keyArray
-      }
+    func finalize() -> [UInt8] {
+      Self.finalizeLeaves(leaves[...])
+    }
 
-      self.innerHasher = H()
-      let innerKey = k.withUnsafeBytes {
-        return $0.map({ (keyByte) in
-          keyByte ^ 0x36
-        })
+    private static func finalizeLeaves(_ leaves: ArraySlice<H>) -> [UInt8] {
+      guard leaves.count > 1 else {
+        return Array(leaves[leaves.startIndex].finalize())
       }
-      innerHasher.update(data: innerKey)
-
-      self.outerHasher = H()
-      let outerKey = k.withUnsafeBytes {
-        return $0.map({ (keyByte) in
-          keyByte ^ 0x5c
-        })
+      let middle = leaves.startIndex + leaves.count / 2
+      let digest = finalizeLeaves(leaves[..<middle])
+      var outer = leaves[middle...]
+      digest.withUnsafeBytes {
+        outer[outer.startIndex].update(bufferPointer: $0)
       }
-      outerHasher.update(data: outerKey)
+      return finalizeLeaves(outer)
     }
   }
 
+  private static let salt = NestedHMAC<SHA256>().appending(key: Array("VMess AEAD KDF".utf8))
+
+  /// Chains for the first paths VMESS derives keys from on every connection.
+  private static let cachedPaths: [[UInt8]: NestedHMAC<SHA256>] = {
+    let paths = [
+      "AES Auth ID Encryption",
+      "VMess Header AEAD Key",
+      "VMess Header AEAD Nonce",
+      "VMess Header AEAD Key_Length",
+      "VMess Header AEAD Nonce_Length",
+      "AEAD Resp Header Len Key",
+      "AEAD Resp Header Len IV",
+      "AEAD Resp Header Key",
+      "AEAD Resp Header IV",
+      "auth_len",
+    ]
+    return Dictionary(
+      uniqueKeysWithValues: paths.map {
+        (Array($0.utf8), salt.appending(key: Array($0.utf8)))
+      }
+    )
+  }()
+
   /// Derives a symmetric key using the KDF algorithm.
   ///
   /// - Parameters:
@@ -107,26 +121,29 @@ struct KDF {
   ///   - paths: path list.
   ///   - outputByteCount: The desired number of output bit count, defaults to 16 bytes.
   /// - Returns: The derived key
-  static func deriveKey<Info>(
+  public static func deriveKey<Info>(
     inputKeyMaterial: SymmetricKey,
     info: [Info],
     outputByteCount: Int = 16
   ) -> SymmetricKey where Info: DataProtocol {
-    let kDFSaltConstVMessAEADKDF = Data("VMess AEAD KDF".utf8)
-
-    var hasher = HMAC(SHA256(), key: .init(data: kDFSaltConstVMessAEADKDF))
+    var paths = info[...]
+    var hasher = salt
+    if let path = paths.first, let cached = cachedPaths[Array(path)] {
+      hasher = cached
+      paths = paths.dropFirst()
+    }
 
-    for path in info {
-      hasher = HMAC(hasher, key: .init(data: Array(path)))
+    for path in paths {
+      hasher = hasher.appending(key: Array(path))
     }
     inputKeyMaterial.withUnsafeBytes {
       hasher.update(bufferPointer: $0)
     }
 
-    return .init(data: hasher._finalize().prefix(outputByteCount))
+    return .init(data: hasher.finalize().prefix(outputByteCount))
   }
 
-  static func deriveKey<Info>(
+  public static func deriveKey<Info>(
     inputKeyMaterial: SymmetricKey,
     info: Info,
     outputByteCount: Int = 16
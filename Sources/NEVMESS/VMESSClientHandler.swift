@@ -106,3 +106,9 @@ final public class VMESSClientHandler: ChannelInboundHandler, ChannelOutboundHan
 
 @available(*, unavailable)
 extension VMESSClientHandler: Sendable {}
+
+extension ProxyComponent {
+
+  /// The `VMESSEncoder` and `VMESSDecoder` of a VMESS client.
+  public static let vmessClient = ProxyComponent(rawValue: "vmess-client")
+}
@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 import Crypto
+import NEAEAD
 import NEPrettyBytes
 import NESHAKE128
 import NIOCore
@@ -39,6 +40,9 @@ private class BetterVMESSParser {
 
   var delegate: VMESSDecoderDelegate! = nil
 
+  /// The allocator used to allocate decrypted frame buffers.
+  var allocator = ByteBufferAllocator()
+
   private var decodingState: VMESSDecodingState = .headBegin
   private let kind: VMESSDecoderKind
   private let contentSecurity: ContentSecurity
@@ -48,14 +52,44 @@ private class BetterVMESSParser {
   private let commandCode: CommandCode
   private var nonceLeading = UInt16.zero
   private let headDecryptionStrategy: ResponseHeadDecryptionStrategy
-  private lazy var hasher: SHAKE128 = {
+  private let sessionKeys: VMESSSessionKeys
+  private lazy var keystream: SHAKE128.Reader = {
     var shake128 = SHAKE128()
     nonce.withUnsafeBytes { buffPtr in
       shake128.update(data: buffPtr)
     }
-    return shake128
+    return .init(shake128)
+  }()
+
+  /// The AES-128-CFB body stream, which runs across every frame of the response.
+  private var cfbDecryptor: AES.CFB.Cryptor?
+
+  /// The AEAD chunk nonce, the first two bytes hold `nonceLeading` and are rewritten per chunk.
+  private lazy var chunkNonce: [UInt8] = Array(nonce.prefix(12))
+  private lazy var chunkOpener: ChunkSealer = {
+    // The response body key is always 128 bits, see initialization.
+    try! ChunkSealer(
+      algorithm: contentSecurity == .aes128Gcm ? .aes128Gcm : .chaCha20Poly1305,
+      key: sessionKeys.payloadKey
+    )
+  }()
+  private lazy var lengthOpener: ChunkSealer? = {
+    guard let lengthKey = sessionKeys.lengthKey else {
+      return nil
+    }
+    return try! ChunkSealer(
+      algorithm: contentSecurity == .aes128Gcm ? .aes128Gcm : .chaCha20Poly1305,
+      key: lengthKey
+    )
   }()
 
+  private let instrumentation: (any ProxyInstrumentation)?
+
+  /// The chunks opened by the current `feedInput(_:)` pass, only counted when instrumented.
+  private var openedChunkCount = 0
+  private var openedByteCount = 0
+  private var openingDuration = TimeAmount.nanoseconds(0)
+
   init(
     kind: VMESSDecoderKind,
     contentSecurity: ContentSecurity,
@@ -63,9 +97,11 @@ private class BetterVMESSParser {
     nonce: [UInt8],
     options: StreamOptions,
     commandCode: CommandCode,
-    headDecryptionStrategy: ResponseHeadDecryptionStrategy
+    headDecryptionStrategy: ResponseHeadDecryptionStrategy,
+    instrumentation: (any ProxyInstrumentation)?
   ) {
     self.kind = kind
+    self.instrumentation = instrumentation
     self.symmetricKey = symmetricKey.withUnsafeBytes {
       SymmetricKey(data: Array(SHA256.hash(data: $0).prefix(16)))
     }
@@ -101,6 +137,11 @@ private class BetterVMESSParser {
     self.options = options
     self.commandCode = commandCode
     self.headDecryptionStrategy = headDecryptionStrategy
+    self.sessionKeys = VMESSSessionKeys(
+      symmetricKey: self.symmetricKey,
+      contentSecurity: self.contentSecurity,
+      options: options
+    )
   }
 
   func start() {}
@@ -119,16 +160,45 @@ private class BetterVMESSParser {
     nonceLeading = 0
     decodingState = .headBegin
     if options.contains(.chunkMasking) {
-      hasher = .init()
+      var shake128 = SHAKE128()
       nonce.withUnsafeBytes { buffPtr in
-        hasher.update(data: buffPtr)
+        shake128.update(data: buffPtr)
       }
+      keystream = .init(shake128)
     }
     decodingState = .complete
     delegate.didFinishMessage()
   }
 
   func feedInput(_ bytes: ByteBuffer?) throws -> Int {
+    guard let instrumentation else {
+      return try parseInput(bytes)
+    }
+
+    openedChunkCount = 0
+    openedByteCount = 0
+    openingDuration = .nanoseconds(0)
+    defer {
+      if openedChunkCount > 0 {
+        instrumentation.chunksProcessed(
+          openedChunkCount,
+          byteCount: openedByteCount,
+          direction: .inbound,
+          component: .vmessClient,
+          duration: openingDuration
+        )
+      }
+    }
+
+    do {
+      return try parseInput(bytes)
+    } catch CryptoKitError.authenticationFailure {
+      instrumentation.authenticationDidFail(component: .vmessClient)
+      throw CryptoKitError.authenticationFailure
+    }
+  }
+
+  private func parseInput(_ bytes: ByteBuffer?) throws -> Int {
     guard var byteBuffer = bytes else {
       didFinishMessage()
       return 0
@@ -154,6 +224,7 @@ private class BetterVMESSParser {
         }
         decodingState = .frameDataBegin(length: frameLength, padding: padding)
       case .frameDataBegin(length: let frameLength, let padding):
+        let startTime = instrumentation == nil ? nil : NIODeadline.now()
         guard
           let frameData = try parseFrame(
             from: &byteBuffer,
@@ -163,6 +234,11 @@ private class BetterVMESSParser {
         else {
           break loop
         }
+        if let startTime {
+          openedChunkCount += 1
+          openedByteCount += frameData.readableBytes
+          openingDuration = openingDuration + (.now() - startTime)
+        }
         didReceiveBody(frameData)
         decodingState = .frameLengthBegin
       case .complete:
@@ -196,35 +272,20 @@ private class BetterVMESSParser {
         return (buffer.readableBytes, padding)
       }
 
-      // We can't actual read payload length data there, it will cause frame decrypt failed.
-      let payloadLengthDataSize = MemoryLayout<UInt16>.size
-      let startIndex = buffer.readerIndex
-      guard var message = buffer.getSlice(at: startIndex, length: payloadLengthDataSize) else {
+      // Buffer is not enough to decode frame length, return nil to waiting for more data.
+      guard var frameLengthData = buffer.readSlice(length: MemoryLayout<UInt16>.size) else {
         return nil
       }
-
-      let plaintext = try AES.CFB.decrypt(
-        Array(buffer: message),
-        using: symmetricKey,
-        nonce: .init(data: nonce)
-      )
-      guard plaintext.count == message.readableBytes else {
-        throw CodingError.failedToParseDataSize
-      }
-      message.clear()
-      message.writeBytes(plaintext)
+      try decryptCFB(&frameLengthData)
 
       padding = nextPadding()
 
-      guard let frameLength = try parseLength(from: &message) else {
+      guard let frameLength = try parseLength(from: &frameLengthData) else {
         // There, we have already got enough bytes to parse frame length but still failed, so we
         // need throw error.
         throw CodingError.failedToParseDataSize
       }
-
-      // We don't actual read the payload length data while parsing, so there the full frame
-      // length should contain payload length data size.
-      return (frameLength + payloadLengthDataSize, padding)
+      return (frameLength, padding)
     case .aes128Gcm, .chaCha20Poly1305:
       // Both `AES.GCM.tagSize` and `ChaChaPoly.tagSize` are 16.
       let tagDataLength = 16
@@ -250,30 +311,23 @@ private class BetterVMESSParser {
         return (frameLength, padding)
       }
 
-      var symmetricKey = KDF.deriveKey(
-        inputKeyMaterial: .init(data: symmetricKey),
-        info: Array("auth_len".utf8)
-      )
-      let nonce = withUnsafeBytes(of: nonceLeading.bigEndian) {
-        Array($0) + Array(self.nonce.prefix(12).suffix(10))
+      guard let opener = lengthOpener else {
+        throw CodingError.operationUnsupported
       }
-
-      if contentSecurity == .aes128Gcm {
-        let sealedBox = try AES.GCM.SealedBox(combined: nonce + Array(buffer: frameLengthData))
-        let frameLengthData = try AES.GCM.open(sealedBox, using: symmetricKey)
-        let frameLength = frameLengthData.withUnsafeBytes {
-          $0.load(as: UInt16.self).bigEndian + UInt16(tagDataLength)
+      let nonce = currentChunkNonce()
+
+      let frameLength = try frameLengthData.withUnsafeReadableBytes { sealed in
+        try nonce.withUnsafeBytes { nonce in
+          try withUnsafeTemporaryAllocation(
+            byteCount: MemoryLayout<UInt16>.size,
+            alignment: MemoryLayout<UInt16>.alignment
+          ) { output in
+            try opener.open(sealed, into: output, nonce: nonce)
+            return output.load(as: UInt16.self).bigEndian
+          }
         }
-        return (Int(frameLength), padding)
-      } else {
-        symmetricKey = generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
-        let sealedBox = try ChaChaPoly.SealedBox(combined: nonce + Array(buffer: frameLengthData))
-        let frameLengthData = try ChaChaPoly.open(sealedBox, using: symmetricKey)
-        let frameLength = frameLengthData.withUnsafeBytes {
-          $0.load(as: UInt16.self).bigEndian + UInt16(tagDataLength)
-        }
-        return (Int(frameLength), padding)
       }
+      return (Int(frameLength) + tagDataLength, padding)
     default:
       throw CodingError.operationUnsupported
     }
@@ -288,10 +342,7 @@ private class BetterVMESSParser {
       return Int(l)
     }
 
-    let frameLength = hasher.read(digestSize: 2).withUnsafeBytes {
-      let mask = $0.load(as: UInt16.self).bigEndian
-      return mask ^ l
-    }
+    let frameLength = keystream.readUInt16() ^ l
     return Int(frameLength)
   }
 
@@ -315,66 +366,87 @@ private class BetterVMESSParser {
       // TODO: Parse UDP Frame
       return nil
     case .aes128Cfb:
+      try decryptCFB(&message)
+
       guard options.contains(.chunkStream) else {
         return message
       }
 
-      // AES-CFB-128 decrypt...
-      let plaintext = try AES.CFB.decrypt(
-        Array(buffer: message),
-        using: symmetricKey,
-        nonce: .init(data: nonce)
-      )
-
-      message.clear()
-      message.writeBytes(plaintext)
-
-      // Those 2(`MemoryLayout<UInt16>.size`) bytes contain payload data length data,
-      // we should move reader index forward to ignore those bytes.
-      message.moveReaderIndex(forwardBy: MemoryLayout<UInt16>.size)
-      guard let code = message.readInteger(as: UInt32.self) else {
+      guard frameLength >= MemoryLayout<UInt32>.size + padding,
+        let code = message.readInteger(as: UInt32.self),
+        let payload = message.readSlice(length: message.readableBytes - padding)
+      else {
         throw CodingError.failedToParseData
       }
-      let authenticationFailure = message.withUnsafeReadableBytes { buffPtr in
+      let authenticationFailure = payload.withUnsafeReadableBytes { buffPtr in
         FNV1a32.hash(data: buffPtr) != code
       }
       guard !authenticationFailure else {
         throw CryptoKitError.authenticationFailure
       }
-      return message
+      return payload
     case .aes128Gcm, .chaCha20Poly1305:
-      // Tag for AES-GCM or ChaCha20-Poly1305 are both 16.
-      let nonce = withUnsafeBytes(of: nonceLeading.bigEndian) {
-        Array($0) + Array(self.nonce.prefix(12).suffix(10))
+      // Remove random padding bytes, the rest is `ciphertext || tag`.
+      let sealedLength = frameLength - padding
+      guard sealedLength >= ChunkSealer.tagByteCount else {
+        throw CodingError.failedToParseData
       }
-
-      // Remove random padding bytes.
-      let combined = nonce + Array(buffer: message).dropLast(padding)
-
-      message.clear()
-      if contentSecurity == .aes128Gcm {
-        let frame = try AES.GCM.open(.init(combined: combined), using: .init(data: symmetricKey))
-        message.writeBytes(frame)
-      } else {
-        let symmetricKey = generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
-        let frame = try ChaChaPoly.open(.init(combined: combined), using: symmetricKey)
-        message.writeBytes(frame)
+      let plaintextLength = sealedLength - ChunkSealer.tagByteCount
+
+      // Open the chunk from the cumulation buffer straight into its own buffer.
+      let opener = chunkOpener
+      let nonce = currentChunkNonce()
+      var frame = allocator.buffer(capacity: plaintextLength)
+      try frame.writeWithUnsafeMutableBytes(minimumWritableBytes: plaintextLength) { output in
+        try message.withUnsafeReadableBytes { sealed in
+          try nonce.withUnsafeBytes { nonce in
+            try opener.open(
+              UnsafeRawBufferPointer(rebasing: sealed.prefix(sealedLength)),
+              into: UnsafeMutableRawBufferPointer(rebasing: output.prefix(plaintextLength)),
+              nonce: nonce
+            )
+          }
+        }
+        return plaintextLength
       }
 
       nonceLeading &+= 1
-      return message
+      return frame
     default:
       throw CodingError.operationUnsupported
     }
   }
 
+  /// Returns the AEAD nonce of the current chunk.
+  private func currentChunkNonce() -> [UInt8] {
+    chunkNonce[0] = UInt8(truncatingIfNeeded: nonceLeading >> 8)
+    chunkNonce[1] = UInt8(truncatingIfNeeded: nonceLeading)
+    return chunkNonce
+  }
+
+  /// Decrypt `buffer` in place, continuing the AES-128-CFB body stream.
+  private func decryptCFB(_ buffer: inout ByteBuffer) throws {
+    let cryptor: AES.CFB.Cryptor
+    if let cfbDecryptor {
+      cryptor = cfbDecryptor
+    } else {
+      cryptor = try AES.CFB.Cryptor(
+        operation: .decrypt,
+        key: symmetricKey,
+        nonce: .init(data: nonce)
+      )
+      cfbDecryptor = cryptor
+    }
+    try buffer.withUnsafeMutableReadableBytes {
+      try cryptor.update($0)
+    }
+  }
+
   private func nextPadding() -> Int {
     guard options.contains(.chunkMasking) && options.contains(.globalPadding) else {
       return 0
     }
-    return hasher.read(digestSize: 2).withUnsafeBytes {
-      Int($0.load(as: UInt16.self).bigEndian % 64)
-    }
+    return Int(keystream.readUInt16() % 64)
   }
 }
 
@@ -399,6 +471,10 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
   private let parser: BetterVMESSParser
   private let kind: VMESSDecoderKind
   private var stopParsing = false
+  private let maximumCoalescedReadBytes: Int?
+
+  /// The body frames decoded in the current decode pass and not fired yet.
+  private var coalescedBody: ByteBuffer?
 
   /// Creates a new instance of `VMESSDecoder`.
   /// - Parameters:
@@ -407,14 +483,26 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
   ///   - nonce: Nonce for decryptor.
   ///   - options: The stream options use to control data padding and mask.
   ///   - headDecryptionStrategy: Strategy to decrypt encrypted response head. Defaults to `.useAEAD`.
+  ///   - maximumCoalescedReadBytes: If not `nil`, the body frames decoded in one decode pass are
+  ///     joined into one body part of at most this many bytes, which is fired once when the pass
+  ///     runs out of data, instead of firing one body part per frame. Defaults to `nil`.
+  ///   - instrumentation: The instrumentation to report the chunks opened per decode pass and
+  ///     failed authentication tags to. Defaults to `nil`.
   public init(
     contentSecurity: ContentSecurity,
     symmetricKey: SymmetricKey,
     nonce: [UInt8],
     options: StreamOptions,
     commandCode: CommandCode,
-    headDecryptionStrategy: ResponseHeadDecryptionStrategy = .useAEAD
+    headDecryptionStrategy: ResponseHeadDecryptionStrategy = .useAEAD,
+    maximumCoalescedReadBytes: Int? = nil,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) {
+    precondition(
+      maximumCoalescedReadBytes.map { $0 > 0 } ?? true,
+      "maximumCoalescedReadBytes must be positive"
+    )
+    self.maximumCoalescedReadBytes = maximumCoalescedReadBytes
     if Out.self == VMESSPart<VMESSResponseHead, ByteBuffer>.self {
       self.kind = .response
     } else {
@@ -427,7 +515,8 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
       nonce: nonce,
       options: options,
       commandCode: commandCode,
-      headDecryptionStrategy: headDecryptionStrategy
+      headDecryptionStrategy: headDecryptionStrategy,
+      instrumentation: instrumentation
     )
   }
 
@@ -460,8 +549,35 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
       // TODO: Receive VMESS request body frames
       break
     case .response:
-      context?.fireChannelRead(NIOAny(VMESSPart<VMESSResponseHead, ByteBuffer>.body(bytes)))
+      guard let maximumCoalescedReadBytes else {
+        context?.fireChannelRead(NIOAny(VMESSPart<VMESSResponseHead, ByteBuffer>.body(bytes)))
+        return
+      }
+      coalesceBody(bytes, maximumBytes: maximumCoalescedReadBytes)
+    }
+  }
+
+  /// Append `bytes` to the pending body, firing the pending body first if `bytes` would make it
+  /// exceed `maximumBytes`.
+  private func coalesceBody(_ bytes: ByteBuffer, maximumBytes: Int) {
+    guard var body = coalescedBody, body.readableBytes + bytes.readableBytes <= maximumBytes else {
+      flushCoalescedBody()
+      coalescedBody = bytes
+      return
+    }
+    // Drop the stored reference so appending does not copy the storage.
+    coalescedBody = nil
+    var bytes = bytes
+    body.writeBuffer(&bytes)
+    coalescedBody = body
+  }
+
+  private func flushCoalescedBody() {
+    guard let body = coalescedBody else {
+      return
     }
+    coalescedBody = nil
+    context?.fireChannelRead(NIOAny(VMESSPart<VMESSResponseHead, ByteBuffer>.body(body)))
   }
 
   func didFinishMessage() {
@@ -470,6 +586,7 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
       // TODO: Receive VMESS request end
       break
     case .response:
+      flushCoalescedBody()
       context?.fireChannelRead(NIOAny(VMESSPart<VMESSResponseHead, ByteBuffer>.end))
     }
     stopParsing = true
@@ -477,6 +594,7 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
 
   public func decoderAdded(context: ChannelHandlerContext) {
     parser.delegate = self
+    parser.allocator = context.channel.allocator
     parser.start()
   }
 
@@ -500,6 +618,7 @@ final public class VMESSDecoder<Out>: ByteToMessageDecoder, VMESSDecoderDelegate
     }
     let consumed = try parser.feedInput(buffer)
     buffer.moveReaderIndex(forwardBy: consumed)
+    flushCoalescedBody()
   }
 
   public func decode(context: ChannelHandlerContext, buffer: inout ByteBuffer) throws
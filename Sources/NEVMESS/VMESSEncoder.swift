@@ -14,6 +14,7 @@
 
 import Crypto
 import Foundation
+import NEAEAD
 import NESHAKE128
 import NIOCore
 
@@ -36,14 +37,33 @@ private class BetterVMESSWriter<In> where In: Equatable {
   private let nonce: [UInt8]
   private let options: StreamOptions
   private let commandCode: CommandCode
-  private lazy var hasher: SHAKE128 = {
+  private lazy var keystream: SHAKE128.Reader = {
     var shake128 = SHAKE128()
     shake128.update(data: nonce)
-    return shake128
+    return .init(shake128)
   }()
   private var nonceLeading = UInt16.zero
   private let headEncodingStrategy: HeadEncodingStrategy
 
+  /// The AEAD chunk nonce, the first two bytes hold `nonceLeading` and are rewritten per chunk.
+  private lazy var chunkNonce: [UInt8] = Array(nonce.prefix(12))
+  private let sessionKeys: VMESSSessionKeys
+  private lazy var chunkSealer: ChunkSealer = {
+    // contentSecurity and symmetricKey are validated during initialization.
+    try! ChunkSealer(
+      algorithm: contentSecurity == .aes128Gcm ? .aes128Gcm : .chaCha20Poly1305,
+      key: sessionKeys.payloadKey
+    )
+  }()
+
+  /// The AES-128-CFB body stream, which runs across every write of the request.
+  private var cfbEncryptor: AES.CFB.Cryptor?
+
+  private let instrumentation: (any ProxyInstrumentation)?
+
+  /// The number of chunks written so far.
+  private var chunkCount = 0
+
   init(
     authenticationCode: UInt8,
     contentSecurity: ContentSecurity,
@@ -51,7 +71,8 @@ private class BetterVMESSWriter<In> where In: Equatable {
     nonce: [UInt8],
     options: StreamOptions,
     commandCode: CommandCode,
-    headEncodingStrategy: HeadEncodingStrategy = .useAEAD
+    headEncodingStrategy: HeadEncodingStrategy = .useAEAD,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) {
     if In.self == VMESSPart<VMESSRequestHead, ByteBuffer>.self {
       self.kind = .request
@@ -94,28 +115,267 @@ private class BetterVMESSWriter<In> where In: Equatable {
     self.options = options
     self.commandCode = commandCode
     self.headEncodingStrategy = headEncodingStrategy
+    self.instrumentation = instrumentation
+    self.sessionKeys = VMESSSessionKeys(
+      symmetricKey: symmetricKey,
+      contentSecurity: self.contentSecurity,
+      options: options
+    )
   }
 
-  func write(_ part: In) throws -> Data {
+  func write(_ part: In, allocator: ByteBufferAllocator) throws -> ByteBuffer {
     switch kind {
     case .request:
       let part = part as! VMESSPart<VMESSRequestHead, ByteBuffer>
-      let bytes: Data
       switch part {
       case .head(let headT):
-        bytes = try prepareInstruction(request: headT)
+        return allocator.buffer(bytes: try prepareInstruction(request: headT))
       case .body(let bodyT):
-        bytes = try prepareFrame(data: bodyT)
+        guard let instrumentation else {
+          return try prepareFrame(data: bodyT, allocator: allocator)
+        }
+        let startTime = NIODeadline.now()
+        let firstChunk = chunkCount
+        let frames = try prepareFrame(data: bodyT, allocator: allocator)
+        instrumentation.chunksProcessed(
+          chunkCount - firstChunk,
+          byteCount: bodyT.readableBytes,
+          direction: .outbound,
+          component: .vmessClient,
+          duration: .now() - startTime
+        )
+        return frames
       case .end:
-        bytes = try prepareLastFrame()
+        return try prepareLastFrame(allocator: allocator)
       }
-      return bytes
     case .response:
       throw CodingError.operationUnsupported
     }
   }
 
-  /// Prepare frame data with specified data.
+  /// Prepare frame buffer with specified data.
+  /// - Parameters:
+  ///   - data: Original data.
+  ///   - allocator: The allocator used to allocate the frame buffer.
+  /// - Returns: Encrypted frame buffer.
+  private func prepareFrame(data: ByteBuffer, allocator: ByteBufferAllocator) throws -> ByteBuffer {
+    switch contentSecurity {
+    case .aes128Gcm, .chaCha20Poly1305:
+      return try prepareAEADFrame(data: data, allocator: allocator)
+    case .aes128Cfb:
+      return try prepareCFBFrame(data: data, allocator: allocator)
+    default:
+      return allocator.buffer(bytes: try prepareFrame(data: data))
+    }
+  }
+
+  /// Prepare AEAD frames with specified data.
+  ///
+  /// The output size is reserved once and every chunk is sealed from `data` straight into the
+  /// returned buffer, so the payload is read once and written once.
+  /// - Parameters:
+  ///   - data: Original data.
+  ///   - allocator: The allocator used to allocate the frame buffer.
+  /// - Returns: Encrypted frame buffer.
+  private func prepareAEADFrame(
+    data: ByteBuffer,
+    allocator: ByteBufferAllocator
+  ) throws -> ByteBuffer {
+    var mutableData = data
+
+    let maxAllowedMemorySize = 64 * 1024 * 1024
+    guard mutableData.readableBytes + 10 <= maxAllowedMemorySize else {
+      throw CodingError.payloadTooLarge
+    }
+
+    let tagSize = ChunkSealer.tagByteCount
+
+    let packetLengthSize = options.contains(.authenticatedLength) ? 18 : 2
+
+    let maxPadding = options.contains(.chunkMasking) && options.contains(.globalPadding) ? 64 : 0
+
+    let maxLength = 2048 - tagSize - packetLengthSize - maxPadding
+
+    let estimatedChunkCount = (mutableData.readableBytes + maxLength - 1) / maxLength
+    var buffer = allocator.buffer(
+      capacity: mutableData.readableBytes
+        + estimatedChunkCount * (packetLengthSize + tagSize + maxPadding)
+    )
+
+    while mutableData.readableBytes > 0 {
+      let messageLength = min(maxLength, mutableData.readableBytes)
+
+      let padding = nextPadding()
+
+      chunkNonce[0] = UInt8(truncatingIfNeeded: nonceLeading >> 8)
+      chunkNonce[1] = UInt8(truncatingIfNeeded: nonceLeading)
+
+      guard packetLengthSize + messageLength + tagSize + padding <= 2048 else {
+        throw CodingError.payloadTooLarge
+      }
+
+      let frameLengthData = try prepareFrameLengthData(
+        frameLength: messageLength + tagSize + padding,
+        nonce: chunkNonce
+      )
+      buffer.writeBytes(frameLengthData)
+
+      let sealer = chunkSealer
+      let nonce = chunkNonce
+      try buffer.writeWithUnsafeMutableBytes(
+        minimumWritableBytes: messageLength + tagSize
+      ) { output in
+        try mutableData.withUnsafeReadableBytes { message in
+          try nonce.withUnsafeBytes { nonce in
+            try sealer.seal(
+              UnsafeRawBufferPointer(rebasing: message.prefix(messageLength)),
+              into: UnsafeMutableRawBufferPointer(rebasing: output.prefix(messageLength + tagSize)),
+              nonce: nonce
+            )
+          }
+        }
+        return messageLength + tagSize
+      }
+      mutableData.moveReaderIndex(forwardBy: messageLength)
+
+      if padding > 0 {
+        buffer.writeWithUnsafeMutableBytes(minimumWritableBytes: padding) {
+          UnsafeMutableRawBufferPointer(rebasing: $0.prefix(padding))
+            .initializeWithRandomBytes(count: padding)
+          return padding
+        }
+      }
+
+      nonceLeading &+= 1
+      chunkCount &+= 1
+    }
+
+    return buffer
+  }
+
+  /// Prepare AES-128-CFB frames with specified data.
+  ///
+  /// Every chunk is written into the returned buffer and encrypted in place before the next chunk
+  /// is written, continuing the CFB stream of previous writes, so plaintext is never buffered
+  /// beyond the chunk being built.
+  /// - Parameters:
+  ///   - data: Original data.
+  ///   - allocator: The allocator used to allocate the frame buffer.
+  /// - Returns: Encrypted frame buffer.
+  private func prepareCFBFrame(data: ByteBuffer, allocator: ByteBufferAllocator) throws
+    -> ByteBuffer
+  {
+    let cryptor = try cfbCryptor()
+
+    guard options.contains(.chunkStream) else {
+      var buffer = allocator.buffer(capacity: data.readableBytes)
+      buffer.writeImmutableBuffer(data)
+      try buffer.withUnsafeMutableReadableBytes {
+        try cryptor.update($0)
+      }
+      // The whole write is sent as one unframed chunk.
+      chunkCount &+= 1
+      return buffer
+    }
+
+    var mutableData = data
+
+    let maxAllowedMemorySize = 64 * 1024 * 1024
+    guard mutableData.readableBytes + 10 <= maxAllowedMemorySize else {
+      throw CodingError.payloadTooLarge
+    }
+
+    let checksumSize = MemoryLayout<UInt32>.size
+
+    let packetLengthSize = MemoryLayout<UInt16>.size
+
+    let maxPadding = options.contains(.chunkMasking) && options.contains(.globalPadding) ? 64 : 0
+
+    guard commandCode != .udp else {
+      // Transfer type packet, every packet is carried in exactly one chunk.
+      let padding = nextPadding()
+
+      guard packetLengthSize + checksumSize + mutableData.readableBytes + padding <= 2048 else {
+        throw CodingError.payloadTooLarge
+      }
+
+      var buffer = allocator.buffer(
+        capacity: packetLengthSize + checksumSize + mutableData.readableBytes + padding
+      )
+      try writeCFBChunk(mutableData, padding: padding, to: &buffer, using: cryptor)
+      return buffer
+    }
+
+    // Transfer type stream...
+    let maxLength = 2048 - checksumSize - packetLengthSize - maxPadding
+
+    let estimatedChunkCount = (mutableData.readableBytes + maxLength - 1) / maxLength
+    var buffer = allocator.buffer(
+      capacity: mutableData.readableBytes
+        + estimatedChunkCount * (packetLengthSize + checksumSize + maxPadding)
+    )
+
+    while mutableData.readableBytes > 0 {
+      let message = mutableData.readSlice(length: min(maxLength, mutableData.readableBytes))!
+
+      let padding = nextPadding()
+
+      try writeCFBChunk(message, padding: padding, to: &buffer, using: cryptor)
+    }
+
+    return buffer
+  }
+
+  /// Write one AES-128-CFB chunk to `buffer` and encrypt it in place.
+  ///
+  /// A chunk is made of the frame length field, the FNV-1a checksum of `message`, `message`
+  /// itself and `padding` random bytes.
+  private func writeCFBChunk(
+    _ message: ByteBuffer,
+    padding: Int,
+    to buffer: inout ByteBuffer,
+    using cryptor: AES.CFB.Cryptor
+  ) throws {
+    let chunkOffset = buffer.readableBytes
+
+    let frameLengthData = try prepareFrameLengthData(
+      frameLength: MemoryLayout<UInt32>.size + message.readableBytes + padding,
+      nonce: []
+    )
+    buffer.writeBytes(frameLengthData)
+    buffer.writeInteger(message.withUnsafeReadableBytes { FNV1a32.hash(data: $0) })
+    buffer.writeImmutableBuffer(message)
+
+    if padding > 0 {
+      buffer.writeWithUnsafeMutableBytes(minimumWritableBytes: padding) {
+        UnsafeMutableRawBufferPointer(rebasing: $0.prefix(padding))
+          .initializeWithRandomBytes(count: padding)
+        return padding
+      }
+    }
+
+    try buffer.withUnsafeMutableReadableBytes {
+      try cryptor.update(UnsafeMutableRawBufferPointer(rebasing: $0[chunkOffset...]))
+    }
+    chunkCount &+= 1
+  }
+
+  /// Returns the AES-128-CFB body stream, creating it on first use.
+  private func cfbCryptor() throws -> AES.CFB.Cryptor {
+    if let cfbEncryptor {
+      return cfbEncryptor
+    }
+    let cryptor = try AES.CFB.Cryptor(
+      operation: .encrypt,
+      key: symmetricKey,
+      nonce: .init(data: nonce)
+    )
+    cfbEncryptor = cryptor
+    return cryptor
+  }
+
+  /// Prepare frame data with specified data for content securities other than AEAD and
+  /// AES-128-CFB.
   /// - Parameter data: Original data.
   /// - Returns: Encrypted frame data.
   private func prepareFrame(data: ByteBuffer) throws -> Data {
@@ -128,6 +388,8 @@ private class BetterVMESSWriter<In> where In: Equatable {
     case .none:
       guard options.contains(.chunkStream) else {
         finalize = Data(Array(buffer: mutableData))
+        // The whole write is sent as one unframed chunk.
+        chunkCount &+= 1
         return finalize
       }
 
@@ -140,6 +402,7 @@ private class BetterVMESSWriter<In> where In: Equatable {
           let frameLengthData = try prepareFrameLengthData(frameLength: sliceLength, nonce: [])
           finalize += frameLengthData
           finalize += slice
+          chunkCount &+= 1
         }
         return finalize
       }
@@ -169,138 +432,7 @@ private class BetterVMESSWriter<In> where In: Equatable {
         }
         finalize += paddingData
       }
-      return finalize
-    case .aes128Cfb:
-      guard options.contains(.chunkStream) else {
-        finalize = try AES.CFB.encrypt(
-          Array(buffer: data),
-          using: symmetricKey,
-          nonce: .init(data: nonce)
-        )
-        return finalize
-      }
-
-      guard commandCode == .udp else {
-        // Transfer type stream...
-        let maxAllowedMemorySize = 64 * 1024 * 1024
-        guard mutableData.readableBytes + 10 <= maxAllowedMemorySize else {
-          throw CodingError.payloadTooLarge
-        }
-
-        let maxPadding =
-          options.contains(.chunkMasking) && options.contains(.globalPadding) ? 64 : 0
-
-        let packetLengthDataSize = 2
-
-        maxLength = 2048 - MemoryLayout<UInt32>.size - packetLengthDataSize - maxPadding
-
-        while mutableData.readableBytes > 0 {
-          let message =
-            mutableData.readBytes(length: min(maxLength, mutableData.readableBytes)) ?? []
-
-          let padding = nextPadding()
-
-          var frame = Data()
-
-          withUnsafeBytes(of: FNV1a32.hash(data: message).bigEndian) { buffPtr in
-            frame.append(contentsOf: buffPtr)
-          }
-
-          frame += message
-
-          guard packetLengthDataSize + frame.count + padding <= 2048 else {
-            throw CodingError.payloadTooLarge
-          }
-
-          let frameLengthData = try prepareFrameLengthData(
-            frameLength: message.count + MemoryLayout<UInt32>.size + padding,
-            nonce: []
-          )
-
-          finalize += frameLengthData
-          finalize += frame
-
-          if padding > 0 {
-            var paddingData = Data(repeating: .zero, count: padding)
-            paddingData.withUnsafeMutableBytes {
-              $0.initializeWithRandomBytes(count: padding)
-            }
-            finalize += paddingData
-          }
-        }
-
-        finalize = try AES.CFB.encrypt(
-          finalize,
-          using: symmetricKey,
-          nonce: .init(data: nonce)
-        )
-        return finalize
-      }
-
-      // TODO: AES-CFB-128 UDP Frame Encoding
-      return finalize
-    case .aes128Gcm, .chaCha20Poly1305:
-      let maxAllowedMemorySize = 64 * 1024 * 1024
-      guard mutableData.readableBytes + 10 <= maxAllowedMemorySize else {
-        throw CodingError.payloadTooLarge
-      }
-
-      let packetLengthSize = options.contains(.authenticatedLength) ? 18 : 2
-
-      let maxPadding = options.contains(.chunkMasking) && options.contains(.globalPadding) ? 64 : 0
-
-      maxLength = 2048 - 16 - packetLengthSize - maxPadding
-
-      while mutableData.readableBytes > 0 {
-        let message = mutableData.readBytes(length: min(maxLength, mutableData.readableBytes)) ?? []
-
-        let padding = nextPadding()
-
-        let nonce = withUnsafeBytes(of: nonceLeading.bigEndian) {
-          Array($0) + Array(self.nonce.prefix(12).suffix(10))
-        }
-
-        let frame: Data
-        if contentSecurity == .aes128Gcm {
-          let sealedBox = try AES.GCM.seal(
-            message,
-            using: .init(data: symmetricKey),
-            nonce: .init(data: nonce)
-          )
-          frame = sealedBox.ciphertext + sealedBox.tag
-        } else {
-          let symmetricKey = generateChaChaPolySymmetricKey(inputKeyMaterial: self.symmetricKey)
-          let sealedBox = try ChaChaPoly.seal(
-            message,
-            using: .init(data: symmetricKey),
-            nonce: .init(data: nonce)
-          )
-          frame = sealedBox.ciphertext + sealedBox.tag
-        }
-
-        guard packetLengthSize + frame.count + padding <= 2048 else {
-          throw CodingError.payloadTooLarge
-        }
-
-        let frameLengthData = try prepareFrameLengthData(
-          frameLength: frame.count + padding,
-          nonce: nonce
-        )
-
-        finalize += frameLengthData
-        finalize += frame
-
-        if padding > 0 {
-          var paddingData = Data(repeating: .zero, count: padding)
-          paddingData.withUnsafeMutableBytes {
-            $0.initializeWithRandomBytes(count: padding)
-          }
-          finalize += paddingData
-        }
-
-        nonceLeading &+= 1
-      }
-
+      chunkCount &+= 1
       return finalize
     default:
       throw CodingError.operationUnsupported
@@ -318,14 +450,12 @@ private class BetterVMESSWriter<In> where In: Equatable {
   /// - Returns: The encrypted frame length field data.
   private func prepareFrameLengthData(frameLength: Int, nonce: [UInt8]) throws -> Data {
     if options.contains(.authenticatedLength) {
+      guard let symmetricKey = sessionKeys.lengthKey else {
+        throw CodingError.operationUnsupported
+      }
       return try withUnsafeBytes(
         of: UInt16(frameLength - 16).bigEndian
       ) {
-        var symmetricKey = KDF.deriveKey(
-          inputKeyMaterial: .init(data: symmetricKey),
-          info: Data("auth_len".utf8)
-        )
-
         if contentSecurity == .aes128Gcm {
           let sealedBox = try AES.GCM.seal(
             $0,
@@ -334,7 +464,6 @@ private class BetterVMESSWriter<In> where In: Equatable {
           )
           return sealedBox.ciphertext + sealedBox.tag
         } else {
-          symmetricKey = generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
           let sealedBox = try ChaChaPoly.seal(
             $0,
             using: symmetricKey,
@@ -344,11 +473,9 @@ private class BetterVMESSWriter<In> where In: Equatable {
         }
       }
     } else if options.contains(.chunkMasking) {
-      return hasher.read(digestSize: 2).withUnsafeBytes {
-        let mask = $0.load(as: UInt16.self).bigEndian
-        return withUnsafeBytes(of: (mask ^ UInt16(frameLength)).bigEndian) {
-          Data($0)
-        }
+      let mask = keystream.readUInt16()
+      return withUnsafeBytes(of: (mask ^ UInt16(frameLength)).bigEndian) {
+        Data($0)
       }
     } else {
       return withUnsafeBytes(of: UInt16(frameLength).bigEndian) {
@@ -360,22 +487,21 @@ private class BetterVMESSWriter<In> where In: Equatable {
   /// Prepare last frame data.
   ///
   /// If request should trunk stream then return encrypted empty buffer as END part data else just return empty data.
-  /// - Returns: Encrypted last frame data.
-  private func prepareLastFrame() throws -> Data {
+  /// - Parameter allocator: The allocator used to allocate the frame buffer.
+  /// - Returns: Encrypted last frame buffer.
+  private func prepareLastFrame(allocator: ByteBufferAllocator) throws -> ByteBuffer {
     guard options.contains(.chunkStream) else {
-      return .init()
+      return allocator.buffer(capacity: 0)
     }
 
-    return try prepareFrame(data: .init())
+    return try prepareFrame(data: .init(), allocator: allocator)
   }
 
   private func nextPadding() -> Int {
     guard options.contains(.chunkMasking) && options.contains(.globalPadding) else {
       return 0
     }
-    return hasher.read(digestSize: 2).withUnsafeBytes {
-      Int($0.load(as: UInt16.self).bigEndian % 64)
-    }
+    return Int(keystream.readUInt16() % 64)
   }
 }
 
@@ -430,10 +556,11 @@ extension BetterVMESSWriter {
   private func prepareInstruction(request: VMESSRequestHead) throws -> Data {
     let instructionData = prepareInstruction0(request: request)
 
-    let material = generateCmdKey(request.user)
+    let userKeys = VMESSUserKeyCache.shared.keys(for: request.user)
+    let material = userKeys.cmdKey
 
     if case .useAEAD = headEncodingStrategy {
-      let authenticatedData = try prepareAEADHeaderData(material)
+      let authenticatedData = try prepareAEADHeaderData(userKeys.authIDKeySchedule)
       var randomPath = Array(repeating: UInt8.zero, count: 8)
       randomPath.withUnsafeMutableBytes {
         $0.initializeWithRandomBytes(count: 8)
@@ -511,9 +638,9 @@ extension BetterVMESSWriter {
   }
 
   /// Generate authenticated data with specified key.
-  /// - Parameter key: Input key material.
+  /// - Parameter keySchedule: The expanded AuthID encryption key.
   /// - Returns: Encrypted authenticated data bytes.
-  private func prepareAEADHeaderData(_ key: SymmetricKey) throws -> Data {
+  private func prepareAEADHeaderData(_ keySchedule: AES.ECB.KeySchedule) throws -> Data {
     let timeIntervalSince1970 = UInt64(Date().timeIntervalSince1970)
     var byteBuffer = withUnsafeBytes(of: timeIntervalSince1970.bigEndian) {
       Array($0)
@@ -526,11 +653,7 @@ extension BetterVMESSWriter {
     byteBuffer += randomBytes
     byteBuffer += withUnsafeBytes(of: CRC32.checksum(byteBuffer).bigEndian, Array.init)
 
-    let kDFSaltConstAuthIDEncryptionKey = Data("AES Auth ID Encryption".utf8)
-
-    let key = KDF.deriveKey(inputKeyMaterial: key, info: kDFSaltConstAuthIDEncryptionKey)
-
-    let ciphertext = try AES.ECB.encrypt(byteBuffer, using: key)
+    let ciphertext = try AES.ECB.encrypt(byteBuffer, using: keySchedule)
     // We only need 16 bytes.
     return ciphertext.prefix(16)
   }
@@ -553,13 +676,13 @@ extension ByteBuffer {
         + self.writeInteger(UInt8(string.utf8.count))
         + self.writeString(string)
     case .ipv4(let iPv4Address):
-      return self.writeInteger(port.rawValue.bigEndian)
+      return self.writeInteger(port.rawValue)
         + self.writeInteger(UInt8(1))
-        + self.writeBytes(iPv4Address.rawValue)
+        + self.writeIPv4Address(iPv4Address)
     case .ipv6(let iPv6Address):
-      return self.writeInteger(port.rawValue.bigEndian)
+      return self.writeInteger(port.rawValue)
         + self.writeInteger(UInt8(3))
-        + self.writeBytes(iPv6Address.rawValue)
+        + self.writeIPv6Address(iPv6Address)
     #if canImport(Network)
     @unknown default:
       assertionFailure("Unhandle case of NWEndpoint.Host \(host)")
@@ -588,13 +711,17 @@ final public class VMESSEncoder<In: Equatable>: ChannelOutboundHandler {
   ///   - symmetricKey: SymmetricKey for encryptor.
   ///   - nonce: Nonce for encryptor.
   ///   - options: The stream options use to control data padding and mask.
+  ///   - commandCode: Command code for VMESS request.
+  ///   - instrumentation: The instrumentation to report the chunks sealed per write to. Defaults to
+  ///     `nil`.
   public init(
     authenticationCode: UInt8,
     contentSecurity: ContentSecurity,
     symmetricKey: SymmetricKey,
     nonce: [UInt8],
     options: StreamOptions,
-    commandCode: CommandCode
+    commandCode: CommandCode,
+    instrumentation: (any ProxyInstrumentation)? = nil
   ) {
     guard In.self == VMESSPart<VMESSRequestHead, ByteBuffer>.self else {
       preconditionFailure("unsupported VMESS message type \(In.self)")
@@ -605,15 +732,18 @@ final public class VMESSEncoder<In: Equatable>: ChannelOutboundHandler {
       symmetricKey: symmetricKey,
       nonce: nonce,
       options: options,
-      commandCode: commandCode
+      commandCode: commandCode,
+      instrumentation: instrumentation
     )
   }
 
   public func write(context: ChannelHandlerContext, data: NIOAny, promise: EventLoopPromise<Void>?)
   {
     do {
-      let bytes = try writer.write(unwrapOutboundIn(data))
-      let outboundOut = context.channel.allocator.buffer(bytes: bytes)
+      let outboundOut = try writer.write(
+        unwrapOutboundIn(data),
+        allocator: context.channel.allocator
+      )
       context.write(wrapOutboundOut(outboundOut), promise: promise)
     } catch {
       promise?.fail(error)
@@ -33,3 +33,15 @@ public enum CodingError: Error {
 
   case payloadTooLarge
 }
+
+public enum VMESSMuxError: Error, Sendable {
+
+  /// The mux session is closed or its tunnel is not active.
+  case sessionClosed
+
+  /// The mux session carries the maximum number of concurrent streams already.
+  case tooManyStreams
+
+  /// The stream channel is not on the event loop of the mux session.
+  case eventLoopMismatch
+}
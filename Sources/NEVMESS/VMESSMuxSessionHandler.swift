@@ -0,0 +1,385 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import _NELinux
+
+/// A handle to a VMESS mux session that is safe to use from any thread.
+///
+/// A session carries many streams over one VMESS `.mux` tunnel in Mux.Cool frames, so that
+/// flows to different destinations share one connection and one VMESS header handshake.
+public struct VMESSMuxSession: Sendable {
+
+  /// The event loop of the tunnel channel, stream channels must be on this event loop.
+  public let eventLoop: EventLoop
+
+  private let handler: NIOLoopBound<VMESSMuxSessionHandler>
+
+  init(handler: VMESSMuxSessionHandler, eventLoop: EventLoop) {
+    self.eventLoop = eventLoop
+    self.handler = NIOLoopBound(handler, eventLoop: eventLoop)
+  }
+
+  /// Open a stream to `destination` that carries the traffic of `channel`.
+  ///
+  /// Bytes read from `channel` are sent to `destination` and bytes received from `destination`
+  /// are written to `channel`. The stream is closed when either side closes.
+  ///
+  /// - Parameters:
+  ///   - destination: The destination of the stream.
+  ///   - channel: The channel carried by the stream, it must be on `eventLoop`.
+  /// - Returns: An `EventLoopFuture` that will fire when the stream is open.
+  public func openStream(to destination: NWEndpoint, on channel: Channel) -> EventLoopFuture<Void>
+  {
+    guard eventLoop.inEventLoop else {
+      return eventLoop.flatSubmit {
+        self.openStream(to: destination, on: channel)
+      }
+    }
+    return handler.value.openStream(to: destination, on: channel)
+  }
+}
+
+/// A channel handler that multiplexes streams over a VMESS `.mux` tunnel in Mux.Cool frames.
+///
+/// Streams with queued data are served round robin, one frame of at most
+/// `maximumFramePayloadSize` bytes per turn, so a bulk transfer cannot starve interactive
+/// streams. Mux.Cool has no flow control frames, so streams are flow controlled locally: a stream
+/// channel stops being read while `maximumBufferedBytesPerStream` of its bytes wait for the
+/// tunnel, and the tunnel stops being read while a stream channel has that many bytes waiting to
+/// be written.
+final class VMESSMuxSessionHandler: ChannelDuplexHandler {
+
+  typealias InboundIn = ByteBuffer
+
+  typealias OutboundIn = ByteBuffer
+
+  typealias OutboundOut = ByteBuffer
+
+  private struct Stream {
+    var handler: VMESSMuxStreamHandler
+    var queue = CircularBuffer<ByteBuffer>(initialCapacity: 4)
+    var queuedBytes = 0
+    var isReadingPaused = false
+    var isReady = false
+    var isClosing = false
+  }
+
+  /// The maximum data byte count of one frame.
+  static let maximumFramePayloadSize = 16 * 1024
+
+  /// The maximum frame count written to the tunnel in one write.
+  private static let maximumFramesPerWrite = 8
+
+  private let maximumConcurrentStreams: Int
+
+  private let maximumBufferedBytesPerStream: Int
+
+  private var context: ChannelHandlerContext?
+
+  private var streams: [UInt16: Stream] = [:]
+
+  /// Streams with queued data in the order they are served.
+  private var readyStreams = CircularBuffer<UInt16>(initialCapacity: 8)
+
+  private var lastStreamID: UInt16 = 0
+
+  /// Streams whose channel has too many bytes waiting to be written.
+  private var blockedStreams: Set<UInt16> = []
+
+  /// Streams that were written to since the last flush.
+  private var unflushedStreams: Set<UInt16> = []
+
+  private var isReadPending = false
+
+  private var cumulationBuffer: ByteBuffer?
+
+  init(maximumConcurrentStreams: Int = 8, maximumBufferedBytesPerStream: Int = 64 * 1024) {
+    self.maximumConcurrentStreams = maximumConcurrentStreams
+    self.maximumBufferedBytesPerStream = maximumBufferedBytesPerStream
+  }
+
+  func handlerAdded(context: ChannelHandlerContext) {
+    self.context = context
+  }
+
+  func handlerRemoved(context: ChannelHandlerContext) {
+    closeAllStreams()
+    self.context = nil
+  }
+
+  func channelInactive(context: ChannelHandlerContext) {
+    closeAllStreams()
+    context.fireChannelInactive()
+  }
+
+  func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    var buffer = unwrapInboundIn(data)
+    if cumulationBuffer == nil {
+      cumulationBuffer = buffer
+    } else {
+      cumulationBuffer!.writeBuffer(&buffer)
+    }
+
+    do {
+      while let frame = try cumulationBuffer?.readMuxFrame() {
+        handleFrame(frame)
+      }
+    } catch {
+      cumulationBuffer = nil
+      context.fireErrorCaught(error)
+      context.close(promise: nil)
+      return
+    }
+
+    if cumulationBuffer?.readableBytes == 0 {
+      cumulationBuffer = nil
+    }
+  }
+
+  func channelReadComplete(context: ChannelHandlerContext) {
+    for streamID in unflushedStreams {
+      streams[streamID]?.handler.flush()
+    }
+    unflushedStreams.removeAll(keepingCapacity: true)
+    context.fireChannelReadComplete()
+  }
+
+  func channelWritabilityChanged(context: ChannelHandlerContext) {
+    if context.channel.isWritable {
+      writeReadyStreams()
+    }
+    context.fireChannelWritabilityChanged()
+  }
+
+  func read(context: ChannelHandlerContext) {
+    guard blockedStreams.isEmpty else {
+      isReadPending = true
+      return
+    }
+    context.read()
+  }
+
+  private func handleFrame(_ frame: MuxFrame) {
+    switch frame.status {
+    case .new:
+      // Only the server side of a mux session accepts new streams.
+      writeFrame(.init(sessionID: frame.sessionID, status: .end))
+    case .keep:
+      guard let stream = streams[frame.sessionID] else {
+        writeFrame(.init(sessionID: frame.sessionID, status: .end))
+        return
+      }
+      if let data = frame.data, data.readableBytes > 0 {
+        stream.handler.deliver(data)
+        unflushedStreams.insert(frame.sessionID)
+      }
+    case .end:
+      guard let stream = streams.removeValue(forKey: frame.sessionID) else {
+        return
+      }
+      if let data = frame.data, data.readableBytes > 0 {
+        stream.handler.deliver(data)
+        stream.handler.flush()
+      }
+      unflushedStreams.remove(frame.sessionID)
+      setDownlinkBlocked(false, streamID: frame.sessionID)
+      stream.handler.close()
+    case .keepAlive:
+      break
+    }
+  }
+}
+
+extension VMESSMuxSessionHandler {
+
+  /// Open a stream to `destination` for `channel`.
+  func openStream(to destination: NWEndpoint, on channel: Channel) -> EventLoopFuture<Void> {
+    guard let context, context.channel.isActive else {
+      return channel.eventLoop.makeFailedFuture(VMESSMuxError.sessionClosed)
+    }
+    guard channel.eventLoop === context.eventLoop else {
+      return channel.eventLoop.makeFailedFuture(VMESSMuxError.eventLoopMismatch)
+    }
+    guard streams.count < maximumConcurrentStreams else {
+      return context.eventLoop.makeFailedFuture(VMESSMuxError.tooManyStreams)
+    }
+
+    repeat {
+      lastStreamID &+= 1
+    } while lastStreamID == 0 || streams[lastStreamID] != nil
+    let streamID = lastStreamID
+
+    let handler = VMESSMuxStreamHandler(
+      streamID: streamID,
+      session: self,
+      maximumBufferedBytes: maximumBufferedBytesPerStream
+    )
+    streams[streamID] = Stream(handler: handler)
+    writeFrame(
+      .init(sessionID: streamID, status: .new, network: .tcp, destination: destination)
+    )
+
+    do {
+      try channel.pipeline.syncOperations.addHandler(handler)
+    } catch {
+      streamDidClose(streamID: streamID)
+      return context.eventLoop.makeFailedFuture(error)
+    }
+    return context.eventLoop.makeSucceededVoidFuture()
+  }
+
+  /// Queue `data` read from the channel of stream `streamID` for the tunnel.
+  func enqueue(_ data: ByteBuffer, streamID: UInt16) {
+    guard var stream = streams[streamID], !stream.isClosing, data.readableBytes > 0 else {
+      return
+    }
+    stream.queue.append(data)
+    stream.queuedBytes += data.readableBytes
+    let shouldPauseReading =
+      !stream.isReadingPaused && stream.queuedBytes >= maximumBufferedBytesPerStream
+    if shouldPauseReading {
+      stream.isReadingPaused = true
+    }
+    if !stream.isReady {
+      stream.isReady = true
+      readyStreams.append(streamID)
+    }
+    streams[streamID] = stream
+
+    if shouldPauseReading {
+      stream.handler.setReadingPaused(true)
+    }
+  }
+
+  /// Close stream `streamID` after its queued data is written, the channel of the stream is
+  /// closed or its handler is removed.
+  func streamDidClose(streamID: UInt16) {
+    guard var stream = streams[streamID] else {
+      return
+    }
+    unflushedStreams.remove(streamID)
+    setDownlinkBlocked(false, streamID: streamID)
+
+    guard stream.queue.isEmpty else {
+      stream.isClosing = true
+      streams[streamID] = stream
+      writeReadyStreams()
+      return
+    }
+    streams[streamID] = nil
+    writeFrame(.init(sessionID: streamID, status: .end))
+  }
+
+  /// Block reading the tunnel while the channel of stream `streamID` has too many bytes waiting
+  /// to be written.
+  func setDownlinkBlocked(_ blocked: Bool, streamID: UInt16) {
+    if blocked {
+      blockedStreams.insert(streamID)
+      return
+    }
+    guard blockedStreams.remove(streamID) != nil, blockedStreams.isEmpty, isReadPending else {
+      return
+    }
+    isReadPending = false
+    context?.read()
+  }
+
+  /// Write frames of ready streams to the tunnel, one frame per stream per turn.
+  func writeReadyStreams() {
+    guard let context else {
+      return
+    }
+
+    var buffer = context.channel.allocator.buffer(capacity: 0)
+    var frameCount = 0
+    var resumedStreams: [VMESSMuxStreamHandler] = []
+    while context.channel.isWritable, frameCount < Self.maximumFramesPerWrite,
+      let streamID = readyStreams.popFirst()
+    {
+      guard var stream = streams[streamID] else {
+        continue
+      }
+      stream.isReady = false
+
+      if var data = stream.queue.popFirst() {
+        // swift-format-ignore: NeverForceUnwrap
+        let payload = data.readSlice(
+          length: min(data.readableBytes, Self.maximumFramePayloadSize)
+        )!
+        if data.readableBytes > 0 {
+          stream.queue.prepend(data)
+        }
+        stream.queuedBytes -= payload.readableBytes
+        buffer.writeMuxFrame(.init(sessionID: streamID, status: .keep, data: payload))
+        frameCount += 1
+      }
+
+      if stream.isReadingPaused && stream.queuedBytes <= maximumBufferedBytesPerStream / 2 {
+        stream.isReadingPaused = false
+        resumedStreams.append(stream.handler)
+      }
+
+      if !stream.queue.isEmpty {
+        stream.isReady = true
+        readyStreams.append(streamID)
+        streams[streamID] = stream
+      } else if stream.isClosing {
+        buffer.writeMuxFrame(.init(sessionID: streamID, status: .end))
+        streams[streamID] = nil
+      } else {
+        streams[streamID] = stream
+      }
+    }
+
+    if buffer.readableBytes > 0 {
+      if readyStreams.isEmpty {
+        context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+      } else {
+        // Serve the remaining streams once this write is done, so that one write never grows
+        // beyond `maximumFramesPerWrite` frames.
+        context.writeAndFlush(wrapOutboundOut(buffer)).whenSuccess {
+          self.writeReadyStreams()
+        }
+      }
+    }
+
+    for handler in resumedStreams {
+      handler.setReadingPaused(false)
+    }
+  }
+
+  private func writeFrame(_ frame: MuxFrame) {
+    guard let context else {
+      return
+    }
+    var buffer = context.channel.allocator.buffer(capacity: 16)
+    buffer.writeMuxFrame(frame)
+    context.writeAndFlush(wrapOutboundOut(buffer), promise: nil)
+  }
+
+  private func closeAllStreams() {
+    let handlers = streams.values.map(\.handler)
+    streams.removeAll()
+    readyStreams.removeAll()
+    blockedStreams.removeAll()
+    unflushedStreams.removeAll()
+    for handler in handlers {
+      handler.close()
+    }
+  }
+}
+
+@available(*, unavailable)
+extension VMESSMuxSessionHandler: Sendable {}
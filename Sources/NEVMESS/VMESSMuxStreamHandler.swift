@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+
+/// A channel handler that bridges a channel to one stream of a `VMESSMuxSessionHandler`.
+///
+/// Bytes read from the channel are queued on the session, reading pauses while the session has
+/// too many of them queued. Bytes received on the stream are written to the channel, the session
+/// stops reading the tunnel while too many of them wait to be written.
+final class VMESSMuxStreamHandler: ChannelDuplexHandler {
+
+  typealias InboundIn = ByteBuffer
+
+  typealias OutboundIn = ByteBuffer
+
+  typealias OutboundOut = ByteBuffer
+
+  let streamID: UInt16
+
+  private var session: VMESSMuxSessionHandler?
+
+  private let maximumBufferedBytes: Int
+
+  private var context: ChannelHandlerContext?
+
+  private var isReadingPaused = false
+
+  private var isReadPending = false
+
+  /// The byte count written to the channel whose writes are not completed yet.
+  private var bytesInFlight = 0
+
+  private var isDownlinkBlocked = false
+
+  init(streamID: UInt16, session: VMESSMuxSessionHandler, maximumBufferedBytes: Int) {
+    self.streamID = streamID
+    self.session = session
+    self.maximumBufferedBytes = maximumBufferedBytes
+  }
+
+  func handlerAdded(context: ChannelHandlerContext) {
+    self.context = context
+  }
+
+  func handlerRemoved(context: ChannelHandlerContext) {
+    detach()
+    self.context = nil
+  }
+
+  func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    session?.enqueue(unwrapInboundIn(data), streamID: streamID)
+  }
+
+  func channelReadComplete(context: ChannelHandlerContext) {
+    session?.writeReadyStreams()
+    context.fireChannelReadComplete()
+  }
+
+  func channelInactive(context: ChannelHandlerContext) {
+    detach()
+    context.fireChannelInactive()
+  }
+
+  func errorCaught(context: ChannelHandlerContext, error: Error) {
+    context.fireErrorCaught(error)
+    context.close(promise: nil)
+  }
+
+  func read(context: ChannelHandlerContext) {
+    guard !isReadingPaused else {
+      isReadPending = true
+      return
+    }
+    context.read()
+  }
+}
+
+extension VMESSMuxStreamHandler {
+
+  func setReadingPaused(_ paused: Bool) {
+    isReadingPaused = paused
+    guard !paused, isReadPending else {
+      return
+    }
+    isReadPending = false
+    context?.read()
+  }
+
+  /// Write `data` received on the stream to the channel, it is flushed on `flush()`.
+  func deliver(_ data: ByteBuffer) {
+    guard let context else {
+      return
+    }
+
+    let byteCount = data.readableBytes
+    bytesInFlight += byteCount
+    if !isDownlinkBlocked && bytesInFlight >= maximumBufferedBytes {
+      isDownlinkBlocked = true
+      session?.setDownlinkBlocked(true, streamID: streamID)
+    }
+
+    context.write(wrapOutboundOut(data)).whenComplete { _ in
+      self.bytesInFlight -= byteCount
+      if self.isDownlinkBlocked && self.bytesInFlight <= self.maximumBufferedBytes / 2 {
+        self.isDownlinkBlocked = false
+        self.session?.setDownlinkBlocked(false, streamID: self.streamID)
+      }
+    }
+  }
+
+  func flush() {
+    context?.flush()
+  }
+
+  /// Close the channel because the stream is closed by the session.
+  func close() {
+    session = nil
+    context?.close(promise: nil)
+  }
+
+  private func detach() {
+    let session = self.session
+    self.session = nil
+    session?.streamDidClose(streamID: streamID)
+  }
+}
+
+@available(*, unavailable)
+extension VMESSMuxStreamHandler: Sendable {}
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+
+/// The body keys of one VMESS request or response, derived once when the session starts.
+///
+/// These keys only depend on the body key, the content security and the stream options, so
+/// deriving them per chunk only repeats the same KDF and MD5 work.
+struct VMESSSessionKeys {
+
+  /// The key that seals and opens chunk payloads.
+  ///
+  /// This is the body key for AES-128-GCM and the MD5-expanded body key for ChaCha20-Poly1305.
+  let payloadKey: SymmetricKey
+
+  /// The key that seals and opens chunk lengths, `nil` unless `.authenticatedLength` is used with
+  /// an AEAD content security.
+  let lengthKey: SymmetricKey?
+
+  /// Derives the session keys for the body key `symmetricKey`.
+  /// - Parameters:
+  ///   - symmetricKey: The body key.
+  ///   - contentSecurity: The security type used to encrypt the body.
+  ///   - options: The stream options.
+  init(symmetricKey: SymmetricKey, contentSecurity: ContentSecurity, options: StreamOptions) {
+    switch contentSecurity {
+    case .aes128Gcm:
+      self.payloadKey = symmetricKey
+      guard options.contains(.authenticatedLength) else {
+        self.lengthKey = nil
+        return
+      }
+      self.lengthKey = KDF.deriveKey(inputKeyMaterial: symmetricKey, info: Data("auth_len".utf8))
+    case .chaCha20Poly1305:
+      self.payloadKey = generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
+      guard options.contains(.authenticatedLength) else {
+        self.lengthKey = nil
+        return
+      }
+      self.lengthKey = generateChaChaPolySymmetricKey(
+        inputKeyMaterial: KDF.deriveKey(inputKeyMaterial: symmetricKey, info: Data("auth_len".utf8))
+      )
+    default:
+      self.payloadKey = symmetricKey
+      self.lengthKey = nil
+    }
+  }
+}
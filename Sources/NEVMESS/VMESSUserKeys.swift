@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+import NIOConcurrencyHelpers
+
+/// The keys VMESS derives from a user ID for every request head.
+struct VMESSUserKeys: Sendable {
+
+  /// The cmdKey, MD5 of the user ID and the VMESS salt.
+  let cmdKey: SymmetricKey
+
+  /// The expanded AES key that encrypts the AEAD header AuthID.
+  let authIDKeySchedule: AES.ECB.KeySchedule
+
+  /// Derives the keys of `user`.
+  init(user: UUID) {
+    self.cmdKey = generateCmdKey(user)
+    let authIDKey = KDF.deriveKey(
+      inputKeyMaterial: cmdKey,
+      info: Data("AES Auth ID Encryption".utf8)
+    )
+    // The derived key is always 128 bits.
+    self.authIDKeySchedule = try! AES.ECB.KeySchedule(key: authIDKey)
+  }
+}
+
+/// A thread-safe cache of `VMESSUserKeys` keyed by user ID.
+///
+/// Deployments usually have few users and many connections, so the keys are derived once per
+/// user instead of once per connection. The cache is cleared when it grows beyond `capacity`,
+/// which bounds its memory when user IDs churn.
+final class VMESSUserKeyCache: Sendable {
+
+  /// The cache shared by all VMESS encoders.
+  static let shared = VMESSUserKeyCache()
+
+  private let capacity: Int
+  private let storage = NIOLockedValueBox<[UUID: VMESSUserKeys]>([:])
+
+  init(capacity: Int = 1024) {
+    self.capacity = capacity
+  }
+
+  /// Returns the keys of `user`, deriving them on first use.
+  func keys(for user: UUID) -> VMESSUserKeys {
+    if let keys = storage.withLockedValue({ $0[user] }) {
+      return keys
+    }
+
+    // Derive outside of the lock, racing derivations produce equal keys.
+    let keys = VMESSUserKeys(user: user)
+    storage.withLockedValue {
+      if $0.count >= capacity {
+        $0.removeAll(keepingCapacity: true)
+      }
+      $0[user] = keys
+    }
+    return keys
+  }
+}
@@ -14,7 +14,10 @@
 
 import Foundation
 import NIOCore
-import _NELinux
+
+#if canImport(Network)
+import Network
+#endif
 
 /// Address identifier defined in RFC 1928.
 private enum AddressFlag: UInt8 {
@@ -37,7 +40,7 @@ extension ByteBuffer {
   ///
   /// - Parameter closure: The parse operation closure.
   /// - Returns: The parsed object if success or nil.
-  mutating func parseUnwinding<T>(_ closure: (inout ByteBuffer) throws -> T?) rethrows -> T? {
+  package mutating func parseUnwinding<T>(_ closure: (inout ByteBuffer) throws -> T?) rethrows -> T? {
     let save = self
     do {
       guard let value = try closure(&self) else {
@@ -52,16 +55,75 @@ extension ByteBuffer {
   }
 }
 
+extension ByteBuffer {
+
+  /// Read an IPv4 address from the four packed address bytes at the reader index.
+  ///
+  /// - Returns: The address, or nil if fewer than four bytes are readable.
+  package mutating func readIPv4Address() -> IPv4Address? {
+    #if canImport(Network)
+    return readBytes(length: 4).flatMap { IPv4Address(Data($0)) }
+    #else
+    return readInteger(endianness: .host, as: UInt32.self).map(IPv4Address.init(packedBytes:))
+    #endif
+  }
+
+  /// Read an IPv6 address from the sixteen packed address bytes at the reader index.
+  ///
+  /// - Returns: The address, or nil if fewer than sixteen bytes are readable.
+  package mutating func readIPv6Address() -> IPv6Address? {
+    #if canImport(Network)
+    return readBytes(length: 16).flatMap { IPv6Address(Data($0)) }
+    #else
+    guard readableBytes >= 16 else {
+      return nil
+    }
+    // swift-format-ignore: NeverForceUnwrap
+    let head = readInteger(endianness: .host, as: UInt64.self)!
+    // swift-format-ignore: NeverForceUnwrap
+    let tail = readInteger(endianness: .host, as: UInt64.self)!
+    return IPv6Address(packedBytes: (head, tail))
+    #endif
+  }
+
+  /// Write the four packed address bytes of `address`.
+  /// - Parameter address: The address waiting to write.
+  /// - Returns: Byte count.
+  @discardableResult
+  package mutating func writeIPv4Address(_ address: IPv4Address) -> Int {
+    #if canImport(Network)
+    return writeBytes(address.rawValue)
+    #else
+    return writeInteger(address.packedBytes, endianness: .host)
+    #endif
+  }
+
+  /// Write the sixteen packed address bytes of `address`.
+  /// - Parameter address: The address waiting to write.
+  /// - Returns: Byte count.
+  @discardableResult
+  package mutating func writeIPv6Address(_ address: IPv6Address) -> Int {
+    #if canImport(Network)
+    return writeBytes(address.rawValue)
+    #else
+    return writeInteger(address.packedBytes.0, endianness: .host)
+      + writeInteger(address.packedBytes.1, endianness: .host)
+    #endif
+  }
+}
+
 extension ByteBuffer {
 
   /// Read `NWEndpoint` from buffer which contains RFC1928 request address formatted bytes.
   ///
   /// This method is used to parse address that encoded as SOCKS address defined in RFC 1928.
   ///
-  /// - Throws: May throw  `SocketAddressError.unsupported` if address type is illegal,
-  ///     or `SocketAddressError.FailedToParseIPByteBuffer(address:)` if failed to parse ipaddress.
+  /// - Parameter internTable: The table domain names are interned into, if any.
+  /// - Throws: May throw  `SocketAddressError.unsupported` if address type is illegal.
   /// - Returns: If success return `NetAddress` else return nil for need more bytes.
-  mutating func readRFC1928RequestAddressAsEndpoint() throws -> NWEndpoint? {
+  package mutating func readRFC1928RequestAddressAsEndpoint(
+    internTable: HostNameInternTable? = nil
+  ) throws -> NWEndpoint? {
     try parseUnwinding { buffer in
       guard let rawValue = buffer.readInteger(as: UInt8.self) else {
         return nil
@@ -71,35 +133,32 @@ extension ByteBuffer {
         throw SocketAddressError.unsupported
       }
 
+      let host: NWEndpoint.Host
       switch type {
       case .domain:
         // Unlike IPv4 and IPv6 address domain name have a variable length
-        guard let slice = buffer.readLengthPrefixedSlice(as: UInt8.self),
-          let _port = buffer.readInteger(as: UInt16.self),
-          let port = NWEndpoint.Port(rawValue: _port)
-        else {
+        guard let slice = buffer.readLengthPrefixedSlice(as: UInt8.self) else {
           return nil
         }
-        return .hostPort(host: .name(String(buffer: slice), nil), port: port)
+        host = .name(internTable?.intern(slice) ?? String(buffer: slice), nil)
       case .v4:
-        guard let packedIPAddress = buffer.readSlice(length: 4),
-          let address = IPv4Address(Data(Array(buffer: packedIPAddress))),
-          let _port = buffer.readInteger(as: UInt16.self),
-          let port = NWEndpoint.Port(rawValue: _port)
-        else {
+        guard let address = buffer.readIPv4Address() else {
           return nil
         }
-        return .hostPort(host: .ipv4(address), port: port)
+        host = .ipv4(address)
       case .v6:
-        guard let packedIPAddress = buffer.readSlice(length: 16),
-          let address = IPv6Address(Data(Array(buffer: packedIPAddress))),
-          let _port = buffer.readInteger(as: UInt16.self),
-          let port = NWEndpoint.Port(rawValue: _port)
-        else {
+        guard let address = buffer.readIPv6Address() else {
           return nil
         }
-        return .hostPort(host: .ipv6(address), port: port)
+        host = .ipv6(address)
+      }
+
+      guard let _port = buffer.readInteger(as: UInt16.self),
+        let port = NWEndpoint.Port(rawValue: _port)
+      else {
+        return nil
       }
+      return .hostPort(host: host, port: port)
     }
   }
 
@@ -107,7 +166,7 @@ extension ByteBuffer {
   /// - Parameter address: The address waiting to write.
   /// - Returns: Byte count.
   @discardableResult
-  mutating func writeEndpointInRFC1928RequestAddressFormat(_ address: NWEndpoint) -> Int {
+  package mutating func writeEndpointInRFC1928RequestAddressFormat(_ address: NWEndpoint) -> Int {
     var totalBytesWritten = 0
 
     switch address {
@@ -115,11 +174,11 @@ extension ByteBuffer {
       switch host {
       case .ipv4(let address):
         totalBytesWritten += writeInteger(AddressFlag.v4.rawValue)
-        totalBytesWritten += writeBytes(address.rawValue)
+        totalBytesWritten += writeIPv4Address(address)
         totalBytesWritten += writeInteger(port.rawValue)
       case .ipv6(let address):
         totalBytesWritten += writeInteger(AddressFlag.v6.rawValue)
-        totalBytesWritten += writeBytes(address.rawValue)
+        totalBytesWritten += writeIPv6Address(address)
         totalBytesWritten += writeInteger(port.rawValue)
       case .name(let name, _):
         totalBytesWritten += writeInteger(AddressFlag.domain.rawValue)
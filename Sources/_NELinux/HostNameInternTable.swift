@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOConcurrencyHelpers
+import NIOCore
+
+/// A thread-safe table that hands out one shared `String` per distinct host name.
+///
+/// Proxy destinations repeat at a high rate, interning them lets the address parser return an
+/// existing `String` instead of allocating a new one per request, and lets routing lookups on
+/// interned names compare equal by storage identity. The table is cleared when it grows beyond
+/// `capacity`, which bounds its memory when destinations churn. Names short enough to be stored
+/// inline by `String` never allocate, they are returned without taking the lock.
+final public class HostNameInternTable: Sendable {
+
+  private struct Storage {
+    var names: [Int: [String]] = [:]
+    var count = 0
+  }
+
+  /// A table to share between servers that expect the same destinations.
+  public static let shared = HostNameInternTable()
+
+  /// The UTF-8 byte count of the longest small string, which is stored inline.
+  private static let maximumSmallStringByteCount = MemoryLayout<Int>.size == 8 ? 15 : 10
+
+  private let capacity: Int
+  private let storage = NIOLockedValueBox(Storage())
+
+  /// Initialize an instance of `HostNameInternTable` that holds up to `capacity` names.
+  public init(capacity: Int = 1024) {
+    self.capacity = capacity
+  }
+
+  /// Returns the interned host name spelled by the readable bytes of `buffer`.
+  public func intern(_ buffer: ByteBuffer) -> String {
+    guard buffer.readableBytes > Self.maximumSmallStringByteCount else {
+      return String(buffer: buffer)
+    }
+
+    return buffer.withUnsafeReadableBytes { bytes in
+      var hasher = Hasher()
+      hasher.combine(bytes: bytes)
+      let key = hasher.finalize()
+
+      return storage.withLockedValue { storage in
+        if let name = storage.names[key]?.first(where: { $0.utf8.elementsEqual(bytes) }) {
+          return name
+        }
+
+        let name = String(decoding: bytes, as: UTF8.self)
+        // Names repaired while decoding never match their bytes, keep them out of the table.
+        guard name.utf8.elementsEqual(bytes) else {
+          return name
+        }
+        if storage.count >= capacity {
+          storage = Storage()
+        }
+        storage.names[key, default: []].append(name)
+        storage.count += 1
+        return name
+      }
+    }
+  }
+}
@@ -245,24 +245,32 @@ public protocol IPAddress: Sendable {
 public struct IPv4Address: IPAddress, Hashable, CustomDebugStringConvertible {
 
   /// Fetch the raw address (four bytes)
-  public var rawValue: Data { _rawValue }
-  private var _rawValue: Data
+  public var rawValue: Data { withUnsafeBytes(of: packedBytes) { Data($0) } }
+
+  /// The address in network byte order, kept inline so that no heap storage is needed.
+  package var packedBytes: UInt32
+
+  /// Create an IPv4 address from its four address bytes loaded in memory order.
+  ///
+  /// - Parameter packedBytes: The address in network byte order, as stored in `in_addr.s_addr`.
+  package init(packedBytes: UInt32) {
+    self.packedBytes = packedBytes
+  }
 
   /// Create an IPv4 address from a 4-byte data.
   ///
   /// - Parameter rawValue: The raw bytes of the IPv4 address, must be exactly 4 bytes or init will fail.
   /// - Returns: An IPv4Address or nil if the Data parameter did not contain an IPv4 address.
   public init?(_ rawValue: Data) {
+    // Any four bytes form a valid IPv4 address, so the length is all there is to check.
     guard rawValue.count == 4 else {
       return nil
     }
 
-    let buffer = ByteBuffer(bytes: rawValue)
-    guard case .v4 = try? SocketAddress(packedIPAddress: buffer, port: 0) else {
-      return nil
+    packedBytes = 0
+    withUnsafeMutableBytes(of: &packedBytes) {
+      $0.copyBytes(from: rawValue)
     }
-
-    _rawValue = rawValue
   }
 
   /// Create an IPv4 address from an address literal string.
@@ -277,11 +285,7 @@ public struct IPv4Address: IPAddress, Hashable, CustomDebugStringConvertible {
     guard case .v4(let v4) = try? SocketAddress(ipAddress: string, port: 0) else {
       return nil
     }
-    var localAddr = v4.address
-    _rawValue = withUnsafeBytes(of: &localAddr.sin_addr) {
-      precondition($0.count == 4)
-      return Data(bytes: $0.baseAddress!, count: $0.count)
-    }
+    packedBytes = v4.address.sin_addr.s_addr
   }
 
   public var debugDescription: String {
@@ -305,16 +309,15 @@ public struct IPv6Address: IPAddress, Hashable, CustomDebugStringConvertible {
   /// - Parameter interface: An optional interface the address is scoped to. Defaults to nil.
   /// - Returns: nil unless the raw data contained an IPv6 address
   public init?(_ rawValue: Data) {
+    // Any sixteen bytes form a valid IPv6 address, so the length is all there is to check.
     guard rawValue.count == 16 else {
       return nil
     }
 
-    let buffer = ByteBuffer(bytes: rawValue)
-    guard case .v6 = try? SocketAddress(packedIPAddress: buffer, port: 0) else {
-      return nil
+    packedBytes = (0, 0)
+    withUnsafeMutableBytes(of: &packedBytes) {
+      $0.copyBytes(from: rawValue)
     }
-
-    _rawValue = rawValue
   }
 
   /// Create an IPv6 address from a string literal such as "2001:DB8::5"
@@ -328,16 +331,36 @@ public struct IPv6Address: IPAddress, Hashable, CustomDebugStringConvertible {
     guard case .v6(let v6) = try? SocketAddress(ipAddress: string, port: 0) else {
       return nil
     }
-    var localAddr = v6.address
-    _rawValue = withUnsafeBytes(of: &localAddr.sin6_addr) {
+    packedBytes = withUnsafeBytes(of: v6.address.sin6_addr) {
       precondition($0.count == 16)
-      return Data(bytes: $0.baseAddress!, count: $0.count)
+      return (
+        $0.loadUnaligned(as: UInt64.self),
+        $0.loadUnaligned(fromByteOffset: 8, as: UInt64.self)
+      )
     }
   }
 
+  /// Create an IPv6 address from its sixteen address bytes loaded in memory order.
+  ///
+  /// - Parameter packedBytes: The first and last eight bytes of the address in network byte order.
+  package init(packedBytes: (UInt64, UInt64)) {
+    self.packedBytes = packedBytes
+  }
+
   /// Fetch the raw address (sixteen bytes)
-  public var rawValue: Data { _rawValue }
-  private var _rawValue: Data
+  public var rawValue: Data { withUnsafeBytes(of: packedBytes) { Data($0) } }
+
+  /// The address in network byte order, kept inline so that no heap storage is needed.
+  package var packedBytes: (UInt64, UInt64)
+
+  public static func == (lhs: IPv6Address, rhs: IPv6Address) -> Bool {
+    lhs.packedBytes == rhs.packedBytes
+  }
+
+  public func hash(into hasher: inout Hasher) {
+    hasher.combine(packedBytes.0)
+    hasher.combine(packedBytes.1)
+  }
 
   public var debugDescription: String {
     let packedIPAddress = ByteBuffer(bytes: rawValue)
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+
+/// The channel handler kind that reports to a `ProxyInstrumentation`.
+public struct ProxyComponent: RawRepresentable, Hashable, Sendable {
+
+  public var rawValue: String
+
+  public init(rawValue: String) {
+    self.rawValue = rawValue
+  }
+}
+
+/// A stage of a proxy handshake.
+public struct ProxyHandshakeStage: RawRepresentable, Hashable, Sendable {
+
+  public var rawValue: String
+
+  public init(rawValue: String) {
+    self.rawValue = rawValue
+  }
+
+  /// The client and server agree on an authentication method.
+  public static let methodSelection = ProxyHandshakeStage(rawValue: "method-selection")
+
+  /// The client authenticates to the server.
+  public static let authentication = ProxyHandshakeStage(rawValue: "authentication")
+
+  /// The server connects to the destination of the client.
+  public static let connect = ProxyHandshakeStage(rawValue: "connect")
+}
+
+/// The direction of the bytes reported to a `ProxyInstrumentation`.
+public enum ProxyTrafficDirection: Hashable, Sendable {
+
+  /// Bytes received from the proxy server.
+  case inbound
+
+  /// Bytes sent to the proxy server.
+  case outbound
+}
+
+/// A type that receives metrics and tracing events from proxy channel handlers.
+///
+/// Handlers only take timestamps and report events when an instrumentation is configured, so an
+/// unconfigured handler pays one `nil` check per event. Events are reported on the event loop of
+/// the channel, implementations are shared between channels and must be thread safe. Forward the
+/// events to swift-metrics, `os_signpost` or a tracer as needed; every requirement has an empty
+/// default implementation.
+public protocol ProxyInstrumentation: Sendable {
+
+  /// Called when `stage` of the handshake of `component` completed, `duration` after it began.
+  func handshakeStageDidComplete(
+    _ stage: ProxyHandshakeStage,
+    component: ProxyComponent,
+    duration: TimeAmount
+  )
+
+  /// Called when the handshake of `component` completed, `duration` after it began.
+  func handshakeDidComplete(component: ProxyComponent, duration: TimeAmount)
+
+  /// Called when the handshake of `component` failed with `error`.
+  func handshakeDidFail(component: ProxyComponent, error: Error)
+
+  /// Called when the proxy server rejected the credentials of `component`, or when a message
+  /// received by `component` failed authentication.
+  func authenticationDidFail(component: ProxyComponent)
+
+  /// Called when `byteCount` payload bytes, that is bytes that are not part of the handshake,
+  /// passed `component`.
+  func bytesTransferred(
+    _ byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent
+  )
+
+  /// Called when `component` sealed or opened `chunkCount` chunks carrying `byteCount` bytes,
+  /// which took `duration`.
+  func chunksProcessed(
+    _ chunkCount: Int,
+    byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent,
+    duration: TimeAmount
+  )
+
+  /// Called when the writes `component` buffered during its handshake are sent, `count` is the
+  /// largest number of writes that were buffered at once.
+  func bufferedWritesHighWaterMark(_ count: Int, component: ProxyComponent)
+}
+
+extension ProxyInstrumentation {
+
+  public func handshakeStageDidComplete(
+    _ stage: ProxyHandshakeStage,
+    component: ProxyComponent,
+    duration: TimeAmount
+  ) {}
+
+  public func handshakeDidComplete(component: ProxyComponent, duration: TimeAmount) {}
+
+  public func handshakeDidFail(component: ProxyComponent, error: Error) {}
+
+  public func authenticationDidFail(component: ProxyComponent) {}
+
+  public func bytesTransferred(
+    _ byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent
+  ) {}
+
+  public func chunksProcessed(
+    _ chunkCount: Int,
+    byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent,
+    duration: TimeAmount
+  ) {}
+
+  public func bufferedWritesHighWaterMark(_ count: Int, component: ProxyComponent) {}
+}
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+import NEAEAD
+import XCTest
+
+final class ChunkSealerTests: XCTestCase {
+
+  private func assertSealOpenRoundTrip(
+    algorithm: ChunkSealer.Algorithm,
+    key: SymmetricKey
+  ) throws {
+    let sealer = try ChunkSealer(algorithm: algorithm, key: key)
+    let nonce = Array(repeating: UInt8(7), count: 12)
+    let message = (0..<1000).map { UInt8(truncatingIfNeeded: $0) }
+
+    var sealed = Array(repeating: UInt8.zero, count: message.count + ChunkSealer.tagByteCount)
+    try message.withUnsafeBytes { message in
+      try sealed.withUnsafeMutableBytes { output in
+        try nonce.withUnsafeBytes { try sealer.seal(message, into: output, nonce: $0) }
+      }
+    }
+
+    var plaintext = Array(repeating: UInt8.zero, count: message.count)
+    try sealed.withUnsafeBytes { sealed in
+      try plaintext.withUnsafeMutableBytes { output in
+        try nonce.withUnsafeBytes { try sealer.open(sealed, into: output, nonce: $0) }
+      }
+    }
+    XCTAssertEqual(plaintext, message)
+
+    sealed[sealed.count - 1] ^= 1
+    XCTAssertThrowsError(
+      try sealed.withUnsafeBytes { sealed in
+        try plaintext.withUnsafeMutableBytes { output in
+          try nonce.withUnsafeBytes { try sealer.open(sealed, into: output, nonce: $0) }
+        }
+      }
+    )
+  }
+
+  func testAES128GCMSealOpenRoundTrip() throws {
+    try assertSealOpenRoundTrip(algorithm: .aes128Gcm, key: SymmetricKey(size: .bits128))
+  }
+
+  func testAES256GCMSealOpenRoundTrip() throws {
+    try assertSealOpenRoundTrip(algorithm: .aes256Gcm, key: SymmetricKey(size: .bits256))
+  }
+
+  func testChaCha20Poly1305SealOpenRoundTrip() throws {
+    try assertSealOpenRoundTrip(algorithm: .chaCha20Poly1305, key: SymmetricKey(size: .bits256))
+  }
+
+  func testOpenRejectsChunksShorterThanTag() throws {
+    let sealer = try ChunkSealer(algorithm: .aes128Gcm, key: SymmetricKey(size: .bits128))
+    let nonce = Array(repeating: UInt8.zero, count: 12)
+    let sealed = Array(repeating: UInt8.zero, count: ChunkSealer.tagByteCount - 1)
+    var output = Array(repeating: UInt8.zero, count: 0)
+    XCTAssertThrowsError(
+      try sealed.withUnsafeBytes { sealed in
+        try output.withUnsafeMutableBytes { output in
+          try nonce.withUnsafeBytes { try sealer.open(sealed, into: output, nonce: $0) }
+        }
+      }
+    )
+  }
+}
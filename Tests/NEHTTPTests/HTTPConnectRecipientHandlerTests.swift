@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import HTTPTypes
+import NIOCore
+import NIOEmbedded
+import XCTest
+
+@testable import NEHTTP
+
+final class HTTPConnectRecipientHandlerTests: XCTestCase {
+
+  private var eventLoop: EmbeddedEventLoop!
+  private var channel: EmbeddedChannel!
+  private var passwordReference: String {
+    "Basic \(Data("username:password".utf8).base64EncodedString())"
+  }
+
+  override func setUp() {
+    eventLoop = EmbeddedEventLoop()
+  }
+
+  override func tearDown() {
+    channel = nil
+    eventLoop = nil
+  }
+
+  private func makeChannel(
+    authenticationRequired: Bool = false,
+    completion: @escaping @Sendable (HTTPVersion, HTTPRequest) -> EventLoopFuture<Void>
+  ) {
+    let handler = HTTPConnectRecipientHandler(
+      passwordReference: passwordReference,
+      authenticationRequired: authenticationRequired,
+      completion: completion
+    )
+    channel = EmbeddedChannel(handler: handler, loop: eventLoop)
+  }
+
+  func testReadCONNECTRequestHead() throws {
+    var buffer = ByteBuffer(
+      string:
+        "CONNECT example.com:443 HTTP/1.1\r\nHost: example.com:443\r\nUser-Agent:  curl \r\n\r\n"
+    )
+    buffer.writeString("early data")
+
+    let (version, request) = try XCTUnwrap(buffer.readCONNECTRequestHead(maximumLength: 8192))
+    XCTAssertEqual(version, .http1_1)
+    XCTAssertEqual(request.method, .connect)
+    XCTAssertEqual(request.authority, "example.com:443")
+    XCTAssertEqual(request.headerFields[.host], nil)
+    XCTAssertEqual(request.headerFields[.userAgent], "curl")
+    XCTAssertEqual(String(buffer: buffer), "early data")
+  }
+
+  func testReadCONNECTRequestHeadWithDefaultPort() throws {
+    var buffer = ByteBuffer(string: "CONNECT [::1] HTTP/1.0\r\n\r\n")
+    let (version, request) = try XCTUnwrap(buffer.readCONNECTRequestHead(maximumLength: 8192))
+    XCTAssertEqual(version, .http1_0)
+    XCTAssertEqual(request.authority, "[::1]:443")
+
+    buffer = ByteBuffer(string: "CONNECT [::1]:8443 HTTP/1.1\r\n\r\n")
+    let head = try buffer.readCONNECTRequestHead(maximumLength: 8192)
+    XCTAssertEqual(head?.1.authority, "[::1]:8443")
+  }
+
+  func testReadIncompleteCONNECTRequestHead() throws {
+    let bytes = Array("CONNECT example.com:443 HTTP/1.1\r\nHost: example.com\r\n\r\n".utf8)
+    var buffer = ByteBuffer()
+    for byte in bytes.dropLast() {
+      buffer.writeInteger(byte)
+      XCTAssertNil(try buffer.readCONNECTRequestHead(maximumLength: 8192))
+      XCTAssertEqual(buffer.readerIndex, 0)
+    }
+    buffer.writeInteger(bytes.last!)
+    XCTAssertNotNil(try buffer.readCONNECTRequestHead(maximumLength: 8192))
+    XCTAssertEqual(buffer.readableBytes, 0)
+  }
+
+  func testReadMalformedCONNECTRequestHead() throws {
+    let heads = [
+      "\r\n\r\n",
+      "CONNECT HTTP/1.1\r\n\r\n",
+      "CONNECT example.com:443 HTTP/2\r\n\r\n",
+      "CONNECT example.com:443 HTTP/1.1\r\nHost\r\n\r\n",
+    ]
+    for head in heads {
+      var buffer = ByteBuffer(string: head)
+      XCTAssertThrowsError(try buffer.readCONNECTRequestHead(maximumLength: 8192)) {
+        guard case .unacceptableStatusCode(.badRequest) = $0 as? HTTPProxyError else {
+          XCTFail("should throw HTTPProxyError.unacceptableStatusCode(.badRequest)")
+          return
+        }
+      }
+    }
+  }
+
+  func testReadOversizedCONNECTRequestHead() throws {
+    var buffer = ByteBuffer(string: "CONNECT example.com:443 HTTP/1.1\r\n")
+    buffer.writeString("X-Padding: \(String(repeating: "x", count: 64))\r\n")
+    XCTAssertThrowsError(try buffer.readCONNECTRequestHead(maximumLength: 64)) {
+      guard case .unacceptableStatusCode(.requestHeaderFieldsTooLarge) = $0 as? HTTPProxyError
+      else {
+        XCTFail("should throw HTTPProxyError.unacceptableStatusCode(.requestHeaderFieldsTooLarge)")
+        return
+      }
+    }
+  }
+
+  func testHTTPConnectWorkflowWithEarlyData() throws {
+    makeChannel { version, request in
+      XCTAssertEqual(version, .http1_1)
+      XCTAssertEqual(request.authority, "example.com:443")
+      return self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    try channel.writeInbound(ByteBuffer(string: "CONNECT example.com:443 HTTP/1.1\r\n"))
+    XCTAssertNil(try channel.readOutbound(as: ByteBuffer.self))
+    try channel.writeInbound(ByteBuffer(string: "\r\nearly data"))
+
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "HTTP/1.1 200 Connection Established\r\n\r\n")
+    )
+    XCTAssertEqual(try channel.readInbound(), ByteBuffer(string: "early data"))
+    XCTAssertThrowsError(
+      try channel.pipeline.syncOperations.handler(type: HTTPConnectRecipientHandler.self)
+    ) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testBufferingBeforeTunnelEstablished() throws {
+    let deferPromise = eventLoop.makePromise(of: Void.self)
+    makeChannel { _, _ in
+      deferPromise.futureResult
+    }
+
+    try channel.writeInbound(ByteBuffer(string: "CONNECT example.com:443 HTTP/1.0\r\n\r\n"))
+    try channel.writeInbound(ByteBuffer(bytes: [1, 2, 3, 4, 5]))
+    XCTAssertNil(try channel.readInbound(as: ByteBuffer.self))
+
+    deferPromise.succeed(())
+
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "HTTP/1.0 200 Connection Established\r\n\r\n")
+    )
+    XCTAssertEqual(try channel.readInbound(), ByteBuffer(bytes: [1, 2, 3, 4, 5]))
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testProxyAuthenticationRequire() throws {
+    makeChannel(authenticationRequired: true) { _, _ in
+      XCTFail("unauthenticated request must not be handled")
+      return self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    XCTAssertThrowsError(
+      try channel.writeInbound(ByteBuffer(string: "CONNECT example.com:443 HTTP/1.1\r\n\r\n"))
+    ) {
+      guard case .unacceptableStatusCode(.proxyAuthenticationRequired) = $0 as? HTTPProxyError
+      else {
+        XCTFail("should throw HTTPProxyError.unacceptableStatusCode(.proxyAuthenticationRequired)")
+        return
+      }
+    }
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "HTTP/1.1 407 Proxy Authentication Required\r\nContent-Length: 0\r\n\r\n")
+    )
+    XCTAssertFalse(channel.isActive)
+  }
+
+  func testProxyAuthenticationWithValidCredentials() throws {
+    makeChannel(authenticationRequired: true) { _, _ in
+      self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    try channel.writeInbound(
+      ByteBuffer(
+        string:
+          "CONNECT example.com:443 HTTP/1.1\r\nProxy-Authorization: \(passwordReference)\r\n\r\n"
+      )
+    )
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "HTTP/1.1 200 Connection Established\r\n\r\n")
+    )
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testRejectNonCONNECTRequest() throws {
+    makeChannel { _, _ in
+      XCTFail("non CONNECT request must not be handled")
+      return self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    XCTAssertThrowsError(
+      try channel.writeInbound(ByteBuffer(string: "GET http://example.com/ HTTP/1.1\r\n\r\n"))
+    ) {
+      guard case .unacceptableStatusCode(.methodNotAllowed) = $0 as? HTTPProxyError else {
+        XCTFail("should throw HTTPProxyError.unacceptableStatusCode(.methodNotAllowed)")
+        return
+      }
+    }
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\n\r\n")
+    )
+  }
+
+  func testTunnelingOnlyPipelineHasNoHTTPCodec() throws {
+    channel = EmbeddedChannel(loop: eventLoop)
+    try channel.pipeline.syncOperations.configureHTTPProxyServerPipeline(
+      tunnelingOnly: true
+    ) { _, _ in
+      self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    XCTAssertNoThrow(
+      try channel.pipeline.syncOperations.handler(type: HTTPConnectRecipientHandler.self)
+    )
+    XCTAssertThrowsError(
+      try channel.pipeline.syncOperations.handler(type: HTTPResponseEncoder.self)
+    ) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+    XCTAssertNoThrow(try channel.finish())
+  }
+}
@@ -193,4 +193,101 @@ class HTTPProxyClientHandlerTests: XCTestCase {
     )
     XCTAssertThrowsError(try channel.finish())
   }
+
+  func testInstrumentationReportsHandshakeAndBufferedWrites() throws {
+    try channel.close().wait()
+
+    let instrumentation = EventRecordingInstrumentation()
+    handler = .init(
+      passwordReference: "passwordReference",
+      authenticationRequired: false,
+      preferHTTPTunneling: true,
+      destinationAddress: .hostPort(host: "swift.org", port: 443),
+      instrumentation: instrumentation
+    )
+
+    channel = EmbeddedChannel()
+    try channel.pipeline.syncOperations.addHTTPClientHandlers()
+    try channel.pipeline.syncOperations.addHandler(handler)
+
+    try waitUtilConnected()
+
+    channel.write(ByteBuffer(bytes: [1, 2, 3]), promise: nil)
+    channel.writeAndFlush(ByteBuffer(bytes: [4, 5, 6]), promise: nil)
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(string: "CONNECT swift.org:443 HTTP/1.1\r\n\r\n")
+    )
+    XCTAssertEqual(instrumentation.events, [])
+
+    try channel.writeInbound(ByteBuffer(string: "HTTP/1.1 200 OK\r\n\r\n"))
+    channel.embeddedEventLoop.advanceTime(to: .now())
+
+    XCTAssertEqual(
+      instrumentation.events,
+      [.handshakeCompleted, .bufferedWritesHighWaterMark(2)]
+    )
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testInstrumentationReportsProxyAuthenticationRequired() throws {
+    try channel.close().wait()
+
+    let instrumentation = EventRecordingInstrumentation()
+    handler = .init(
+      passwordReference: "passwordReference",
+      authenticationRequired: true,
+      preferHTTPTunneling: true,
+      destinationAddress: .hostPort(host: "swift.org", port: 443),
+      instrumentation: instrumentation
+    )
+
+    channel = EmbeddedChannel()
+    try channel.pipeline.syncOperations.addHTTPClientHandlers()
+    try channel.pipeline.syncOperations.addHandler(handler)
+
+    try waitUtilConnected()
+
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertThrowsError(
+      try channel.writeInbound(
+        ByteBuffer(string: "HTTP/1.1 407 Proxy Authentication Required\r\n\r\n")
+      )
+    )
+
+    XCTAssertEqual(
+      Array(instrumentation.events.prefix(2)),
+      [.authenticationFailed, .handshakeFailed]
+    )
+    XCTAssertThrowsError(try channel.finish())
+  }
+}
+
+/// Records the events `HTTPProxyClientHandler` reports in order.
+private final class EventRecordingInstrumentation: ProxyInstrumentation, @unchecked Sendable {
+
+  enum Event: Equatable {
+    case handshakeCompleted
+    case handshakeFailed
+    case authenticationFailed
+    case bufferedWritesHighWaterMark(Int)
+  }
+
+  var events: [Event] = []
+
+  func handshakeDidComplete(component: ProxyComponent, duration: TimeAmount) {
+    events.append(.handshakeCompleted)
+  }
+
+  func handshakeDidFail(component: ProxyComponent, error: Error) {
+    events.append(.handshakeFailed)
+  }
+
+  func authenticationDidFail(component: ProxyComponent) {
+    events.append(.authenticationFailed)
+  }
+
+  func bufferedWritesHighWaterMark(_ count: Int, component: ProxyComponent) {
+    events.append(.bufferedWritesHighWaterMark(count))
+  }
 }
@@ -184,4 +184,99 @@ final class HTTPProxyRecipientHandlerTests: XCTestCase {
     }
     XCTAssertNoThrow(try channel.finish())
   }
+
+  func testStreamingPipelineStripsHopByHopFieldsFromPipelinedRequests() throws {
+    channel = EmbeddedChannel(loop: eventLoop)
+    try channel.pipeline.syncOperations.configureHTTPProxyServerPipeline(
+      streaming: true
+    ) { _, _ in
+      self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    try channel.writeInbound(
+      ByteBuffer(
+        string: "GET http://example.com/a HTTP/1.1\r\nHost: example.com\r\n"
+          + "Proxy-Connection: keep-alive\r\n\r\n"
+          + "GET http://example.com/b HTTP/1.1\r\nHost: example.com\r\n"
+          + "Proxy-Connection: keep-alive\r\n\r\n"
+      )
+    )
+
+    XCTAssertThrowsError(
+      try channel.pipeline.syncOperations.handler(type: HTTPProxyRecipientHandelr.self)
+    ) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+    var forwarded = ""
+    while let buffer = try channel.readInbound(as: ByteBuffer.self) {
+      forwarded += String(buffer: buffer)
+    }
+    XCTAssertEqual(
+      forwarded,
+      "GET http://example.com/a HTTP/1.1\r\nHost: example.com\r\n\r\n"
+        + "GET http://example.com/b HTTP/1.1\r\nHost: example.com\r\n\r\n"
+    )
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testPooledPipelineForwardsRequestsToOneOriginOverOneUpstream() throws {
+    let eventLoop = self.eventLoop!
+    let upstream = EmbeddedChannel(loop: eventLoop)
+    let pool = HTTPUpstreamConnectionPool(eventLoop: eventLoop) { _, _ in
+      // The upstream can be connected once only, reusing it is the only way to succeed twice.
+      guard !upstream.isActive else {
+        return eventLoop.makeFailedFuture(ChannelError.inappropriateOperationForState)
+      }
+      // swift-format-ignore: NeverUseForceTry
+      let address = try! SocketAddress(ipAddress: "127.0.0.1", port: 80)
+      return upstream.connect(to: address).map { upstream as Channel }
+    }
+    channel = EmbeddedChannel(loop: eventLoop)
+    try channel.pipeline.syncOperations.configureHTTPProxyServerPipeline(
+      connectionPool: pool
+    ) { _, _ in
+      XCTFail("plain HTTP requests should not be handed over when pooled")
+      return eventLoop.makeSucceededVoidFuture()
+    }
+
+    for path in ["/a", "/b"] {
+      try channel.writeInbound(
+        ByteBuffer(
+          string: "GET http://example.com\(path) HTTP/1.1\r\nHost: example.com\r\n"
+            + "Proxy-Connection: keep-alive\r\n\r\n"
+        )
+      )
+
+      guard case .head(let head) = try upstream.readOutbound(as: HTTPClientRequestPart.self)
+      else {
+        XCTFail("upstream should receive the request head")
+        return
+      }
+      XCTAssertEqual(head.uri, "http://example.com\(path)")
+      XCTAssertEqual(head.headers, ["Host": "example.com"])
+      XCTAssertEqual(try upstream.readOutbound(as: HTTPClientRequestPart.self), .end(nil))
+
+      let responseHead = HTTPResponseHead(
+        version: .http1_1,
+        status: .ok,
+        headers: ["Content-Length": "0"]
+      )
+      try upstream.writeInbound(HTTPClientResponsePart.head(responseHead))
+      try upstream.writeInbound(HTTPClientResponsePart.end(nil))
+
+      var response = ""
+      while let buffer = try channel.readOutbound(as: ByteBuffer.self) {
+        response += String(buffer: buffer)
+      }
+      XCTAssertEqual(response, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")
+    }
+
+    XCTAssertTrue(upstream.isActive)
+    XCTAssertNoThrow(
+      try channel.pipeline.syncOperations.handler(type: HTTPProxyRecipientHandelr.self)
+    )
+    XCTAssertNoThrow(try channel.finish())
+    pool.close()
+    XCTAssertFalse(upstream.isActive)
+  }
 }
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import HTTPTypes
+import NIOCore
+import NIOEmbedded
+import XCTest
+
+@testable import NEHTTP
+
+final class HTTPUpstreamConnectionPoolTests: XCTestCase {
+
+  private let key = HTTPUpstreamConnectionPool.Key(host: "example.com", port: 80, usesTLS: false)
+
+  private func makePool(
+    eventLoop: EmbeddedEventLoop,
+    maximumIdleConnectionsPerKey: Int = 8
+  ) -> HTTPUpstreamConnectionPool {
+    HTTPUpstreamConnectionPool(
+      eventLoop: eventLoop,
+      idleTimeout: .seconds(60),
+      maximumIdleConnectionsPerKey: maximumIdleConnectionsPerKey
+    ) { [eventLoop] _, _ in
+      let channel = EmbeddedChannel(loop: eventLoop)
+      // swift-format-ignore: NeverUseForceTry
+      let address = try! SocketAddress(ipAddress: "127.0.0.1", port: 80)
+      return channel.connect(to: address).map { channel as Channel }
+    }
+  }
+
+  func testKeyFromRequest() {
+    var request = HTTPRequest(method: .get, scheme: "http", authority: "example.com", path: "/")
+    XCTAssertEqual(HTTPUpstreamConnectionPool.Key(request), key)
+
+    request.authority = "example.com:8080"
+    XCTAssertEqual(
+      HTTPUpstreamConnectionPool.Key(request),
+      .init(host: "example.com", port: 8080, usesTLS: false)
+    )
+
+    request.scheme = "https"
+    request.authority = "[::1]"
+    XCTAssertEqual(
+      HTTPUpstreamConnectionPool.Key(request),
+      .init(host: "::1", port: 443, usesTLS: true)
+    )
+
+    request.authority = "[::1]:8443"
+    XCTAssertEqual(
+      HTTPUpstreamConnectionPool.Key(request),
+      .init(host: "::1", port: 8443, usesTLS: true)
+    )
+
+    request.authority = nil
+    XCTAssertNil(HTTPUpstreamConnectionPool.Key(request))
+  }
+
+  func testReleasedConnectionIsReused() throws {
+    let eventLoop = EmbeddedEventLoop()
+    let pool = makePool(eventLoop: eventLoop)
+
+    let channel = try pool.leaseConnection(to: key).wait()
+    pool.releaseConnection(channel, to: key)
+
+    XCTAssertTrue(try pool.leaseConnection(to: key).wait() === channel)
+    XCTAssertFalse(try pool.leaseConnection(to: key).wait() === channel)
+
+    let otherKey = HTTPUpstreamConnectionPool.Key(host: "example.com", port: 80, usesTLS: true)
+    pool.releaseConnection(channel, to: key)
+    XCTAssertFalse(try pool.leaseConnection(to: otherKey).wait() === channel)
+  }
+
+  func testIdleConnectionIsClosedAfterTimeout() throws {
+    let eventLoop = EmbeddedEventLoop()
+    let pool = makePool(eventLoop: eventLoop)
+
+    let channel = try pool.leaseConnection(to: key).wait()
+    pool.releaseConnection(channel, to: key)
+
+    eventLoop.advanceTime(by: .seconds(59))
+    XCTAssertTrue(channel.isActive)
+    eventLoop.advanceTime(by: .seconds(1))
+    XCTAssertFalse(channel.isActive)
+    XCTAssertFalse(try pool.leaseConnection(to: key).wait() === channel)
+  }
+
+  func testIdleConnectionClosedByUpstreamIsNotReused() throws {
+    let eventLoop = EmbeddedEventLoop()
+    let pool = makePool(eventLoop: eventLoop)
+
+    let channel = try pool.leaseConnection(to: key).wait()
+    pool.releaseConnection(channel, to: key)
+    try channel.close().wait()
+    eventLoop.run()
+
+    XCTAssertFalse(try pool.leaseConnection(to: key).wait() === channel)
+  }
+
+  func testMaximumIdleConnectionsPerKey() throws {
+    let eventLoop = EmbeddedEventLoop()
+    let pool = makePool(eventLoop: eventLoop, maximumIdleConnectionsPerKey: 1)
+
+    let first = try pool.leaseConnection(to: key).wait()
+    let second = try pool.leaseConnection(to: key).wait()
+    pool.releaseConnection(first, to: key)
+    pool.releaseConnection(second, to: key)
+
+    XCTAssertTrue(first.isActive)
+    XCTAssertFalse(second.isActive)
+  }
+
+  func testCloseClosesIdleConnections() throws {
+    let eventLoop = EmbeddedEventLoop()
+    let pool = makePool(eventLoop: eventLoop)
+
+    let first = try pool.leaseConnection(to: key).wait()
+    let second = try pool.leaseConnection(to: key).wait()
+    pool.releaseConnection(first, to: key)
+    pool.close()
+    pool.releaseConnection(second, to: key)
+
+    XCTAssertFalse(first.isActive)
+    XCTAssertFalse(second.isActive)
+  }
+}
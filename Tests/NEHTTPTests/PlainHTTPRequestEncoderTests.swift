@@ -299,6 +299,88 @@ final class PlainHTTPRequestEncoderTests: XCTestCase {
     XCTAssertNoThrow(XCTAssertTrue(try channel.finish().isClean))
   }
 
+  func testStreamingHeadStripsHopByHopFields() throws {
+    let channel = EmbeddedChannel(handler: PlainHTTPRequestEncoder(streaming: true))
+    var request = HTTPRequestHead(version: .http1_1, method: .GET, uri: "http://example.com/")
+    request.headers.add(name: "Host", value: "example.com")
+    request.headers.add(name: "Proxy-Connection", value: "keep-alive")
+    request.headers.add(name: "PROXY-AUTHORIZATION", value: "Basic xxxx")
+    request.headers.add(name: "Accept", value: "*/*")
+
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.head(request)))
+    let expected = "GET http://example.com/ HTTP/1.1\r\nHost: example.com\r\nAccept: */*\r\n\r\n"
+    assertInbountContainsOnly(channel, expected)
+
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.end(nil)))
+    assertInbountContainsOnly(channel, "")
+    XCTAssertNoThrow(XCTAssertTrue(try channel.finish().isClean))
+  }
+
+  func testStreamingChunkedBody() throws {
+    let channel = EmbeddedChannel(handler: PlainHTTPRequestEncoder(streaming: true))
+    let request = HTTPRequestHead(version: .http1_1, method: .POST, uri: "/")
+    let foo = ByteBuffer(string: "foo")
+    let body = ByteBuffer(string: "0123456789abcdefg")
+
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.head(request)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.body(foo)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.body(ByteBuffer())))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.body(body)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.end(nil)))
+
+    assertInbountContainsOnly(channel, "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n")
+    assertInbountContainsOnly(channel, "3\r\n")
+    XCTAssertEqual(try channel.readInbound(), foo)
+    assertInbountContainsOnly(channel, "")
+    assertInbountContainsOnly(channel, "\r\n11\r\n")
+    XCTAssertEqual(try channel.readInbound(), body)
+    assertInbountContainsOnly(channel, "\r\n0\r\n\r\n")
+    XCTAssertNoThrow(XCTAssertTrue(try channel.finish().isClean))
+  }
+
+  func testStreamingChunkedBodyWithTrailers() throws {
+    let channel = EmbeddedChannel(handler: PlainHTTPRequestEncoder(streaming: true))
+    let request = HTTPRequestHead(version: .http1_1, method: .POST, uri: "/")
+    let foo = ByteBuffer(string: "foo")
+
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.head(request)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.body(foo)))
+    XCTAssertNoThrow(
+      try channel.writeInbound(HTTPServerRequestPart.end(HTTPHeaders([("X-Trailer", "1")])))
+    )
+
+    assertInbountContainsOnly(channel, "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n")
+    assertInbountContainsOnly(channel, "3\r\n")
+    assertInbountContainsOnly(channel, "foo")
+    assertInbountContainsOnly(channel, "\r\n0\r\nX-Trailer: 1\r\n\r\n")
+    XCTAssertNoThrow(XCTAssertTrue(try channel.finish().isClean))
+  }
+
+  func testStreamingPipelinedRequests() throws {
+    let channel = EmbeddedChannel(handler: PlainHTTPRequestEncoder(streaming: true))
+    var post = HTTPRequestHead(version: .http1_1, method: .POST, uri: "/upload")
+    post.headers.add(name: "Connection", value: "keep-alive")
+    let get = HTTPRequestHead(version: .http1_1, method: .GET, uri: "/index.html")
+    let foo = ByteBuffer(string: "foo")
+
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.head(post)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.body(foo)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.end(nil)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.head(get)))
+    XCTAssertNoThrow(try channel.writeInbound(HTTPServerRequestPart.end(nil)))
+
+    assertInbountContainsOnly(
+      channel,
+      "POST /upload HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n"
+    )
+    assertInbountContainsOnly(channel, "3\r\n")
+    assertInbountContainsOnly(channel, "foo")
+    assertInbountContainsOnly(channel, "\r\n0\r\n\r\n")
+    assertInbountContainsOnly(channel, "GET /index.html HTTP/1.1\r\n\r\n")
+    assertInbountContainsOnly(channel, "")
+    XCTAssertNoThrow(XCTAssertTrue(try channel.finish().isClean))
+  }
+
   private func assertInbountContainsOnly(_ channel: EmbeddedChannel, _ expected: String) {
     XCTAssertNoThrow(
       XCTAssertNotNil(
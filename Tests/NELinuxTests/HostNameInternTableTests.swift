@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import XCTest
+import _NELinux
+
+final class HostNameInternTableTests: XCTestCase {
+
+  func testInternReturnsEqualNames() {
+    let table = HostNameInternTable()
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.com")), "static.example.com")
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.com")), "static.example.com")
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.org")), "static.example.org")
+    XCTAssertEqual(table.intern(ByteBuffer(string: "example.com")), "example.com")
+    XCTAssertEqual(table.intern(ByteBuffer()), "")
+  }
+
+  func testInternAfterTableIsCleared() {
+    let table = HostNameInternTable(capacity: 1)
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.com")), "static.example.com")
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.org")), "static.example.org")
+    XCTAssertEqual(table.intern(ByteBuffer(string: "static.example.com")), "static.example.com")
+  }
+
+  func testInternRepairsMalformedNames() {
+    let table = HostNameInternTable()
+    let malformed = ByteBuffer(bytes: Array(repeating: 0x61, count: 16) + [0xFF])
+    let repaired = String(repeating: "a", count: 16) + "\u{FFFD}"
+    XCTAssertEqual(table.intern(malformed), repaired)
+    XCTAssertEqual(table.intern(malformed), repaired)
+    XCTAssertEqual(table.intern(ByteBuffer(bytes: [0x61, 0xFF])), "a\u{FFFD}")
+  }
+
+  func testReadDomainNameWithInternTable() throws {
+    var buffer = ByteBuffer(bytes: [0x03, 0x09])
+    buffer.writeString("localhost")
+    buffer.writeInteger(UInt16(80))
+
+    let endpoint = try buffer.readRFC1928RequestAddressAsEndpoint(
+      internTable: HostNameInternTable()
+    )
+    XCTAssertEqual(endpoint, .hostPort(host: .name("localhost", nil), port: 80))
+    XCTAssertEqual(buffer.readableBytes, 0)
+  }
+}
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+import NIOCore
 import XCTest
 import _NELinux
 
@@ -49,6 +50,19 @@ final class NWEndpointTests: XCTestCase {
     XCTAssertEqual(IPv4Address("0.0.0.1")?.debugDescription, "0.0.0.1")
   }
 
+  func testReadWritePackedIPv4Address() throws {
+    var buffer = ByteBuffer(bytes: [0x7F, 0x00, 0x00, 0x01, 0xFF])
+    let address = try XCTUnwrap(buffer.readIPv4Address())
+    XCTAssertEqual(address, IPv4Address("127.0.0.1"))
+    XCTAssertEqual(address.rawValue, Data([0x7F, 0x00, 0x00, 0x01]))
+    XCTAssertNil(buffer.readIPv4Address())
+    XCTAssertEqual(buffer.readableBytes, 1)
+
+    buffer.clear()
+    XCTAssertEqual(buffer.writeIPv4Address(address), 4)
+    XCTAssertEqual(Array(buffer: buffer), [0x7F, 0x00, 0x00, 0x01])
+  }
+
   func testCreateIPv6AddressFromString() {
     let address = IPv6Address("fe80::5")
     let expectedAddress = Data([
@@ -70,6 +84,26 @@ final class NWEndpointTests: XCTestCase {
     )
   }
 
+  func testReadWritePackedIPv6Address() throws {
+    let bytes: [UInt8] = [
+      0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x05,
+    ]
+    var buffer = ByteBuffer(bytes: bytes)
+    let address = try XCTUnwrap(buffer.readIPv6Address())
+    XCTAssertEqual(address, IPv6Address("fe80::5"))
+    XCTAssertEqual(address.rawValue, Data(bytes))
+    XCTAssertEqual(buffer.readableBytes, 0)
+
+    buffer = ByteBuffer(bytes: bytes.dropLast())
+    XCTAssertNil(buffer.readIPv6Address())
+    XCTAssertEqual(buffer.readableBytes, 15)
+
+    buffer.clear()
+    XCTAssertEqual(buffer.writeIPv6Address(address), 16)
+    XCTAssertEqual(Array(buffer: buffer), bytes)
+  }
+
   func testIPv6AddressEquatable() {
     XCTAssertEqual(IPv4Address("::"), IPv4Address("::"))
   }
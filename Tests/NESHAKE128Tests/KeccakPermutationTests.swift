@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import CNESHAKE128
+import XCTest
+
+final class KeccakPermutationTests: XCTestCase {
+
+  func testPermutationOfZeroState() {
+    var state = Array(repeating: UInt64.zero, count: 25)
+    CSHAKE128_sha3_keccakf(&state)
+    XCTAssertEqual(state[0], 0xF125_8F79_40E1_DDE7)
+    XCTAssertEqual(state[24], 0xEAF1_FF7B_5CEC_A249)
+  }
+
+  func testPermutationMatchesReferenceImplementation() {
+    var generator = SystemRandomNumberGenerator()
+    for _ in 0..<1000 {
+      var state = (0..<25).map { _ in UInt64.random(in: .min ... .max, using: &generator) }
+      var expected = state
+
+      CSHAKE128_sha3_keccakf(&state)
+      CSHAKE128_sha3_keccakf_reference(&expected)
+      XCTAssertEqual(state, expected)
+    }
+  }
+
+  func testMultiBufferPermutationsMatchScalarPermutation() {
+    for (count, permute) in [
+      (4, CSHAKE128_sha3_keccakf_x4),
+      (8, CSHAKE128_sha3_keccakf_x8),
+    ] as [(Int, (UnsafeMutablePointer<UnsafeMutablePointer<UInt64>?>?) -> Void)] {
+      let states = (0..<count).map { _ in UnsafeMutablePointer<UInt64>.allocate(capacity: 25) }
+      defer { states.forEach { $0.deallocate() } }
+
+      var expected: [[UInt64]] = []
+      for state in states {
+        var lanes = (0..<25).map { _ in UInt64.random(in: .min ... .max) }
+        state.initialize(from: lanes, count: 25)
+        CSHAKE128_sha3_keccakf(&lanes)
+        expected.append(lanes)
+      }
+
+      var pointers: [UnsafeMutablePointer<UInt64>?] = states
+      pointers.withUnsafeMutableBufferPointer { permute($0.baseAddress) }
+      for (state, lanes) in zip(states, expected) {
+        XCTAssertEqual(Array(UnsafeBufferPointer(start: state, count: 25)), lanes)
+      }
+    }
+  }
+}
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import XCTest
+
+@testable import NESHAKE128
+
+final class SHAKE128KeystreamSchedulerTests: XCTestCase {
+
+  private func makeHasher(seed: Int) -> SHAKE128 {
+    var hasher = SHAKE128()
+    hasher.update(data: Array("Yoda said, Do or do not. There is not try. \(seed)".utf8))
+    return hasher
+  }
+
+  func testSchedulerMatchesReader() {
+    let scheduler = SHAKE128KeystreamScheduler()
+    var streams: [SHAKE128KeystreamScheduler.Stream] = []
+    var readers: [SHAKE128.Reader] = []
+
+    for seed in 0..<11 {
+      streams.append(scheduler.register(makeHasher(seed: seed)))
+      readers.append(SHAKE128.Reader(makeHasher(seed: seed)))
+    }
+
+    // Advance the streams unevenly so refills cover a different subset each time.
+    for round in 0..<2000 {
+      for index in streams.indices where round % (index % 3 + 1) == 0 {
+        XCTAssertEqual(scheduler.readUInt16(from: streams[index]), readers[index].readUInt16())
+      }
+    }
+  }
+
+  func testRegisterPartiallySqueezedHasher() {
+    let scheduler = SHAKE128KeystreamScheduler()
+
+    var hasher = makeHasher(seed: 0)
+    _ = hasher.read(digestSize: 3)
+    let stream = scheduler.register(hasher)
+
+    var expected = makeHasher(seed: 0)
+    _ = expected.read(digestSize: 3)
+    var reader = SHAKE128.Reader(expected)
+
+    for _ in 0..<500 {
+      XCTAssertEqual(scheduler.readUInt16(from: stream), reader.readUInt16())
+    }
+  }
+
+  func testUnregisteredSlotIsReused() {
+    let scheduler = SHAKE128KeystreamScheduler()
+    let first = scheduler.register(makeHasher(seed: 0))
+    _ = scheduler.readUInt16(from: first)
+    scheduler.unregister(first)
+
+    let second = scheduler.register(makeHasher(seed: 1))
+    XCTAssertEqual(first, second)
+
+    var reader = SHAKE128.Reader(makeHasher(seed: 1))
+    for _ in 0..<200 {
+      XCTAssertEqual(scheduler.readUInt16(from: second), reader.readUInt16())
+    }
+  }
+}
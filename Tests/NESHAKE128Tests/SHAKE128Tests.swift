@@ -40,6 +40,61 @@ class SHAKE128Tests: XCTestCase {
     XCTAssertEqual(result.description.uppercased(), expected)
   }
 
+  func testSHAKE128ReaderMatchesRead() {
+    var hasher = SHAKE128.init()
+    hasher.update(data: "Yoda said, Do or do not. There is not try.".data(using: .utf8)!)
+
+    var reader = SHAKE128.Reader(hasher)
+    var result = UInt16.zero
+    for _ in 0..<1000 {
+      result = reader.readUInt16()
+    }
+    XCTAssertEqual(result, 0x9244)
+
+    // Reading through the reader must not advance the original hasher.
+    var copyReader = SHAKE128.Reader(hasher)
+    XCTAssertEqual(
+      copyReader.readUInt16(),
+      hasher.read(digestSize: 2).withUnsafeBytes { UInt16($0[0]) << 8 | UInt16($0[1]) }
+    )
+  }
+
+  func testSHAKE128ReaderReadAcrossBlocks() {
+    var hasher = SHAKE128()
+    hasher.update(data: [1, 2, 3, 4])
+    var reader = SHAKE128.Reader(hasher)
+
+    hasher = SHAKE128()
+    hasher.update(data: [1, 2, 3, 4])
+    let expected = Array(hasher.read(digestSize: 1000).bytes)
+
+    var result = Array(repeating: UInt8.zero, count: 1000)
+    result.withUnsafeMutableBytes { buffer in
+      var index = 0
+      for count in [1, 3, 163, 2, 170, 337, 324] {
+        reader.read(into: .init(rebasing: buffer[index..<index + count]))
+        index += count
+      }
+    }
+    XCTAssertEqual(result, expected)
+  }
+
+  func testSHAKE128MultiBlockUpdateAndRead() {
+    var hasher = SHAKE128()
+    hasher.update(data: (0..<400).map { UInt8(truncatingIfNeeded: $0) })
+
+    let digest = hasher.read(digestSize: 400)
+    let hexEncoded = digest.bytes.map { String(format: "%02X", $0) }.joined()
+    XCTAssertEqual(
+      hexEncoded.prefix(64),
+      "78EA99F6C302EBAE04DD2D2CF5B2C1014DB0407049C278B2FFFCD2C77700AC4E"
+    )
+    XCTAssertEqual(
+      hexEncoded.suffix(64),
+      "80BC90E511AC196528CA558E98760A4800D070D49CD96F9D2F5C3133D07ED910"
+    )
+  }
+
   func testSHAKE128CoW() {
     var hf = SHAKE128()
     hf.update(data: [1, 2, 3, 4])
@@ -53,4 +108,54 @@ class SHAKE128Tests: XCTestCase {
 
     XCTAssertEqual(digest, copyDigest)
   }
+
+  func testSHAKE128IncrementalUpdatesMatchSingleUpdate() {
+    var hasher = SHAKE128()
+    hasher.update(data: [1, 2, 3, 4])
+    hasher.update(data: [5, 6, 7, 8])
+
+    var expected = SHAKE128()
+    expected.update(data: [1, 2, 3, 4, 5, 6, 7, 8])
+
+    XCTAssertEqual(hasher.finalize(), expected.finalize())
+    XCTAssertEqual(
+      hasher.read(digestSize: 16).description.uppercased(),
+      "SHAKE128 DIGEST: 1706A5E64F7AFCB76385AC64394D4779"
+    )
+  }
+
+  func testSHAKE128FinalizeOnEveryUpdate() {
+    var hasher = SHAKE128(absorbMode: .finalizeOnEveryUpdate)
+    hasher.update(data: [1, 2, 3, 4])
+    hasher.update(data: [5, 6, 7, 8])
+    XCTAssertEqual(
+      hasher.read(digestSize: 16).description.uppercased(),
+      "SHAKE128 DIGEST: 519290A7B7AA312F110A45D69AB41232"
+    )
+
+    var singleUpdate = SHAKE128(absorbMode: .finalizeOnEveryUpdate)
+    singleUpdate.update(data: "Yoda said, Do or do not. There is not try.".data(using: .utf8)!)
+    XCTAssertEqual(
+      singleUpdate.finalize().description.uppercased(),
+      "SHAKE128 DIGEST: 0C39568823BBFD6930A596644121AB98"
+    )
+  }
+
+  func testSHAKE128ConsumingFinalize() {
+    var hasher = SHAKE128()
+    hasher.update(data: "Yoda said, Do or do not. There is not try.".data(using: .utf8)!)
+    let copy = hasher
+
+    XCTAssertEqual(hasher.finalize(digestSize: 16), copy.finalize())
+  }
+
+  func testSHAKE128ReadAdvancesOnlyItsOwnCopy() {
+    var hasher = SHAKE128()
+    hasher.update(data: [1, 2, 3, 4])
+    var copy = hasher
+
+    let first = hasher.read(digestSize: 8)
+    XCTAssertEqual(copy.read(digestSize: 8), first)
+    XCTAssertNotEqual(hasher.read(digestSize: 8), first)
+  }
 }
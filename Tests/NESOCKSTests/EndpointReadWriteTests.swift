@@ -94,4 +94,17 @@ class NWEndpointReadWriteTests: XCTestCase {
     var buffer = ByteBuffer(bytes: [0x01, 0x7F, 0x00])
     XCTAssertNoThrow(XCTAssertNil(try buffer.readRFC1928RequestAddressAsEndpoint()))
   }
+
+  func testSocketAddressConversionsRoundTrip() throws {
+    for (ipAddress, port) in [("192.168.1.1", 8080), ("2001:db8::1", 443)] {
+      let endpoint = NWEndpoint.hostPort(
+        host: .init(ipAddress),
+        port: try XCTUnwrap(NWEndpoint.Port(rawValue: UInt16(port)))
+      )
+      let socketAddress = try XCTUnwrap(SocketAddress(endpoint))
+      XCTAssertEqual(socketAddress, try SocketAddress(ipAddress: ipAddress, port: port))
+      XCTAssertEqual(NWEndpoint(socketAddress), endpoint)
+    }
+    XCTAssertNil(SocketAddress(NWEndpoint.hostPort(host: "localhost", port: 80)))
+  }
 }
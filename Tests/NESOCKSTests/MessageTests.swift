@@ -97,4 +97,25 @@ class MessageTests: XCTestCase {
     buffer.writeServerResponse(response)
     XCTAssertNoThrow(XCTAssertEqual(try buffer.readServerResponse(), response))
   }
+
+  func testDatagramReadWrite() throws {
+    let expected = SOCKS5Datagram(
+      endpoint: .hostPort(host: .name("example.com", nil), port: 53),
+      data: ByteBuffer(bytes: [1, 2, 3])
+    )
+    var buffer = ByteBuffer()
+    buffer.writeDatagram(expected)
+    XCTAssertEqual(
+      Array(buffer.readableBytesView.prefix(5)),
+      [0x00, 0x00, 0x00, 0x03, UInt8("example.com".utf8.count)]
+    )
+    XCTAssertEqual(try buffer.readDatagram(), expected)
+    XCTAssertEqual(buffer.readableBytes, 0)
+  }
+
+  func testDatagramFragmentIsNotRead() throws {
+    var buffer = ByteBuffer(bytes: [0x00, 0x00, 0x01, 0x01, 192, 168, 1, 1, 0x00, 0x35, 0x2a])
+    XCTAssertNil(try buffer.readDatagram())
+    XCTAssertEqual(buffer.readerIndex, 0)
+  }
 }
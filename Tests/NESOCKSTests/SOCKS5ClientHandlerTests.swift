@@ -165,6 +165,77 @@ class SOCKS5ClientHandlerTests: XCTestCase {
     XCTAssertEqual(try channel.readInbound(), ByteBuffer(bytes: [1, 2, 3, 4, 5]))
   }
 
+  func testFastOpenWorkflowWithUsernamePasswordAuthentication() throws {
+    let handler = SOCKS5ClientHandler(
+      username: "username",
+      passwordReference: "passwordReference",
+      authenticationRequired: true,
+      destinationAddress: .hostPort(host: "192.168.1.1", port: 80),
+      fastOpen: true
+    )
+    XCTAssertNoThrow(try channel.finish())
+    channel = nil
+    channel = EmbeddedChannel(handler: handler)
+
+    // Early data written before the connection is sent right after the handshake.
+    let writePromise = channel.eventLoop.makePromise(of: Void.self)
+    channel.writeAndFlush(ByteBuffer(bytes: [1, 2, 3]), promise: writePromise)
+    try waitUntilConnected()
+
+    let usernameReference = Array("username".utf8)
+    let passwordReference = Array("passwordReference".utf8)
+    let authenticationData =
+      [0x01, UInt8(usernameReference.count)] + usernameReference + [
+        UInt8(passwordReference.count)
+      ] + passwordReference
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(
+        bytes: [0x05, 0x01, 0x02] + authenticationData + [
+          0x05, 0x01, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50,
+        ]
+      )
+    )
+    XCTAssertNoThrow(try writePromise.futureResult.wait())
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [1, 2, 3]))
+
+    // Writes before the replies are not held back.
+    channel.writeAndFlush(ByteBuffer(bytes: [4, 5]), promise: nil)
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [4, 5]))
+
+    // All replies arrive in one read, followed by data.
+    try channel.writeInbound(
+      ByteBuffer(bytes: [
+        0x05, 0x02,
+        0x01, 0x00,
+        0x05, 0x00, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50,
+        6, 7,
+      ])
+    )
+    XCTAssertNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertEqual(try channel.readInbound(), ByteBuffer(bytes: [6, 7]))
+  }
+
+  func testFastOpenRejectedCredentials() throws {
+    let handler = SOCKS5ClientHandler(
+      username: "username",
+      passwordReference: "passwordReference",
+      authenticationRequired: true,
+      destinationAddress: .hostPort(host: "192.168.1.1", port: 80),
+      fastOpen: true
+    )
+    XCTAssertNoThrow(try channel.finish())
+    channel = nil
+    channel = EmbeddedChannel(handler: handler)
+    try waitUntilConnected()
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+
+    XCTAssertThrowsError(try channel.writeInbound(ByteBuffer(bytes: [0x05, 0x02, 0x01, 0x01])))
+    XCTAssertThrowsError(try channel.finish()) { error in
+      XCTAssertEqual(error as? ChannelError, .alreadyClosed)
+    }
+  }
+
   func testBuffering() throws {
     try waitUntilConnected()
 
@@ -381,4 +452,114 @@ class SOCKS5ClientHandlerTests: XCTestCase {
       XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
     }
   }
+
+  func testInstrumentationReportsHandshakeStagesAndTraffic() throws {
+    let instrumentation = HandshakeRecordingInstrumentation()
+    let handler = SOCKS5ClientHandler(
+      username: "username",
+      passwordReference: "passwordReference",
+      authenticationRequired: true,
+      destinationAddress: .hostPort(host: "192.168.1.1", port: 80),
+      instrumentation: instrumentation
+    )
+    XCTAssertNoThrow(try channel.finish())
+    channel = nil
+    channel = EmbeddedChannel(handler: handler)
+
+    try waitUntilConnected()
+
+    self.channel.write(ByteBuffer(bytes: [1, 2, 3]), promise: nil)
+    self.channel.flush()
+    self.channel.write(ByteBuffer(bytes: [4, 5, 6]), promise: nil)
+
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x01, 0x02]))
+    try channel.writeInbound(ByteBuffer(bytes: [0x05, 0x02]))
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+    try channel.writeInbound(ByteBuffer(bytes: [0x01, 0x00]))
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertEqual(instrumentation.stages, [.methodSelection, .authentication])
+    XCTAssertEqual(instrumentation.handshakeCompletionCount, 0)
+
+    try channel.writeInbound(
+      ByteBuffer(bytes: [0x05, 0x00, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50, 7, 8])
+    )
+    XCTAssertEqual(instrumentation.stages, [.methodSelection, .authentication, .connect])
+    XCTAssertEqual(instrumentation.handshakeCompletionCount, 1)
+    XCTAssertEqual(instrumentation.highWaterMarks, [2])
+    XCTAssertEqual(try channel.readInbound(), ByteBuffer(bytes: [7, 8]))
+
+    XCTAssertNoThrow(try self.channel.writeAndFlush(ByteBuffer(bytes: [9])).wait())
+    try channel.writeInbound(ByteBuffer(bytes: [10, 11, 12, 13]))
+    XCTAssertEqual(instrumentation.highWaterMarks, [2])
+    XCTAssertEqual(instrumentation.outboundByteCounts, [3, 3, 1])
+    XCTAssertEqual(instrumentation.inboundByteCounts, [2, 4])
+  }
+
+  func testInstrumentationReportsRejectedCredentials() throws {
+    let instrumentation = HandshakeRecordingInstrumentation()
+    let handler = SOCKS5ClientHandler(
+      username: "username",
+      passwordReference: "passwordReference",
+      authenticationRequired: true,
+      destinationAddress: .hostPort(host: "192.168.1.1", port: 80),
+      instrumentation: instrumentation
+    )
+    XCTAssertNoThrow(try channel.finish())
+    channel = nil
+    channel = EmbeddedChannel(handler: handler)
+
+    try waitUntilConnected()
+
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x01, 0x02]))
+    try channel.writeInbound(ByteBuffer(bytes: [0x05, 0x02]))
+    XCTAssertThrowsError(try channel.writeInbound(ByteBuffer(bytes: [0x01, 0x01])))
+    XCTAssertEqual(instrumentation.stages, [.methodSelection])
+    XCTAssertEqual(instrumentation.authenticationFailureCount, 1)
+    XCTAssertEqual(instrumentation.handshakeCompletionCount, 0)
+  }
+}
+
+/// Records the handshake stages and traffic `SOCKS5ClientHandler` reports.
+private final class HandshakeRecordingInstrumentation: ProxyInstrumentation, @unchecked Sendable {
+
+  var stages: [ProxyHandshakeStage] = []
+  var handshakeCompletionCount = 0
+  var authenticationFailureCount = 0
+  var inboundByteCounts: [Int] = []
+  var outboundByteCounts: [Int] = []
+  var highWaterMarks: [Int] = []
+
+  func handshakeStageDidComplete(
+    _ stage: ProxyHandshakeStage,
+    component: ProxyComponent,
+    duration: TimeAmount
+  ) {
+    XCTAssertEqual(component, .socks5Client)
+    stages.append(stage)
+  }
+
+  func handshakeDidComplete(component: ProxyComponent, duration: TimeAmount) {
+    handshakeCompletionCount += 1
+  }
+
+  func authenticationDidFail(component: ProxyComponent) {
+    authenticationFailureCount += 1
+  }
+
+  func bytesTransferred(
+    _ byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent
+  ) {
+    switch direction {
+    case .inbound:
+      inboundByteCounts.append(byteCount)
+    case .outbound:
+      outboundByteCounts.append(byteCount)
+    }
+  }
+
+  func bufferedWritesHighWaterMark(_ count: Int, component: ProxyComponent) {
+    highWaterMarks.append(count)
+  }
 }
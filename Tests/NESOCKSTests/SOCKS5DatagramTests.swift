@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOEmbedded
+import XCTest
+
+@testable import NESOCKS
+
+final class SOCKS5DatagramTests: XCTestCase {
+
+  func testDatagramClientHandlers() throws {
+    let relayAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 1080)
+    let channel = EmbeddedChannel()
+    try channel.pipeline.syncOperations.addSOCKSDatagramClientHandlers(relayAddress: relayAddress)
+
+    let datagram = SOCKS5Datagram(
+      endpoint: .hostPort(host: .ipv4(.init("8.8.8.8")!), port: 53),
+      data: ByteBuffer(bytes: [1, 2, 3])
+    )
+    try channel.writeOutbound(datagram)
+    let envelope = try XCTUnwrap(channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+    XCTAssertEqual(envelope.remoteAddress, relayAddress)
+    XCTAssertEqual(
+      envelope.data,
+      ByteBuffer(bytes: [0x00, 0x00, 0x00, 0x01, 8, 8, 8, 8, 0x00, 0x35, 1, 2, 3])
+    )
+
+    try channel.writeInbound(envelope)
+    XCTAssertEqual(try channel.readInbound(as: SOCKS5Datagram.self), datagram)
+
+    // Fragments are dropped.
+    let fragment = ByteBuffer(bytes: [0x00, 0x00, 0x01, 0x01, 8, 8, 8, 8, 0x00, 0x35, 1])
+    try channel.writeInbound(AddressedEnvelope(remoteAddress: relayAddress, data: fragment))
+    XCTAssertNil(try channel.readInbound(as: SOCKS5Datagram.self))
+  }
+
+  func testUDPRelayHandler() throws {
+    let clientAddress = try SocketAddress(ipAddress: "10.0.0.2", port: 40000)
+    let targetAddress = try SocketAddress(ipAddress: "8.8.8.8", port: 53)
+    let channel = EmbeddedChannel(
+      handler: SOCKS5UDPRelayHandler(clientAddress: try .init(ipAddress: "10.0.0.2", port: 5000))
+    )
+
+    // Datagrams from the client are relayed to their targets when the read burst completes.
+    channel.pipeline.fireChannelRead(
+      NIOAny(
+        AddressedEnvelope(
+          remoteAddress: clientAddress,
+          data: ByteBuffer(bytes: [0x00, 0x00, 0x00, 0x01, 8, 8, 8, 8, 0x00, 0x35, 1, 2])
+        )
+      )
+    )
+    channel.pipeline.fireChannelRead(
+      NIOAny(
+        AddressedEnvelope(
+          remoteAddress: clientAddress,
+          data: ByteBuffer(bytes: [0x00, 0x00, 0x00, 0x01, 8, 8, 8, 8, 0x00, 0x35, 3])
+        )
+      )
+    )
+    XCTAssertNil(try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+    channel.pipeline.fireChannelReadComplete()
+    XCTAssertEqual(
+      try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self),
+      AddressedEnvelope(remoteAddress: targetAddress, data: ByteBuffer(bytes: [1, 2]))
+    )
+    XCTAssertEqual(
+      try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self),
+      AddressedEnvelope(remoteAddress: targetAddress, data: ByteBuffer(bytes: [3]))
+    )
+
+    // Datagrams from targets are relayed back to the client with the header of their source.
+    try channel.writeInbound(
+      AddressedEnvelope(remoteAddress: targetAddress, data: ByteBuffer(bytes: [4, 5]))
+    )
+    XCTAssertEqual(
+      try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self),
+      AddressedEnvelope(
+        remoteAddress: clientAddress,
+        data: ByteBuffer(bytes: [0x00, 0x00, 0x00, 0x01, 8, 8, 8, 8, 0x00, 0x35, 4, 5])
+      )
+    )
+    XCTAssertNil(try channel.readInbound(as: AddressedEnvelope<ByteBuffer>.self))
+  }
+
+  func testUDPRelayHandlerDropsDatagramsToDomainNames() throws {
+    let clientAddress = try SocketAddress(ipAddress: "10.0.0.2", port: 40000)
+    let channel = EmbeddedChannel(handler: SOCKS5UDPRelayHandler(clientAddress: clientAddress))
+
+    var byteBuffer = ByteBuffer()
+    byteBuffer.writeDatagram(
+      SOCKS5Datagram(
+        endpoint: .hostPort(host: .name("example.com", nil), port: 53),
+        data: ByteBuffer(bytes: [1])
+      )
+    )
+    try channel.writeInbound(AddressedEnvelope(remoteAddress: clientAddress, data: byteBuffer))
+    XCTAssertNil(try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+  }
+}
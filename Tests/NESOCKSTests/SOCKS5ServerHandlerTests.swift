@@ -65,6 +65,32 @@ final class SOCKS5ServerHandlerTests: XCTestCase {
     }
   }
 
+  func testRequestedDomainNameWithInternTable() throws {
+    let name = "static.example.com"
+    let eventLoop = self.eventLoop!
+    channel = EmbeddedChannel(loop: eventLoop)
+    try channel.pipeline.syncOperations.configureSOCKSServerPipeline(
+      internTable: HostNameInternTable()
+    ) { endpoint in
+      XCTAssertEqual(endpoint, .hostPort(host: .name(name, nil), port: 80))
+      return eventLoop.makeSucceededVoidFuture()
+    }
+    try channel.bind(to: .init(ipAddress: "127.0.0.1", port: 0)).wait()
+
+    try channel.writeInbound(ByteBuffer(bytes: [0x05, 0x01, 0x00]))
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x00]))
+
+    var request = ByteBuffer(bytes: [0x05, 0x01, 0x00, 0x03, UInt8(name.utf8.count)])
+    request.writeString(name)
+    request.writeInteger(UInt16(80))
+    try channel.writeInbound(request)
+
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertThrowsError(try channel.pipeline.handler(type: SOCKS5ServerHandler.self).wait()) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+  }
+
   func testWorkflowWithUsernamePasswordAuthentication() throws {
     handler = SOCKS5ServerHandler(
       username: "username",
@@ -148,4 +174,98 @@ final class SOCKS5ServerHandlerTests: XCTestCase {
 
     XCTAssertNotNil(try channel.readOutbound())
   }
+
+  func testPipelinedHandshakeAndEarlyData() throws {
+    try channel.writeInbound(
+      ByteBuffer(bytes: [
+        0x05, 0x01, 0x00,
+        0x05, 0x01, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50,
+        0x01, 0x02, 0x03,
+      ])
+    )
+
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x00]))
+    XCTAssertNotNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertEqual(try channel.readInbound(), ByteBuffer(bytes: [0x01, 0x02, 0x03]))
+    XCTAssertNil(try channel.readInbound(as: ByteBuffer.self))
+
+    XCTAssertThrowsError(try channel.pipeline.handler(type: SOCKS5ServerHandler.self).wait()) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+  }
+
+  func testRequestPipelinedAfterWrongCredentialIsNotHandled() throws {
+    handler = SOCKS5ServerHandler(
+      username: "username",
+      passwordReference: "passwordReference",
+      authenticationRequired: true
+    ) { _ in
+      XCTFail("request pipelined after wrong credential must not be handled")
+      return self.eventLoop.makeSucceededVoidFuture()
+    }
+
+    channel = EmbeddedChannel(handler: handler, loop: eventLoop)
+    try channel.bind(to: .init(ipAddress: "127.0.0.1", port: 0)).wait()
+
+    let usernameReference = Array("Wrong credential".utf8)
+    let passwordReference = Array("passwordReference".utf8)
+    let authenticationData =
+      [0x01, UInt8(usernameReference.count)] + usernameReference + [
+        UInt8(passwordReference.count)
+      ] + passwordReference
+
+    try channel.writeInbound(
+      ByteBuffer(
+        bytes: [0x05, 0x01, 0x02] + authenticationData + [
+          0x05, 0x01, 0x00, 0x01, 192, 168, 1, 1, 0x00, 0x50,
+        ]
+      )
+    )
+
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x02, 0x01, 0x01]))
+    XCTAssertNil(try channel.readOutbound(as: ByteBuffer.self))
+    XCTAssertFalse(channel.isActive)
+  }
+
+  func testUDPAssociate() throws {
+    handler = SOCKS5ServerHandler(
+      username: "",
+      passwordReference: "",
+      authenticationRequired: false
+    ) { _ in
+      XCTFail("UDP ASSOCIATE must not connect")
+      return self.eventLoop.makeSucceededVoidFuture()
+    } udpAssociation: { _ in
+      self.eventLoop.makeCompletedFuture {
+        try SocketAddress(ipAddress: "127.0.0.1", port: 1080)
+      }
+    }
+
+    channel = EmbeddedChannel(handler: handler, loop: eventLoop)
+    try channel.bind(to: .init(ipAddress: "127.0.0.1", port: 0)).wait()
+
+    try channel.writeInbound(
+      ByteBuffer(bytes: [0x05, 0x01, 0x00, 0x05, 0x03, 0x00, 0x01, 0, 0, 0, 0, 0x00, 0x00])
+    )
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x00]))
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(bytes: [0x05, 0x00, 0x00, 0x01, 127, 0, 0, 1, 0x04, 0x38])
+    )
+    XCTAssertThrowsError(try channel.pipeline.handler(type: SOCKS5ServerHandler.self).wait()) {
+      XCTAssertEqual($0 as? ChannelPipelineError, .notFound)
+    }
+  }
+
+  func testUDPAssociateIsRejectedWithoutRelay() throws {
+    try channel.writeInbound(
+      ByteBuffer(bytes: [0x05, 0x01, 0x00, 0x05, 0x03, 0x00, 0x01, 0, 0, 0, 0, 0x00, 0x00])
+    )
+    XCTAssertEqual(try channel.readOutbound(), ByteBuffer(bytes: [0x05, 0x00]))
+    XCTAssertEqual(
+      try channel.readOutbound(),
+      ByteBuffer(bytes: [0x05, 0x07, 0x00, 0x01, 0, 0, 0, 0, 0x00, 0x00])
+    )
+    XCTAssertFalse(channel.isActive)
+  }
 }
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+import NIOCore
+import NIOEmbedded
+import XCTest
+
+@testable import NESS
+
+final class DatagramCodecTests: XCTestCase {
+
+  private let passwordReference = "BeMWIH2K5YtZ"
+
+  private func makeChannel(algorithm: Algorithm) throws -> EmbeddedChannel {
+    let channel = EmbeddedChannel()
+    try channel.pipeline.syncOperations.addSSDatagramClientHandlers(
+      algorithm: algorithm,
+      passwordReference: passwordReference,
+      serverAddress: try SocketAddress(ipAddress: "127.0.0.1", port: 8388)
+    )
+    return channel
+  }
+
+  func testSealDatagramIntoOnePacket() throws {
+    for algorithm in Algorithm.allCases {
+      let channel = try makeChannel(algorithm: algorithm)
+      let datagram = SSDatagram(
+        endpoint: .hostPort(host: .name("example.com", nil), port: 53),
+        data: ByteBuffer(bytes: [1, 2, 3, 4, 5])
+      )
+      try channel.writeOutbound(datagram)
+
+      let envelope = try XCTUnwrap(channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+      XCTAssertEqual(envelope.remoteAddress, try SocketAddress(ipAddress: "127.0.0.1", port: 8388))
+      XCTAssertNil(try channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+
+      var packet = envelope.data
+      let salt = packet.readBytes(length: algorithm.saltByteCount)!
+      let symmetricKey = hkdfDerivedSymmetricKey(
+        secretKey: passwordReference,
+        salt: salt,
+        outputByteCount: algorithm.saltByteCount
+      )
+      let combined = Array(repeating: 0, count: 12) + Array(packet.readableBytesView)
+      let plaintext: Data
+      switch algorithm {
+      case .aes128Gcm, .aes256Gcm:
+        plaintext = try AES.GCM.open(.init(combined: combined), using: symmetricKey)
+      case .chaCha20Poly1305:
+        plaintext = try ChaChaPoly.open(.init(combined: combined), using: symmetricKey)
+      }
+
+      var expected = ByteBuffer()
+      expected.writeEndpointInRFC1928RequestAddressFormat(datagram.endpoint)
+      expected.writeBytes([1, 2, 3, 4, 5])
+      XCTAssertEqual(Array(plaintext), Array(expected.readableBytesView))
+    }
+  }
+
+  func testOpenSealedDatagram() throws {
+    for algorithm in Algorithm.allCases {
+      let channel = try makeChannel(algorithm: algorithm)
+      let datagram = SSDatagram(
+        endpoint: .hostPort(host: .ipv4(.init("8.8.8.8")!), port: 53),
+        data: ByteBuffer(bytes: Array(repeating: 0x2a, count: 1200))
+      )
+      try channel.writeOutbound(datagram)
+      let envelope = try XCTUnwrap(channel.readOutbound(as: AddressedEnvelope<ByteBuffer>.self))
+
+      try channel.writeInbound(envelope)
+      XCTAssertEqual(try channel.readInbound(as: SSDatagram.self), datagram)
+      XCTAssertNil(try channel.readInbound(as: SSDatagram.self))
+    }
+  }
+
+  func testDropMalformedDatagram() throws {
+    let channel = try makeChannel(algorithm: .aes128Gcm)
+    let remoteAddress = try SocketAddress(ipAddress: "127.0.0.1", port: 8388)
+
+    let truncated = AddressedEnvelope(remoteAddress: remoteAddress, data: ByteBuffer(bytes: [1]))
+    XCTAssertThrowsError(try channel.writeInbound(truncated)) {
+      guard case SSError.malformedDatagram = $0 else {
+        XCTFail("unexpected error \($0)")
+        return
+      }
+    }
+
+    let forged = AddressedEnvelope(
+      remoteAddress: remoteAddress,
+      data: ByteBuffer(bytes: Array(repeating: 0, count: 64))
+    )
+    XCTAssertThrowsError(try channel.writeInbound(forged))
+    XCTAssertNil(try channel.readInbound(as: SSDatagram.self))
+  }
+}
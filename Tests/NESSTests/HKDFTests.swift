@@ -36,4 +36,20 @@ final class HKDFTests: XCTestCase {
       }
     }
   }
+
+  func testMasterKeyCache() {
+    let cache = MasterKeyCache(capacity: 1)
+
+    // EVP_BytesToKey("password") with MD5.
+    let masterKey = cache.masterKey(secretKey: "password", outputByteCount: 32)
+    masterKey.withUnsafeBytes {
+      XCTAssertEqual(
+        $0.hexEncodedString(),
+        "5f4dcc3b5aa765d61d8327deb882cf992b95990a9151374abd8ff8c5a7a0fe08"
+      )
+    }
+    XCTAssertEqual(cache.masterKey(secretKey: "password", outputByteCount: 16).bitCount, 128)
+    XCTAssertNotEqual(cache.masterKey(secretKey: "other", outputByteCount: 32), masterKey)
+    XCTAssertEqual(cache.masterKey(secretKey: "password", outputByteCount: 32), masterKey)
+  }
 }
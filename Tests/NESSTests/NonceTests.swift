@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import XCTest
+
+@testable import NESS
+
+final class NonceTests: XCTestCase {
+
+  func testCountingNonceStartsFromZero() {
+    let nonce = CountingNonce()
+    nonce.withUnsafeBytes {
+      XCTAssertEqual(Array($0), Array(repeating: 0, count: 12))
+    }
+  }
+
+  func testCountingNonceIncrementsLikeSodiumIncrement() {
+    var nonce = CountingNonce()
+    var expected = Array(repeating: UInt8.zero, count: 12)
+    for _ in 0..<300 {
+      nonce.increment()
+      expected.increment(expected.count)
+      nonce.withUnsafeBytes {
+        XCTAssertEqual(Array($0), expected)
+      }
+    }
+  }
+
+  func testCountingNonceCarriesIntoHighBytes() {
+    var nonce = CountingNonce(low: .max)
+    var expected = Array(repeating: UInt8(0xFF), count: 8) + Array(repeating: 0, count: 4)
+    nonce.increment()
+    expected.increment(expected.count)
+    nonce.withUnsafeBytes {
+      XCTAssertEqual(Array($0), [0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0])
+      XCTAssertEqual(Array($0), expected)
+    }
+  }
+
+  func testCountingNonceWrapsAround() {
+    var nonce = CountingNonce(low: .max, high: .max)
+    var expected = Array(repeating: UInt8(0xFF), count: 12)
+    nonce.increment()
+    expected.increment(expected.count)
+    nonce.withUnsafeBytes {
+      XCTAssertEqual(Array($0), Array(repeating: 0, count: 12))
+      XCTAssertEqual(Array($0), expected)
+    }
+  }
+
+  func testCountingNonceCreatesAEADNonces() {
+    var nonce = CountingNonce()
+    nonce.increment()
+    let expected: [UInt8] = [1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0]
+    AES.GCM.Nonce(nonce).withUnsafeBytes {
+      XCTAssertEqual(Array($0), expected)
+    }
+    ChaChaPoly.Nonce(nonce).withUnsafeBytes {
+      XCTAssertEqual(Array($0), expected)
+    }
+  }
+}
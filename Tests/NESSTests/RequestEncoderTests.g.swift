@@ -48,16 +48,12 @@ final class RequestEncoderTests: XCTestCase {
       var actualData: Data!
       var ciphertext: Data!
       var encryptedDataLength: Int = 0
-      var packet: ByteBuffer!
+      // Every write produces exactly one buffer.
+      var packet = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
 
       if i == 0 {
-        // The first packet contains salt value.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-        XCTAssertEqual(packet.readableBytes, 16)
-
-        // Read salt value.
-        guard packet.readableBytes == 16 else {
+        // The first packet starts with salt value.
+        guard packet.readableBytes > 16 else {
           XCTFail("Invalid salt packet.")
           return
         }
@@ -69,10 +65,7 @@ final class RequestEncoderTests: XCTestCase {
           outputByteCount: 16
         )
 
-        // Read encrypted address buffer.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-
+        // Read encrypted address chunk.
         guard packet.readableBytes > 18 else {
           XCTFail(
             "Packet should contains at least 18 bytes data to decode encrypt packet length, but got \(packet.readableBytes) bytes."
@@ -86,7 +79,7 @@ final class RequestEncoderTests: XCTestCase {
         }
         nonce.increment(nonce.count)
 
-        guard packet.readableBytes == encryptedDataLength else {
+        guard packet.readableBytes >= encryptedDataLength else {
           XCTFail(
             "Packet should contains at least \(encryptedDataLength) bytes data to decode address data, but got \(packet.readableBytes) bytes."
           )
@@ -98,9 +91,6 @@ final class RequestEncoderTests: XCTestCase {
         XCTAssertEqual(try actualData.readAddress(), destinationAddress)
       }
 
-      packet = try channel.readOutbound(as: ByteBuffer.self)
-      XCTAssertNotNil(packet)
-
       // Read encrypted request data.
       guard packet.readableBytes > 18 else {
         XCTFail(
@@ -158,16 +148,12 @@ final class RequestEncoderTests: XCTestCase {
       var actualData: Data!
       var ciphertext: Data!
       var encryptedDataLength: Int = 0
-      var packet: ByteBuffer!
+      // Every write produces exactly one buffer.
+      var packet = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
 
       if i == 0 {
-        // The first packet contains salt value.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-        XCTAssertEqual(packet.readableBytes, 32)
-
-        // Read salt value.
-        guard packet.readableBytes == 32 else {
+        // The first packet starts with salt value.
+        guard packet.readableBytes > 32 else {
           XCTFail("Invalid salt packet.")
           return
         }
@@ -179,10 +165,7 @@ final class RequestEncoderTests: XCTestCase {
           outputByteCount: 32
         )
 
-        // Read encrypted address buffer.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-
+        // Read encrypted address chunk.
         guard packet.readableBytes > 18 else {
           XCTFail(
             "Packet should contains at least 18 bytes data to decode encrypt packet length, but got \(packet.readableBytes) bytes."
@@ -196,7 +179,7 @@ final class RequestEncoderTests: XCTestCase {
         }
         nonce.increment(nonce.count)
 
-        guard packet.readableBytes == encryptedDataLength else {
+        guard packet.readableBytes >= encryptedDataLength else {
           XCTFail(
             "Packet should contains at least \(encryptedDataLength) bytes data to decode address data, but got \(packet.readableBytes) bytes."
           )
@@ -208,9 +191,6 @@ final class RequestEncoderTests: XCTestCase {
         XCTAssertEqual(try actualData.readAddress(), destinationAddress)
       }
 
-      packet = try channel.readOutbound(as: ByteBuffer.self)
-      XCTAssertNotNil(packet)
-
       // Read encrypted request data.
       guard packet.readableBytes > 18 else {
         XCTFail(
@@ -268,16 +248,12 @@ final class RequestEncoderTests: XCTestCase {
       var actualData: Data!
       var ciphertext: Data!
       var encryptedDataLength: Int = 0
-      var packet: ByteBuffer!
+      // Every write produces exactly one buffer.
+      var packet = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
 
       if i == 0 {
-        // The first packet contains salt value.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-        XCTAssertEqual(packet.readableBytes, 32)
-
-        // Read salt value.
-        guard packet.readableBytes == 32 else {
+        // The first packet starts with salt value.
+        guard packet.readableBytes > 32 else {
           XCTFail("Invalid salt packet.")
           return
         }
@@ -289,10 +265,7 @@ final class RequestEncoderTests: XCTestCase {
           outputByteCount: 32
         )
 
-        // Read encrypted address buffer.
-        packet = try channel.readOutbound(as: ByteBuffer.self)
-        XCTAssertNotNil(packet)
-
+        // Read encrypted address chunk.
         guard packet.readableBytes > 18 else {
           XCTFail(
             "Packet should contains at least 18 bytes data to decode encrypt packet length, but got \(packet.readableBytes) bytes."
@@ -306,7 +279,7 @@ final class RequestEncoderTests: XCTestCase {
         }
         nonce.increment(nonce.count)
 
-        guard packet.readableBytes == encryptedDataLength else {
+        guard packet.readableBytes >= encryptedDataLength else {
           XCTFail(
             "Packet should contains at least \(encryptedDataLength) bytes data to decode address data, but got \(packet.readableBytes) bytes."
           )
@@ -318,9 +291,6 @@ final class RequestEncoderTests: XCTestCase {
         XCTAssertEqual(try actualData.readAddress(), destinationAddress)
       }
 
-      packet = try channel.readOutbound(as: ByteBuffer.self)
-      XCTAssertNotNil(packet)
-
       // Read encrypted request data.
       guard packet.readableBytes > 18 else {
         XCTFail(
@@ -350,4 +320,48 @@ final class RequestEncoderTests: XCTestCase {
 
     XCTAssertNil(try channel.readOutbound(as: ByteBuffer.self))
   }
+
+  func testEncodeLargeWritesIntoBoundedBuffers() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let channel = EmbeddedChannel(
+      handler: RequestEncoder(
+        algorithm: .aes128Gcm,
+        passwordReference: passwordReference,
+        destinationAddress: .hostPort(host: "192.168.1.1", port: 80)
+      )
+    )
+    // Responses share the request chunk format, so the response decoder can open the requests.
+    let decoder = EmbeddedChannel(
+      handler: ByteToMessageHandler(
+        ResponseDecoder(algorithm: .aes128Gcm, passwordReference: passwordReference)
+      )
+    )
+
+    // 100000 bytes fill four chunks in the first buffer and three in the second.
+    let message = (0..<100_000).map { UInt8(truncatingIfNeeded: $0) }
+    try channel.writeOutbound(ByteBuffer(bytes: message))
+    // An exact multiple of 16384 must still be split into chunks of at most 0x3FFF bytes.
+    try channel.writeOutbound(ByteBuffer(repeating: 1, count: 16384))
+
+    var packetCount = 0
+    while let packet = try channel.readOutbound(as: ByteBuffer.self) {
+      packetCount += 1
+      try decoder.writeInbound(packet)
+    }
+    XCTAssertEqual(packetCount, 3)
+
+    var chunks: [ByteBuffer] = []
+    while let chunk = try decoder.readInbound(as: ByteBuffer.self) {
+      chunks.append(chunk)
+    }
+    // The address chunk, seven chunks of the first write and two chunks of the second write.
+    XCTAssertEqual(
+      chunks.dropFirst().map(\.readableBytes),
+      [16383, 16383, 16383, 16383, 16383, 16383, 1702, 16383, 1]
+    )
+    XCTAssertEqual(
+      chunks.dropFirst().prefix(7).flatMap { Array(buffer: $0) },
+      message
+    )
+  }
 }
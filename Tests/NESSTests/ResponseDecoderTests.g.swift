@@ -80,6 +80,101 @@ final class ResponseDecoderTests: XCTestCase {
     }
   }
 
+  func testCoalesceShadowsocksResponseWithAES128GCM() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "AES-128-GCM")!,
+        passwordReference: passwordReference,
+        maximumCoalescedReadBytes: 3
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 16)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 16)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 16
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try AES.GCM.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    try channel.writeInbound(byteBuffer)
+    // [1, 2] and [3, 4] together exceed the 3 bytes cap, [3, 4] and [5] do not.
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [1, 2]))
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [3, 4, 5]))
+    XCTAssertNil(try channel.readInbound(as: ByteBuffer.self))
+  }
+
+  func testDecodeShadowsocksResponseArrivingByteByByteWithAES128GCM() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "AES-128-GCM")!,
+        passwordReference: passwordReference
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 16)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 16)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 16
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try AES.GCM.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    // The decrypted length is kept while the payload trickles in, so the nonce stays in step.
+    var decoded: [[UInt8]] = []
+    while let byte = byteBuffer.readSlice(length: 1) {
+      try channel.writeInbound(byte)
+      while let packet = try channel.readInbound(as: ByteBuffer.self) {
+        decoded.append(Array(packet.readableBytesView))
+      }
+    }
+    XCTAssertEqual(decoded, packets)
+  }
+
   func testDecodeShadowsocksResponseWithAES256GCM() throws {
     let passwordReference = "BeMWIH2K5YtZ"
     let handler = ByteToMessageHandler(
@@ -138,6 +233,101 @@ final class ResponseDecoderTests: XCTestCase {
     }
   }
 
+  func testCoalesceShadowsocksResponseWithAES256GCM() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "AES-256-GCM")!,
+        passwordReference: passwordReference,
+        maximumCoalescedReadBytes: 3
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 32)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 32)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 32
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try AES.GCM.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    try channel.writeInbound(byteBuffer)
+    // [1, 2] and [3, 4] together exceed the 3 bytes cap, [3, 4] and [5] do not.
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [1, 2]))
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [3, 4, 5]))
+    XCTAssertNil(try channel.readInbound(as: ByteBuffer.self))
+  }
+
+  func testDecodeShadowsocksResponseArrivingByteByByteWithAES256GCM() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "AES-256-GCM")!,
+        passwordReference: passwordReference
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 32)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 32)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 32
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try AES.GCM.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    // The decrypted length is kept while the payload trickles in, so the nonce stays in step.
+    var decoded: [[UInt8]] = []
+    while let byte = byteBuffer.readSlice(length: 1) {
+      try channel.writeInbound(byte)
+      while let packet = try channel.readInbound(as: ByteBuffer.self) {
+        decoded.append(Array(packet.readableBytesView))
+      }
+    }
+    XCTAssertEqual(decoded, packets)
+  }
+
   func testDecodeShadowsocksResponseWithChaCha20Poly1305() throws {
     let passwordReference = "BeMWIH2K5YtZ"
     let handler = ByteToMessageHandler(
@@ -195,4 +385,99 @@ final class ResponseDecoderTests: XCTestCase {
       XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: packet))
     }
   }
+
+  func testCoalesceShadowsocksResponseWithChaCha20Poly1305() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "ChaCha20-Poly1305")!,
+        passwordReference: passwordReference,
+        maximumCoalescedReadBytes: 3
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 32)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 32)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 32
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try ChaChaPoly.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    try channel.writeInbound(byteBuffer)
+    // [1, 2] and [3, 4] together exceed the 3 bytes cap, [3, 4] and [5] do not.
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [1, 2]))
+    XCTAssertEqual(try channel.readInbound(as: ByteBuffer.self), ByteBuffer(bytes: [3, 4, 5]))
+    XCTAssertNil(try channel.readInbound(as: ByteBuffer.self))
+  }
+
+  func testDecodeShadowsocksResponseArrivingByteByByteWithChaCha20Poly1305() throws {
+    let passwordReference = "BeMWIH2K5YtZ"
+    let handler = ByteToMessageHandler(
+      ResponseDecoder(
+        algorithm: .init(rawValue: "ChaCha20-Poly1305")!,
+        passwordReference: passwordReference
+      )
+    )
+    let channel = EmbeddedChannel(handler: handler)
+    var nonce = [UInt8](repeating: 0, count: 12)
+    var salt = Array(repeating: UInt8.zero, count: 32)
+    salt.withUnsafeMutableBytes {
+      $0.initializeWithRandomBytes(count: 32)
+    }
+    let symmetricKey = hkdfDerivedSymmetricKey(
+      secretKey: passwordReference,
+      salt: salt,
+      outputByteCount: 32
+    )
+    let packets: [[UInt8]] = [
+      [1, 2],
+      [3, 4],
+      [5],
+    ]
+    var byteBuffer = ByteBuffer(bytes: salt)
+    for packet in packets {
+      for message in [withUnsafeBytes(of: UInt16(packet.count).bigEndian, Array.init), packet] {
+        let sealedBox = try ChaChaPoly.seal(
+          message,
+          using: symmetricKey,
+          nonce: .init(data: nonce)
+        )
+        nonce.increment(nonce.count)
+        byteBuffer.writeBytes(sealedBox.ciphertext)
+        byteBuffer.writeBytes(sealedBox.tag)
+      }
+    }
+
+    // The decrypted length is kept while the payload trickles in, so the nonce stays in step.
+    var decoded: [[UInt8]] = []
+    while let byte = byteBuffer.readSlice(length: 1) {
+      try channel.writeInbound(byte)
+      while let packet = try channel.readInbound(as: ByteBuffer.self) {
+        decoded.append(Array(packet.readableBytesView))
+      }
+    }
+    XCTAssertEqual(decoded, packets)
+  }
 }
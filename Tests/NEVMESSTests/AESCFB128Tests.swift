@@ -40,4 +40,41 @@ final class AESCFB128Tests: XCTestCase {
     let recoveredPlaintext = try AES.CFB.decrypt(ciphertext, using: key, nonce: nonce)
     XCTAssertEqual(plaintext, recoveredPlaintext)
   }
+
+  func testCryptorStreamsAcrossUpdates() throws {
+    let key = SymmetricKey(size: .bits128)
+    let nonce = AES.CFB.Nonce()
+    let plaintext = Data((0..<100).map { UInt8(truncatingIfNeeded: $0) })
+    let expected = try AES.CFB.encrypt(plaintext, using: key, nonce: nonce)
+
+    let encryptor = try AES.CFB.Cryptor(operation: .encrypt, key: key, nonce: nonce)
+    var ciphertext = plaintext
+    try ciphertext.withUnsafeMutableBytes { buffer in
+      // Split points that are not block aligned exercise the carried feedback offset.
+      for range in [0..<5, 5..<21, 21..<21, 21..<64, 64..<100] {
+        try encryptor.update(UnsafeMutableRawBufferPointer(rebasing: buffer[range]))
+      }
+    }
+    XCTAssertEqual(ciphertext, expected)
+
+    let decryptor = try AES.CFB.Cryptor(operation: .decrypt, key: key, nonce: nonce)
+    var recoveredPlaintext = Data(repeating: 0, count: ciphertext.count)
+    try ciphertext.withUnsafeBytes { input in
+      try recoveredPlaintext.withUnsafeMutableBytes { output in
+        for range in [0..<17, 17..<33, 33..<100] {
+          try decryptor.update(
+            input: UnsafeRawBufferPointer(rebasing: input[range]),
+            output: UnsafeMutableRawBufferPointer(rebasing: output[range])
+          )
+        }
+      }
+    }
+    XCTAssertEqual(recoveredPlaintext, plaintext)
+  }
+
+  func testCryptorBadKey() {
+    XCTAssertThrowsError(
+      try AES.CFB.Cryptor(operation: .encrypt, key: SymmetricKey(size: .bits256), nonce: .init())
+    )
+  }
 }
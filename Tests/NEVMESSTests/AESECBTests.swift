@@ -40,4 +40,20 @@ final class AESECBTests: XCTestCase {
 
     XCTAssertEqual(plaintext, recoveredPlaintext)
   }
+
+  func testKeyScheduleMatchesOneShotEncryption() throws {
+    XCTAssertThrowsError(try AES.ECB.KeySchedule(key: SymmetricKey(size: .bits192)))
+
+    let key = SymmetricKey(data: "73941db4cb79371f".data(using: .utf8)!)
+    let keySchedule = try AES.ECB.KeySchedule(key: key)
+
+    for count in [0, 1, 15, 16, 17, 48] {
+      let plaintext = Data((0..<count).map { UInt8(truncatingIfNeeded: $0) })
+      let ciphertext = try AES.ECB.encrypt(plaintext, using: keySchedule)
+      XCTAssertEqual(ciphertext, try AES.ECB.encrypt(plaintext, using: key))
+      XCTAssertEqual(try AES.ECB.decrypt(ciphertext, using: keySchedule), plaintext)
+    }
+
+    XCTAssertThrowsError(try AES.ECB.decrypt(Data(count: 15), using: keySchedule))
+  }
 }
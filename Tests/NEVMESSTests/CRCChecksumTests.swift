@@ -25,4 +25,20 @@ final class CRCChecksumTests: XCTestCase {
     XCTAssertEqual(CRC32.checksum("60c2de912227c88b".utf8), 2_803_390_074)
     XCTAssertEqual(CRC32.checksum("813e73491b302f61".utf8), 1_427_083_490)
   }
+
+  func testSlicingKernelMatchesBytewiseChecksum() {
+    let bytes = (0..<300).map { UInt8(truncatingIfNeeded: $0 &* 7 &+ 3) }
+    for start in 0..<8 {
+      for count in 0..<(bytes.count - start) {
+        let slice = bytes[start..<(start + count)]
+        let expected = ~slice.reduce(~UInt32(0)) { crc, byte in
+          (crc >> 8) ^ CRC32.table[(Int(crc) ^ Int(byte)) & 0xFF]
+        }
+        let checksum = slice.withUnsafeBytes {
+          CRC32.checksum(bufferPointer: $0)
+        }
+        XCTAssertEqual(checksum, expected)
+      }
+    }
+  }
 }
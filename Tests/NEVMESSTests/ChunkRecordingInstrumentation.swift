@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+
+@testable import NEVMESS
+
+/// A `ProxyInstrumentation` that records the events reported by VMESS codecs.
+final class ChunkRecordingInstrumentation: ProxyInstrumentation, @unchecked Sendable {
+
+  struct ChunksProcessed: Equatable {
+    var chunkCount: Int
+    var byteCount: Int
+    var direction: ProxyTrafficDirection
+  }
+
+  var processedChunks: [ChunksProcessed] = []
+  var authenticationFailureCount = 0
+
+  func authenticationDidFail(component: ProxyComponent) {
+    authenticationFailureCount += 1
+  }
+
+  func chunksProcessed(
+    _ chunkCount: Int,
+    byteCount: Int,
+    direction: ProxyTrafficDirection,
+    component: ProxyComponent,
+    duration: TimeAmount
+  ) {
+    processedChunks.append(
+      .init(chunkCount: chunkCount, byteCount: byteCount, direction: direction)
+    )
+  }
+}
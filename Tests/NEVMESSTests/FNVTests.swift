@@ -26,4 +26,21 @@ final class FNVTests: XCTestCase {
     XCTAssertEqual(FNV1a32.hash(data: Array("b30c084727ad1c592ac21d12".utf8)), 3_166_953_508)
     XCTAssertEqual(FNV1a32.hash(data: Array("b5e006ded553110e6dc56529".utf8)), 191_308_860)
   }
+
+  func testUnrolledKernelMatchesBytewiseHash() {
+    let bytes = (0..<300).map { UInt8(truncatingIfNeeded: $0 &* 7 &+ 3) }
+    for start in 0..<8 {
+      for count in 0..<(bytes.count - start) {
+        let slice = bytes[start..<(start + count)]
+        let expected = slice.reduce(UInt32(2_166_136_261)) { partialResult, byte in
+          (partialResult ^ UInt32(byte)) &* 16_777_619
+        }
+        let hash = slice.withUnsafeBytes {
+          FNV1a32.hash(bufferPointer: $0)
+        }
+        XCTAssertEqual(hash, expected)
+        XCTAssertEqual(FNV1a32.hash(data: slice), expected)
+      }
+    }
+  }
 }
@@ -36,4 +36,43 @@ class KDFTests: XCTestCase {
       XCTAssertEqual($0.hexEncodedString(), expectedKey)
     }
   }
+
+  func testDeriveKeyFromCachedPath() {
+    let symmetricKey = SymmetricKey(data: "Demo Key for KDF Value Test".data(using: .utf8)!)
+
+    var result = KDF.deriveKey(
+      inputKeyMaterial: symmetricKey,
+      info: [
+        Array("VMess Header AEAD Key".utf8),
+        Array(0..<16),
+        Array(0..<8),
+      ]
+    )
+    result.withUnsafeBytes {
+      XCTAssertEqual($0.hexEncodedString(), "98d07167c50d7bf82bc2f711443172b4")
+    }
+
+    result = KDF.deriveKey(
+      inputKeyMaterial: symmetricKey,
+      info: Array("AES Auth ID Encryption".utf8)
+    )
+    result.withUnsafeBytes {
+      XCTAssertEqual($0.hexEncodedString(), "bbb93224af62a6b4faf582d4a6b46d88")
+    }
+  }
+
+  func testDeriveKeyWithPathLongerThanBlockSize() {
+    let symmetricKey = SymmetricKey(data: "Demo Key for KDF Value Test".data(using: .utf8)!)
+
+    let result = KDF.deriveKey(
+      inputKeyMaterial: symmetricKey,
+      info: [
+        Array(repeating: UInt8(ascii: "x"), count: 100),
+        Array("auth_len".utf8),
+      ]
+    )
+    result.withUnsafeBytes {
+      XCTAssertEqual($0.hexEncodedString(), "5dc3d9ca4d861b80c276b709a229901a")
+    }
+  }
 }
@@ -239,4 +239,106 @@ final class VMESSDecoderTests: XCTestCase {
       expected
     )
   }
+
+  func testCoalescingBodyFramesDecodedInOnePass() throws {
+    let expectedFrames = [
+      ResponseTestsData.expectedFirstFrame,
+      ResponseTestsData.expectedSecondFrame,
+      ResponseTestsData.expectedThirdFrame,
+    ]
+    .map { ByteBuffer(hexEncoded: $0)! }
+
+    // The cap fits the first frame alone and the last two frames together.
+    let decoder = VMESSDecoder<VMESSPart<VMESSResponseHead, ByteBuffer>>(
+      contentSecurity: .aes128Gcm,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .init(),
+      commandCode: .tcp,
+      maximumCoalescedReadBytes: expectedFrames[1].readableBytes + expectedFrames[2].readableBytes
+    )
+    XCTAssertNoThrow(try channel.pipeline.addHandler(ByteToMessageHandler(decoder)).wait())
+
+    var data = ByteBuffer()
+    for var part in paddingMaskingAES128GCMResponse {
+      data.writeBuffer(&part)
+    }
+    try channel.writeInbound(data)
+
+    XCTAssertNotNil(try channel.readInbound(as: VMESSPart<VMESSResponseHead, ByteBuffer>.self))
+    XCTAssertEqual(
+      try channel.readInbound(as: VMESSPart<VMESSResponseHead, ByteBuffer>.self),
+      .body(expectedFrames[0])
+    )
+    var joined = expectedFrames[1]
+    var third = expectedFrames[2]
+    joined.writeBuffer(&third)
+    XCTAssertEqual(
+      try channel.readInbound(as: VMESSPart<VMESSResponseHead, ByteBuffer>.self),
+      .body(joined)
+    )
+    XCTAssertNil(try channel.readInbound(as: VMESSPart<VMESSResponseHead, ByteBuffer>.self))
+  }
+
+  func testInstrumentationReportsChunksOpenedPerDecodePass() throws {
+    let instrumentation = ChunkRecordingInstrumentation()
+    let decoder = VMESSDecoder<VMESSPart<VMESSResponseHead, ByteBuffer>>(
+      contentSecurity: .aes128Gcm,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .init(),
+      commandCode: .tcp,
+      instrumentation: instrumentation
+    )
+    XCTAssertNoThrow(try channel.pipeline.addHandler(ByteToMessageHandler(decoder)).wait())
+
+    var data = ByteBuffer()
+    for var part in paddingMaskingAES128GCMResponse {
+      data.writeBuffer(&part)
+    }
+    try channel.writeInbound(data)
+
+    let byteCount = [
+      ResponseTestsData.expectedFirstFrame,
+      ResponseTestsData.expectedSecondFrame,
+      ResponseTestsData.expectedThirdFrame,
+    ]
+    .reduce(0) { $0 + $1.count / 2 }
+    XCTAssertEqual(
+      instrumentation.processedChunks,
+      [.init(chunkCount: 3, byteCount: byteCount, direction: .inbound)]
+    )
+    XCTAssertEqual(instrumentation.authenticationFailureCount, 0)
+  }
+
+  func testInstrumentationReportsChunksFailingAuthentication() throws {
+    let instrumentation = ChunkRecordingInstrumentation()
+    let decoder = VMESSDecoder<VMESSPart<VMESSResponseHead, ByteBuffer>>(
+      contentSecurity: .aes128Gcm,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .init(),
+      commandCode: .tcp,
+      instrumentation: instrumentation
+    )
+    XCTAssertNoThrow(try channel.pipeline.addHandler(ByteToMessageHandler(decoder)).wait())
+
+    var data = ByteBuffer()
+    for var part in paddingMaskingAES128GCMResponse.prefix(2) {
+      data.writeBuffer(&part)
+    }
+    var sealed = paddingMaskingAES128GCMResponse[2]
+    let firstByte = try XCTUnwrap(sealed.getInteger(at: sealed.readerIndex, as: UInt8.self))
+    sealed.setInteger(firstByte ^ 1, at: sealed.readerIndex)
+    data.writeBuffer(&sealed)
+
+    XCTAssertThrowsError(try channel.writeInbound(data)) {
+      guard case .authenticationFailure = $0 as? CryptoKitError else {
+        XCTFail("Expected authenticationFailure but got \($0)")
+        return
+      }
+    }
+    XCTAssertEqual(instrumentation.authenticationFailureCount, 1)
+    XCTAssertTrue(instrumentation.processedChunks.isEmpty)
+  }
 }
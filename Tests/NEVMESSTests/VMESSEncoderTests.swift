@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import Crypto
+import Foundation
+import NEPrettyBytes
+import NESHAKE128
+import NIOCore
+import NIOEmbedded
+import XCTest
+
+@testable import NEVMESS
+
+final class VMESSEncoderTests: XCTestCase {
+
+  let symmetricKey = SymmetricKey(data: Data(hexEncoded: "45d4c42bbefab09de35e498fca4ff920")!)
+  let nonce = Array(hexEncoded: "9ebdbde706ba8d3e6e96241dc6344afa")!
+
+  private func openFrames(
+    _ frames: ByteBuffer,
+    contentSecurity: ContentSecurity
+  ) throws -> (plaintext: [UInt8], chunkCount: Int) {
+    var frames = frames
+    var shake128 = SHAKE128()
+    shake128.update(data: nonce)
+    var keystream = SHAKE128.Reader(shake128)
+
+    var plaintext: [UInt8] = []
+    var chunkCount = 0
+    while frames.readableBytes > 0 {
+      let padding = Int(keystream.readUInt16() % 64)
+      let frameLength = Int(keystream.readUInt16() ^ frames.readInteger(as: UInt16.self)!)
+      let sealed = frames.readBytes(length: frameLength - padding)!
+      XCTAssertNotNil(frames.readBytes(length: padding))
+
+      let chunkNonce = withUnsafeBytes(of: UInt16(chunkCount).bigEndian, Array.init)
+        + nonce[2..<12]
+      if contentSecurity == .aes128Gcm {
+        let sealedBox = try AES.GCM.SealedBox(
+          nonce: .init(data: chunkNonce),
+          ciphertext: sealed.dropLast(16),
+          tag: sealed.suffix(16)
+        )
+        plaintext += try AES.GCM.open(sealedBox, using: symmetricKey)
+      } else {
+        let sealedBox = try ChaChaPoly.SealedBox(
+          nonce: .init(data: chunkNonce),
+          ciphertext: sealed.dropLast(16),
+          tag: sealed.suffix(16)
+        )
+        plaintext += try ChaChaPoly.open(
+          sealedBox,
+          using: generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
+        )
+      }
+      chunkCount += 1
+    }
+    return (plaintext, chunkCount)
+  }
+
+  private func assertAEADFramesRoundTrip(contentSecurity: ContentSecurity) throws {
+    let channel = EmbeddedChannel()
+    let encoder = VMESSEncoder<VMESSPart<VMESSRequestHead, ByteBuffer>>(
+      authenticationCode: 0x3d,
+      contentSecurity: contentSecurity,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .chunkStream,
+      commandCode: .tcp
+    )
+    XCTAssertNoThrow(try channel.pipeline.addHandler(encoder).wait())
+
+    let message = (0..<5000).map { UInt8(truncatingIfNeeded: $0) }
+    try channel.writeOutbound(VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: message)))
+    let frames = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
+
+    let (plaintext, chunkCount) = try openFrames(frames, contentSecurity: contentSecurity)
+    XCTAssertEqual(plaintext, message)
+    XCTAssertEqual(chunkCount, 3)
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testAES128GCMFramesRoundTrip() throws {
+    try assertAEADFramesRoundTrip(contentSecurity: .aes128Gcm)
+  }
+
+  func testChaCha20Poly1305FramesRoundTrip() throws {
+    try assertAEADFramesRoundTrip(contentSecurity: .chaCha20Poly1305)
+  }
+
+  func testInstrumentationReportsChunksSealedPerWrite() throws {
+    let instrumentation = ChunkRecordingInstrumentation()
+    let channel = EmbeddedChannel()
+    let encoder = VMESSEncoder<VMESSPart<VMESSRequestHead, ByteBuffer>>(
+      authenticationCode: 0x3d,
+      contentSecurity: .aes128Gcm,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: .chunkStream,
+      commandCode: .tcp,
+      instrumentation: instrumentation
+    )
+    XCTAssertNoThrow(try channel.pipeline.addHandler(encoder).wait())
+
+    let message = (0..<5000).map { UInt8(truncatingIfNeeded: $0) }
+    try channel.writeOutbound(VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: message)))
+    try channel.writeOutbound(VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: [1, 2])))
+
+    XCTAssertEqual(
+      instrumentation.processedChunks,
+      [
+        .init(chunkCount: 3, byteCount: 5000, direction: .outbound),
+        .init(chunkCount: 1, byteCount: 2, direction: .outbound),
+      ]
+    )
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  private func openCFBFrames(_ frames: ByteBuffer) throws -> (plaintext: [UInt8], chunkCount: Int) {
+    // The body is one CFB stream, so a one-shot decryption of every write recovers the chunks.
+    let ciphertext = Array(buffer: frames)
+    var chunks = ByteBuffer(
+      bytes: try AES.CFB.decrypt(ciphertext, using: symmetricKey, nonce: .init(data: nonce))
+    )
+    var shake128 = SHAKE128()
+    shake128.update(data: nonce)
+    var keystream = SHAKE128.Reader(shake128)
+
+    var plaintext: [UInt8] = []
+    var chunkCount = 0
+    while chunks.readableBytes > 0 {
+      let padding = Int(keystream.readUInt16() % 64)
+      let frameLength = Int(keystream.readUInt16() ^ chunks.readInteger(as: UInt16.self)!)
+      let checksum = try XCTUnwrap(chunks.readInteger(as: UInt32.self))
+      let message = try XCTUnwrap(chunks.readBytes(length: frameLength - 4 - padding))
+      XCTAssertEqual(FNV1a32.hash(data: message), checksum)
+      XCTAssertNotNil(chunks.readBytes(length: padding))
+      plaintext += message
+      chunkCount += 1
+    }
+    return (plaintext, chunkCount)
+  }
+
+  private func makeCFBChannel(commandCode: CommandCode) throws -> EmbeddedChannel {
+    let channel = EmbeddedChannel()
+    let encoder = VMESSEncoder<VMESSPart<VMESSRequestHead, ByteBuffer>>(
+      authenticationCode: 0x3d,
+      contentSecurity: .aes128Cfb,
+      symmetricKey: symmetricKey,
+      nonce: nonce,
+      options: [.chunkStream, .chunkMasking],
+      commandCode: commandCode
+    )
+    try channel.pipeline.addHandler(encoder).wait()
+    return channel
+  }
+
+  func testAES128CFBFramesStreamAcrossWrites() throws {
+    let channel = try makeCFBChannel(commandCode: .tcp)
+
+    let message = (0..<5000).map { UInt8(truncatingIfNeeded: $0) }
+    try channel.writeOutbound(
+      VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: message.prefix(3000)))
+    )
+    try channel.writeOutbound(
+      VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: message.suffix(2000)))
+    )
+    var frames = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
+    var next = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
+    frames.writeBuffer(&next)
+
+    let (plaintext, chunkCount) = try openCFBFrames(frames)
+    XCTAssertEqual(plaintext, message)
+    // 3000 bytes fill two chunks of at most 1978 bytes, and so do 2000 bytes.
+    XCTAssertEqual(chunkCount, 4)
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testAES128CFBPacketFrames() throws {
+    let channel = try makeCFBChannel(commandCode: .udp)
+
+    let packets = [Array(repeating: UInt8(1), count: 100), Array(repeating: UInt8(2), count: 1900)]
+    var frames = ByteBuffer()
+    for packet in packets {
+      try channel.writeOutbound(VMESSPart<VMESSRequestHead, ByteBuffer>.body(.init(bytes: packet)))
+      var next = try XCTUnwrap(channel.readOutbound(as: ByteBuffer.self))
+      frames.writeBuffer(&next)
+    }
+
+    let (plaintext, chunkCount) = try openCFBFrames(frames)
+    XCTAssertEqual(plaintext, Array(packets.joined()))
+    XCTAssertEqual(chunkCount, 2)
+
+    // A packet never spans chunks.
+    let oversized = ByteBuffer(repeating: 0, count: 2048)
+    XCTAssertThrowsError(
+      try channel.writeOutbound(VMESSPart<VMESSRequestHead, ByteBuffer>.body(oversized))
+    )
+    XCTAssertNoThrow(try channel.finish())
+  }
+
+  func testWriteVMESSAddress() {
+    var buffer = ByteBuffer()
+    XCTAssertEqual(buffer.writeVMESSAddress(.hostPort(host: "127.0.0.1", port: 443)), 7)
+    XCTAssertEqual(Array(buffer: buffer), [0x01, 0xBB, 0x01, 0x7F, 0x00, 0x00, 0x01])
+
+    buffer.clear()
+    XCTAssertEqual(buffer.writeVMESSAddress(.hostPort(host: "::1", port: 443)), 19)
+    XCTAssertEqual(Array(buffer: buffer), [0x01, 0xBB, 0x03] + Array(repeating: 0, count: 15) + [1])
+
+    buffer.clear()
+    XCTAssertEqual(buffer.writeVMESSAddress(.hostPort(host: "localhost", port: 443)), 13)
+    XCTAssertEqual(Array(buffer: buffer), [0x01, 0xBB, 0x02, 0x09] + Array("localhost".utf8))
+  }
+}
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Netbot open source project
+//
+// Copyright (c) 2024 Junfeng Zhang and the Netbot project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE for license information
+// See CONTRIBUTORS.txt for the list of Netbot project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOEmbedded
+import XCTest
+import _NELinux
+
+@testable import NEVMESS
+
+final class VMESSMuxTests: XCTestCase {
+
+  private let destination = NWEndpoint.hostPort(host: "example.com", port: 443)
+
+  private var eventLoop: EmbeddedEventLoop!
+
+  private var tunnel: EmbeddedChannel!
+
+  private var session: VMESSMuxSession!
+
+  override func setUpWithError() throws {
+    try makeSession()
+  }
+
+  override func tearDown() {
+    _ = try? tunnel.finish()
+    tunnel = nil
+    session = nil
+    eventLoop = nil
+  }
+
+  private func makeSession(maximumConcurrentStreams: Int = 8) throws {
+    _ = try? tunnel?.finish()
+    eventLoop = EmbeddedEventLoop()
+    let handler = VMESSMuxSessionHandler(maximumConcurrentStreams: maximumConcurrentStreams)
+    tunnel = EmbeddedChannel(handler: handler, loop: eventLoop)
+    try tunnel.connect(to: .init(ipAddress: "127.0.0.1", port: 0)).wait()
+    session = VMESSMuxSession(handler: handler, eventLoop: eventLoop)
+  }
+
+  private func makeStream() throws -> EmbeddedChannel {
+    let stream = EmbeddedChannel(loop: eventLoop)
+    try stream.connect(to: .init(ipAddress: "127.0.0.1", port: 0)).wait()
+    try session.openStream(to: destination, on: stream).wait()
+    return stream
+  }
+
+  private func readOutboundFrames() throws -> [MuxFrame] {
+    var buffer = tunnel.allocator.buffer(capacity: 0)
+    while var next = try tunnel.readOutbound(as: ByteBuffer.self) {
+      buffer.writeBuffer(&next)
+    }
+    var frames: [MuxFrame] = []
+    while let frame = try buffer.readMuxFrame() {
+      frames.append(frame)
+    }
+    XCTAssertEqual(buffer.readableBytes, 0)
+    return frames
+  }
+
+  private func frameBuffer(_ frame: MuxFrame) -> ByteBuffer {
+    var buffer = tunnel.allocator.buffer(capacity: 0)
+    buffer.writeMuxFrame(frame)
+    return buffer
+  }
+
+  func testMuxFrameRoundTrip() throws {
+    let frames = [
+      MuxFrame(sessionID: 1, status: .new, network: .tcp, destination: destination),
+      MuxFrame(
+        sessionID: 1,
+        status: .new,
+        network: .udp,
+        destination: .hostPort(host: .ipv4(IPv4Address("1.2.3.4")!), port: 53)
+      ),
+      MuxFrame(sessionID: 2, status: .keep, data: ByteBuffer(bytes: [1, 2, 3])),
+      MuxFrame(sessionID: 2, status: .end, option: .error),
+      MuxFrame(sessionID: 0, status: .keepAlive),
+    ]
+
+    var buffer = ByteBuffer()
+    for frame in frames {
+      buffer.writeMuxFrame(frame)
+    }
+    for frame in frames {
+      XCTAssertEqual(try buffer.readMuxFrame(), frame)
+    }
+    XCTAssertEqual(buffer.readableBytes, 0)
+  }
+
+  func testReadIncompleteMuxFrame() throws {
+    var buffer = ByteBuffer()
+    buffer.writeMuxFrame(.init(sessionID: 1, status: .keep, data: ByteBuffer(bytes: [1, 2, 3])))
+
+    for length in 0..<buffer.readableBytes {
+      var slice = buffer.getSlice(at: buffer.readerIndex, length: length)!
+      XCTAssertNil(try slice.readMuxFrame())
+      XCTAssertEqual(slice.readableBytes, length)
+    }
+  }
+
+  func testReadMalformedMuxFrame() throws {
+    // Status 0x09 is unknown.
+    var buffer = ByteBuffer(bytes: [0x00, 0x04, 0x00, 0x01, 0x09, 0x00])
+    XCTAssertThrowsError(try buffer.readMuxFrame()) { error in
+      guard case .failedToParseData = error as? CodingError else {
+        XCTFail("Expected CodingError.failedToParseData, got \(error)")
+        return
+      }
+    }
+  }
+
+  func testOpenStreamWritesNewFrame() throws {
+    _ = try makeStream()
+    XCTAssertEqual(
+      try readOutboundFrames(),
+      [MuxFrame(sessionID: 1, status: .new, network: .tcp, destination: destination)]
+    )
+  }
+
+  func testStreamDataIsSentInKeepFrames() throws {
+    let stream = try makeStream()
+    _ = try readOutboundFrames()
+
+    try stream.writeInbound(ByteBuffer(string: "hello"))
+    XCTAssertEqual(
+      try readOutboundFrames(),
+      [MuxFrame(sessionID: 1, status: .keep, data: ByteBuffer(string: "hello"))]
+    )
+  }
+
+  func testKeepFrameDataIsDeliveredToStream() throws {
+    let stream = try makeStream()
+    _ = try readOutboundFrames()
+
+    try tunnel.writeInbound(
+      frameBuffer(.init(sessionID: 1, status: .keep, data: ByteBuffer(string: "world")))
+    )
+    XCTAssertEqual(try stream.readOutbound(as: ByteBuffer.self), ByteBuffer(string: "world"))
+    XCTAssertNil(try tunnel.readInbound(as: ByteBuffer.self))
+  }
+
+  func testKeepFrameOfUnknownStreamIsAnsweredWithEndFrame() throws {
+    try tunnel.writeInbound(
+      frameBuffer(.init(sessionID: 7, status: .keep, data: ByteBuffer(string: "world")))
+    )
+    XCTAssertEqual(try readOutboundFrames(), [MuxFrame(sessionID: 7, status: .end)])
+  }
+
+  func testEndFrameClosesStream() throws {
+    let stream = try makeStream()
+    _ = try readOutboundFrames()
+
+    try tunnel.writeInbound(frameBuffer(.init(sessionID: 1, status: .end)))
+    eventLoop.run()
+    XCTAssertFalse(stream.isActive)
+    XCTAssertEqual(try readOutboundFrames(), [])
+  }
+
+  func testClosingStreamWritesEndFrame() throws {
+    let stream = try makeStream()
+    _ = try readOutboundFrames()
+
+    try stream.close().wait()
+    XCTAssertEqual(try readOutboundFrames(), [MuxFrame(sessionID: 1, status: .end)])
+  }
+
+  func testStreamsAreServedRoundRobin() throws {
+    let a = try makeStream()
+    let b = try makeStream()
+    _ = try readOutboundFrames()
+
+    let payloadSize = VMESSMuxSessionHandler.maximumFramePayloadSize
+    let payloadA = ByteBuffer(repeating: 0x0A, count: payloadSize * 2)
+    let payloadB = ByteBuffer(repeating: 0x0B, count: payloadSize * 2)
+    // Queue both streams before the session writes.
+    a.pipeline.fireChannelRead(NIOAny(payloadA))
+    b.pipeline.fireChannelRead(NIOAny(payloadB))
+    a.pipeline.fireChannelReadComplete()
+
+    let frames = try readOutboundFrames()
+    XCTAssertEqual(frames.map(\.sessionID), [1, 2, 1, 2])
+    XCTAssertEqual(frames.map(\.status), [.keep, .keep, .keep, .keep])
+    XCTAssertEqual(
+      frames.compactMap(\.data?.readableBytes),
+      Array(repeating: payloadSize, count: 4)
+    )
+  }
+
+  func testOpenStreamFailsWhenTooManyStreams() throws {
+    try makeSession(maximumConcurrentStreams: 1)
+    _ = try makeStream()
+
+    let stream = EmbeddedChannel(loop: eventLoop)
+    XCTAssertThrowsError(try session.openStream(to: destination, on: stream).wait()) { error in
+      XCTAssertEqual(error as? VMESSMuxError, .tooManyStreams)
+    }
+  }
+
+  func testOpenStreamFailsWhenTunnelIsClosed() throws {
+    try tunnel.close().wait()
+
+    let stream = EmbeddedChannel(loop: eventLoop)
+    XCTAssertThrowsError(try session.openStream(to: destination, on: stream).wait()) { error in
+      XCTAssertEqual(error as? VMESSMuxError, .sessionClosed)
+    }
+  }
+}
@@ -12,6 +12,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import Crypto
+import Foundation
 import XCTest
 
 @testable import NEVMESS
@@ -36,4 +38,62 @@ class VMESSTests: XCTestCase {
       )
     }
   }
+
+  func testSessionKeys() throws {
+    let symmetricKey = SymmetricKey(data: Data(hexEncoded: "96b727f438a60a07ca1f554ec689862e")!)
+    let authLengthKey = KDF.deriveKey(
+      inputKeyMaterial: symmetricKey,
+      info: Data("auth_len".utf8)
+    )
+
+    var sessionKeys = VMESSSessionKeys(
+      symmetricKey: symmetricKey,
+      contentSecurity: .aes128Gcm,
+      options: .authenticatedLength
+    )
+    XCTAssertEqual(sessionKeys.payloadKey, symmetricKey)
+    XCTAssertEqual(sessionKeys.lengthKey, authLengthKey)
+
+    sessionKeys = VMESSSessionKeys(
+      symmetricKey: symmetricKey,
+      contentSecurity: .chaCha20Poly1305,
+      options: .authenticatedLength
+    )
+    XCTAssertEqual(
+      sessionKeys.payloadKey,
+      generateChaChaPolySymmetricKey(inputKeyMaterial: symmetricKey)
+    )
+    XCTAssertEqual(
+      sessionKeys.lengthKey,
+      generateChaChaPolySymmetricKey(inputKeyMaterial: authLengthKey)
+    )
+
+    sessionKeys = VMESSSessionKeys(
+      symmetricKey: symmetricKey,
+      contentSecurity: .aes128Gcm,
+      options: .chunkStream
+    )
+    XCTAssertNil(sessionKeys.lengthKey)
+  }
+
+  func testUserKeyCache() throws {
+    let user = UUID(uuidString: "450bae28-b9da-67d0-16bc-4918dc8d79b5")!
+    let cache = VMESSUserKeyCache(capacity: 1)
+
+    let keys = cache.keys(for: user)
+    XCTAssertEqual(keys.cmdKey, generateCmdKey(user))
+
+    let authID = Data(repeating: 0x2a, count: 16)
+    let authIDKey = KDF.deriveKey(
+      inputKeyMaterial: keys.cmdKey,
+      info: Data("AES Auth ID Encryption".utf8)
+    )
+    XCTAssertEqual(
+      try AES.ECB.encrypt(authID, using: keys.authIDKeySchedule),
+      try AES.ECB.encrypt(authID, using: authIDKey)
+    )
+
+    XCTAssertNotEqual(cache.keys(for: UUID()).cmdKey, keys.cmdKey)
+    XCTAssertEqual(cache.keys(for: user).cmdKey, keys.cmdKey)
+  }
 }